@@ -10,303 +10,432 @@
 
 #include "network.h"
 #include "board.h"
+#include "tablebase.h"
+#include "san.h"
 #include "agent_utility.h"
-#include <cctype>
-#include <map>
-
-using std::map;
+#include "shard.h"
+#include "evaluator.h"
+#include "co_search.h"
+#include <algorithm>
 
 ValD dist(0.0, BUCKETS); // just used for testing
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// GAME SAMPLES
+// note: training samples created by replaying one game, in the order played
+typedef vector<TrainingSample> GameSamples;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const size_t SHARD_TRAINING_CHUNK = 4096; // samples turned into network inputs at a time when training from shards
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // AGENT
 class Agent {
 public:
-	// constructor
-	Agent(const Network &favorNet, const Network &policyNet, const double &discount, const string &fileName) : 
-		favorNet_(favorNet), policyNet_(policyNet), discount_(discount), fileName_(fileName) {}
+	// constructor, copies of an agent share its networks
+	Agent(const Network<> &favorNet, const Network<> &policyNet, const double &discount, const string &fileName,
+		  const Precision &precision = Precision::Double) : 
+		favorNet_(std::make_shared<Network<>>(favorNet)), policyNet_(std::make_shared<Network<>>(policyNet)),
+		favorWeights_(std::make_shared<SharedNetwork>(favorNet.weights(precision))),
+		policyWeights_(std::make_shared<SharedNetwork>(policyNet.weights(precision))),
+		discount_(discount), fileName_(fileName), precision_(precision) {}
 
 	// methods
-	void load() {
-		favorNet_.load("favor_" + fileName_); 
-		policyNet_.load("policy_" + fileName_); 
-	} 
+	void load(); // keeps a new policyNet if the saved one has different outputs
+	void save() const {
+		favorNet_->save("favor_" + fileName_);
+		policyNet_->save("policy_" + fileName_);
+	}
+	void publish() { // searches running on any copy evaluate with the trained weights from their next evaluation
+		favorWeights_->set(favorNet_->weights(precision_));
+		policyWeights_->set(policyNet_->weights(precision_));
+	}
+	void set_precision(const Precision &precision) { precision_ = precision; publish(); } // searches evaluate in precision, training stays in double
+	void start_batching(const size_t &maxBatch, const int64_t &timeoutUs = EVALUATOR_TIMEOUT_US) { // evaluations of every copy share batches
+		favorEvaluator_ = std::make_shared<NetworkEvaluator>(favorWeights_, maxBatch, timeoutUs);
+		policyEvaluator_ = std::make_shared<NetworkEvaluator>(policyWeights_, maxBatch, timeoutUs);
+	}
+	void stop_batching() { favorEvaluator_.reset(); policyEvaluator_.reset(); } // only once no search is running
+	string batching_stats() const; // json of both evaluators, empty if not batching
 	void train_from_move_string               (const string &str); // trains favorNet from a string of moves
-	vector<Piece> top_n_likely_pieces_to_move (const Board &board, const Color &color, const int &n);
-	Node min_max_call                         (const Board &board, const Color &maximizingColor, const int &depth, const int &n);
-	double min_max                            (const Board &board, int depth, double alpha, double beta, Color maximizingColor, const int &n);
+	GameSamples replay_game                   (const string &str) const; // replays a string of moves into training samples, thread safe
+	void train_on_samples                     (const GameSamples &samples); // searches keep the old weights until publish
+	void train_from_shards                    (const string &directory, const int &epochs = 1); // trains on preprocessed shards in a random order
+	const ValD &policy_output                 (const Board &board) const; // kept by the calling thread until its next call
+	const ValD &favor_output                  (const Board &board) const;
+	vector<Node> top_n_likely_moves           (const Board &board, const Color &color, const int &n) const; // values are move probabilities
+	Node min_max_call                         (const Board &board, const Color &maximizingColor, const int &depth, const int &n,
+											   SearchInfo *info = nullptr) const;
+	double min_max                            (const Board &board, int depth, double alpha, double beta, Color maximizingColor, const int &n,
+											   SearchInfo *info = nullptr) const;
+	vector<Node> score_moves                  (const Board &board, const Color &maximizingColor, const int &depth, const int &n,
+											   SearchInfo *info = nullptr) const; // exact value of every root move min_max_call would search
+#if defined(__cpp_impl_coroutine)
+	vector<vector<Node>> score_moves_interleaved (const vector<Board> &boards, const int &depth, const int &n, EvalScheduler &scheduler,
+												  SearchInfo *info = nullptr) const; // score_moves of every board on one thread
+#endif
 
 private:
-	Network favorNet_;
-	Network policyNet_;
+	// helpers
+	void add_training_pairs (const TrainingSample &sample, vector<pair<SparseInput, ValD>> &favorPairs,
+							 vector<pair<SparseInput, ValD>> &policyPairs) const; // creates network inputs and answers for a sample
+	void evaluate           (const SharedNetwork &network, NetworkEvaluator *evaluator, const Board &board,
+							 ValD &outputs) const; // network outputs for board
+	vector<Node> top_moves  (const Board &board, const Color &color, const int &n, const ValD &policy) const; // n most likely moves by policy output
+	vector<Node> select_moves (const Board &board, const Color &color, const int &n, const int &depth,
+							   SearchInfo *info) const; // moves searched at a node with depth left
+	bool decided_value      (const Board &board, const int &ply, const Color &maximizingColor, SearchInfo *info,
+							 double &value) const; // true if the node's value is known without searching
+#if defined(__cpp_impl_coroutine)
+	SearchTask<vector<Node>> co_select_moves (EvalScheduler &scheduler, const Board &board, Color color, int n, int depth,
+											  SearchInfo *info) const;
+	SearchTask<double> co_min_max           (EvalScheduler &scheduler, const Board &board, int depth, double alpha, double beta,
+											 Color maximizingColor, int n, SearchInfo *info) const; // min_max suspending on evaluations
+#endif
+
+	// networks are trained in place, searches only read the weights last
+	// published so one agent can be searched from many threads
+	shared_ptr<Network<>>     favorNet_;
+	shared_ptr<Network<>>     policyNet_;
+	shared_ptr<SharedNetwork> favorWeights_;
+	shared_ptr<SharedNetwork> policyWeights_;
+	shared_ptr<NetworkEvaluator> favorEvaluator_; // null unless batching
+	shared_ptr<NetworkEvaluator> policyEvaluator_;
 	double discount_;
 	string fileName_;
+	Precision precision_; // of the weights searches evaluate with
 
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 //
 // AGENT functions
+////////////////////////////////////////
+// loads both networks, policy files saved before moves were encoded only
+// score from squares so they are dropped
+void Agent::load()
+{
+	favorNet_->load("favor_" + fileName_);
+
+	Network<> policy(*policyNet_);
+	policyNet_->load("policy_" + fileName_);
+	if (policyNet_->getOutputSize() != policy.getOutputSize())
+	{
+		cout << "Saved policy network doesn't score moves, using a new one." << endl;
+		*policyNet_ = policy;
+	}
+
+	publish();
+}
+
 ////////////////////////////////////////
 // trains network from a pgn file loaded into a string
 void Agent::train_from_move_string(const string &str)
 {
-	// init board
-	Board board;
+	cout << "Reading: " << str << endl;
 
-	// split string to seperate moves
-	list<string> subStrings = split_string(str);
+	train_on_samples(replay_game(str));
 
-	// holds board state and favor of the board at that step
-	list<pair<ValD, double>> favorSteps;
+	// save neural nets
+	save();
+	publish();
+}
 
-	// holds board state and index of board pos of piece that moved this step
-	list<pair<ValD, size_t>> policySteps;
+////////////////////////////////////////
+// replays a string of moves and creates the favor and policy training samples
+GameSamples Agent::replay_game(const string &str) const
+{
+	// init board
+	Board board;
 
-	cout << "Reading: " << str << endl;
+	// holds packed board state, favor and move played at each step, newest step first
+	list<TrainingSample> steps;
 
 	// loop through game and create a list of board states and favor
-	int i = 0;
-	for (auto it = subStrings.begin(); it != subStrings.end(); ++it, ++i)
+	Color color = Color::White;
+	int8_t result = 0;
+	string_view text(str), token;
+	while (next_san_token(text, token))
 	{
-		// every third string is a move number so skip
-		if (i % 3 != 0 
-			&& (*it != "1-0" || *it != "0-1" || *it != "1/2-1/2"))
+		// check if string was outcome ex: 1-0, 1/2-1/2 or 0-1
+		if (is_game_result(token))
 		{
-			string moveStr = *it;
-
-			// remove + from end of string
-			if (moveStr.back() == '+' || moveStr.back() == '#') moveStr.erase(--moveStr.end());
+			// if game ended, add a bonus to favor of last move played
+			double winningBonus = 0;
 
-			// info about move
-			Position desired(-10, -10), current(-10, -10);
-			char rep = '@';
-			Color color = i % 3 == 1 ? Color::White : Color::Black;
-
-			// if first char is lower case and length is 2 then it was a pawn move in that file
-			if (islower(moveStr[0]) && moveStr.length() == 2)
+			// white won
+			if (token == "1-0")
 			{
-				current.second = moveStr[0] - 97;
-
-				desired.first = moveStr[1] - 49;
-				desired.second = current.second;
-
-				// check if move was a pawn jump
-				int checkMult = color == Color::White ? -1 : 1;
-				auto piece = cfind(board.get_pieces(), make_pair(desired.first + 2 * checkMult, current.second));
-				if (piece != board.get_pieces().end()
-					&& piece->get_rep() == PAWN_REP
-					&& cfind(board.get_pieces(), make_pair(desired.first + 1 * checkMult, current.second)) == board.get_pieces().cend())
-				{
-					current = piece->get_position();
-					desired.first = -3;
-				}
-				
-				rep = PAWN_REP;
+				winningBonus += 10.0;
+				result = 1;
 			}
-			// pawn takes move
-			else if (islower(moveStr[0]) && moveStr.length() == 4 && moveStr[1] == 'x')
+			// black won
+			else if (token == "0-1")
 			{
-				current.second = moveStr[0] - 97;
+				winningBonus -= 10.0;
+				result = -1;
+			}
 
-				desired.first = moveStr[3] - 49;
-				desired.second = moveStr[2] - 97;
+			TrainingSample last = TrainingSample();
+			pack_board(board, last.board_);
+			last.favor_ = float(board.favor() + winningBonus);
+			last.policy_ = NO_POLICY;
+			steps.push_front(last);
+			break;
+		}
 
-				// check if it was an en passant
-				if (cfind(board.get_pieces(), desired)->get_rep() == EMPTY_REP)
-					desired.first = -4;
+		// find move on board, a move that can't be found would throw off the rest of the game so drop it
+		SanMove move;
+		Position current, desired;
+		char promotion;
+		if (!parse_san(token, move) || !resolve_move(board, color, move, current, desired, promotion))
+		{
+			cout << "Couldn't read move " << token << ", skipping game" << endl;
+			return GameSamples();
+		}
 
-				rep = PAWN_REP;
-			}
-			// king side castle
-			else if (moveStr == "O-O")
-			{
-				desired.first = -1;
-				desired.second = -1;
+		// before move is made, add state and current favor to list
+		TrainingSample step = TrainingSample();
+		pack_board(board, step.board_);
 
-				current = board.get_king_pos(color);
-			}
-			// queen side castle
-			else if (moveStr == "O-O-O")
-			{
-				desired.first = -2;
-				desired.second = -2;
+		// find favor
+		double compoundDiscount = 1.0;
+		double favor = board.favor();
+		for (auto it = steps.begin(); it != steps.end(); ++it, compoundDiscount *= discount_)
+			it->favor_ += float(favor * compoundDiscount);
 
-				current = board.get_king_pos(color);
-			}
-			// normal piece move where no other piece of that type and color can make that move
-			else if (isupper(moveStr[0]) && moveStr.length() == 3)
-			{
-				desired.first = moveStr[2] - 49;
-				desired.second = moveStr[1] - 97;
+		step.favor_ = float(favor);
+		step.policy_ = uint16_t(get_move_index(*cfind(board.get_pieces(), current), desired, promotion));
+		steps.push_front(step);
 
-				rep = moveStr[0];
-			}
-			// normal piece move where no other piece of that type and color can make that move and a piece was taken
-			else if (isupper(moveStr[0]) && moveStr.length() == 4 && moveStr[1] == 'x')
-			{
-				desired.first = moveStr[3] - 49;
-				desired.second = moveStr[2] - 97;
+		// make move and update board move set
+		board.make_move(current, desired, promotion);
+		board.update_move_set();
 
-				rep = moveStr[0];
-			}
-			// normal piece move where a piece of the same type and color can make the same move
-			else if (isupper(moveStr[0]) && moveStr.length() == 4)
-			{
-				if (isdigit(moveStr[1])) current.first = moveStr[1] - 49;
-				else current.second = moveStr[1] - 97;
+		color = color == Color::White ? Color::Black : Color::White;
+	}
 
-				desired.first = moveStr[3] - 49;
-				desired.second = moveStr[2] - 97;
+	// samples in the order the game was played
+	GameSamples samples(steps.rbegin(), steps.rend());
+	for (TrainingSample &sample : samples)
+		sample.result_ = result;
 
-				rep = moveStr[0];
-			}
-			// normal piece move where a piece of the same type and color can make the same move and a piece was taken
-			else if (isupper(moveStr[0]) && moveStr.length() == 5 && moveStr[2] == 'x')
-			{
-				if (isdigit(moveStr[1])) current.first = moveStr[1] - 49;
-				else current.second = moveStr[1] - 97;
+	return samples;
+}
 
-				desired.first = moveStr[4] - 49;
-				desired.second = moveStr[3] - 97;
+////////////////////////////////////////
+// creates network inputs and answers for a sample, samples without a move only train favorNet
+void Agent::add_training_pairs(const TrainingSample &sample, vector<pair<SparseInput, ValD>> &favorPairs,
+							   vector<pair<SparseInput, ValD>> &policyPairs) const
+{
+	SparseInput state = unpack_board_state(sample.board_, favorNet_->getInputSize());
 
-				rep = moveStr[0];
-			}
-			// check if string was outcome ex: 1-0, 1/2-1/2 or 0-1
-			else
-			{
-				// if game ended, add a bonus to favor of last move played
-				double winningBonus = 0;
-
-				// white won
-				if (moveStr[0] == '1' && moveStr[1] == '-')
-					winningBonus += 10.0;
-				// black won
-				else if (moveStr[0] == '0' && moveStr[1] == '-')
-					winningBonus -= 10.0;
-
-				favorSteps.push_front(make_pair(create_board_state(board, favorNet_.getInputSize()), board.favor()));
-				favorSteps.front().second += winningBonus;
-				break;
-			}
+	ValD ans(0.0, favorNet_->getOutputSize());
+	ans[favor_to_index(sample.favor_)] = 1.0;
+	dist[favor_to_index(sample.favor_)] += 1.0;
+	favorPairs.push_back(make_pair(state, ans));
 
-			// if castling or pawn jump, enough info was found to make move
-			bool moveFound = false;
-			if (!(desired.first < 0) || desired.first == -4)
-				for (const Piece &p : board.get_pieces())
-				{
-					// check if only the desired pos was found
-					if ((current == make_pair(-10, -10)
-						 || (current.first == p.get_position().first
-							 || current.second == p.get_position().second))
-						&& p.get_rep() == rep
-						&& p.get_color() == color)
-						for (const Position &pos : p.move_list())
-							if (pos == desired)
-							{
-								current = p.get_position();
-								moveFound = true;
-								break;
-							}
-
-					if (moveFound) break;
-				}
+	if (sample.policy_ != NO_POLICY)
+	{
+		ans = ValD(0.0, policyNet_->getOutputSize());
+		ans[sample.policy_] = 1.0;
+		policyPairs.push_back(make_pair(state, ans));
+	}
+}
+
+////////////////////////////////////////
+// runs network on board on this thread, or waits for its batch when batching.
+// on this thread the input and outputs reuse storage from earlier calls
+void Agent::evaluate(const SharedNetwork &network, NetworkEvaluator *evaluator, const Board &board, ValD &outputs) const
+{
+	shared_ptr<const NetworkWeights> weights = network.get();
+	if (evaluator)
+	{
+		outputs = evaluator->evaluate(create_board_state(board, weights->getInputSize()));
+		return;
+	}
 
-			// before move is made, add state and current favor to list
-			ValD state = create_board_state(board, favorNet_.getInputSize());
+	thread_local SparseInput state;
+	create_board_state(board, weights->getInputSize(), state);
+	weights->forwardPropagation(state, thread_workspace(), outputs);
+}
 
-			// find favor
-			double compoundDiscount = 1.0;
-			double favor = board.favor();
-			for (auto it = favorSteps.begin(); it != favorSteps.end(); ++it, compoundDiscount *= discount_)
-				it->second += favor * compoundDiscount;
+////////////////////////////////////////
+// network outputs for board in a buffer of the calling thread, each network
+// has its own so one's outputs stay while the other is run
+const ValD &Agent::policy_output(const Board &board) const
+{
+	thread_local ValD outputs;
+	evaluate(*policyWeights_, policyEvaluator_.get(), board, outputs);
+	return outputs;
+}
 
-			favorSteps.push_front(make_pair(state, favor));
-			policySteps.push_back(make_pair(state, get_board_index(current)));
+const ValD &Agent::favor_output(const Board &board) const
+{
+	thread_local ValD outputs;
+	evaluate(*favorWeights_, favorEvaluator_.get(), board, outputs);
+	return outputs;
+}
 
-			// make move and update board move set
-			board.make_move(current, desired);
-			board.update_move_set();
-		}
-	}
+////////////////////////////////////////
+// json of the favor and policy evaluators, empty if not batching
+string Agent::batching_stats() const
+{
+	if (!favorEvaluator_)
+		return "";
 
-	// train models after game is over
-	cout << "Training..." << endl;
+	return "{\"favor\":" + favorEvaluator_->stats().to_json() + ",\"policy\":" + policyEvaluator_->stats().to_json() + "}";
+}
 
-	// train favorNet
-	double totalLoss = 0, totalFavor = 0;
-	for (auto it = favorSteps.rbegin(); it != favorSteps.rend(); ++it)
-	{
-		ValD alpha = favorNet_.forwardPropagation(it->first);
+////////////////////////////////////////
+// trains both networks on the samples from one game
+void Agent::train_on_samples(const GameSamples &steps)
+{
+	// game couldn't be read
+	if (steps.empty())
+		return;
 
-		ValD ans(0.0, favorNet_.getOutputSize());
-		ans[favor_to_index(it->second)] = 1.0;
-		dist[favor_to_index(it->second)] += 1.0;
+	cout << "Training..." << endl;
 
-		totalLoss += abs(alpha - ans).sum();
+	vector<pair<SparseInput, ValD>> favorPairs, policyPairs;
+	for (const TrainingSample &sample : steps)
+		add_training_pairs(sample, favorPairs, policyPairs);
 
-		favorNet_.backPropagation(alpha, ans);
-	}
-	cout << "Average Favor Loss: " << totalLoss / favorSteps.size() << endl << endl;
+	// train favorNet, samples are in the order the game was played
+	double totalLoss = favorNet_->train(favorPairs);
+	cout << "Average Favor Loss: " << totalLoss / favorPairs.size() << endl << endl;
 
 	// print favor index distribution for testing
-	for (int j = 0; j < dist.size(); ++j)
+	for (size_t j = 0; j < dist.size(); ++j)
 		cout << j << ": " << dist[j] << endl;
 	cout << endl;
 
 	// train policyNet
-	totalLoss = 0;
-	for (auto it = policySteps.begin(); it != policySteps.end(); ++it)
+	totalLoss = policyNet_->train(policyPairs);
+	cout << "Average Policy Loss: " << totalLoss / policyPairs.size() << endl << endl;
+}
+
+////////////////////////////////////////
+// trains on every sample in a directory of shards each epoch, samples are
+// read in a random order and converted to network inputs a chunk at a time
+void Agent::train_from_shards(const string &directory, const int &epochs)
+{
+	ShardReader reader(directory);
+	if (reader.shards() == 0)
+	{
+		cout << "Couldn't find shards in " << directory << endl;
+		return;
+	}
+
+	for (int epoch = 0; epoch < epochs; ++epoch)
 	{
-		ValD alpha = policyNet_.forwardPropagation(it->first);
+		double favorLoss = 0, policyLoss = 0;
+		size_t favorCount = 0, policyCount = 0;
 
-		ValD ans(0.0, policyNet_.getOutputSize());
-		ans[it->second] = 1.0;
+		TrainingSample sample;
+		vector<pair<SparseInput, ValD>> favorPairs, policyPairs;
+		bool more = true;
+		while (more)
+		{
+			favorPairs.clear();
+			policyPairs.clear();
+			while (favorPairs.size() < SHARD_TRAINING_CHUNK && (more = reader.next(sample)))
+				add_training_pairs(sample, favorPairs, policyPairs);
+
+			favorLoss += favorNet_->train(favorPairs);
+			policyLoss += policyNet_->train(policyPairs);
+			favorCount += favorPairs.size();
+			policyCount += policyPairs.size();
+		}
 
-		totalLoss += abs(alpha - ans).sum();
+		cout << "Epoch " << epoch + 1 << ": "
+			<< "Average Favor Loss: " << favorLoss / favorCount << ", "
+			<< "Average Policy Loss: " << policyLoss / policyCount << endl;
 
-		policyNet_.backPropagation(alpha, ans);
+		save();
+		publish();
+		reader.reset();
 	}
-	cout << "Average Policy Loss: " << totalLoss / policySteps.size() << endl << endl;
+}
 
-	// save neural nets
-	favorNet_.save("favor_" + fileName_);
-	policyNet_.save("policy_" + fileName_);
+////////////////////////////////////////
+// finds the most likely moves using the policy network, helps prune search space for min max
+vector<Node> Agent::top_n_likely_moves(const Board &board, const Color &color, const int &n) const
+{
+	return top_moves(board, color, n, policy_output(board));
 }
 
 ////////////////////////////////////////
-// finds the top most likely pieces to be moved using the policy network, helps prune search space for min max
-vector<Piece> Agent::top_n_likely_pieces_to_move(const Board &board, const Color &color, const int &n)
+// picks the n moves of color the policy output rates most likely, n of 0
+// keeps every move. probabilities are a softmax over the legal moves only
+vector<Node> Agent::top_moves(const Board &board, const Color &color, const int &n, const ValD &output) const
 {
-	ValD state = create_board_state(board, policyNet_.getInputSize());
-	ValD output = policyNet_.forwardPropagation(state);
+	// policy outputs are sigmoids so they're turned back into logits first,
+	// pawns reaching the last row are a move for each promotion
+	vector<Node> moves;
+	double highest = -1 * std::numeric_limits<double>::max();
+	for (const Piece &p : board.get_pieces())
+		if (p.get_color() == color)
+			for (const Position &move : p.move_list())
+				for (int i = 0; i < promotion_choices(p, move); ++i)
+				{
+					double chance = min(max(output[get_move_index(p, move, PROMOTIONS[i])], 1e-12), 1.0 - 1e-12);
+					moves.push_back(Node(std::log(chance / (1.0 - chance)), p.get_position(), move, PROMOTIONS[i]));
+					highest = max(highest, moves.back().value_);
+				}
+
+	double total = 0.0;
+	for (Node &move : moves)
+	{
+		move.value_ = std::exp(move.value_ - highest);
+		total += move.value_;
+	}
+	for (Node &move : moves)
+		move.value_ /= total;
 
-	// create map of pieces
-	map<double, Position> piecesToMove;
-	for (size_t i = 0; i < output.size(); ++i)
-		piecesToMove.insert(make_pair(output[i], get_board_position(i)));
+	// only the kept moves need to be in order
+	size_t keep = n > 0 ? min(size_t(n), moves.size()) : moves.size();
+	std::partial_sort(moves.begin(), moves.begin() + keep, moves.end(),
+					  [](const Node &lhs, const Node &rhs) { return rhs < lhs; });
+	moves.resize(keep);
 
-	int j = 0;
-	vector<Piece> topPieces;
-	for (auto it = piecesToMove.rbegin(); it != piecesToMove.rend() && j < n; ++it)
+	return moves;
+}
+
+////////////////////////////////////////
+// the policy's widened_moves best moves for a node with depth left, every
+// move when in check. move order is cached in info so a position only runs
+// the policy net once
+vector<Node> Agent::select_moves(const Board &board, const Color &color, const int &n, const int &depth,
+								 SearchInfo *info) const
+{
+	vector<Node> moves;
+	if (info && info->policies_.probe(board.hash(), moves))
+		++info->stats_.policyCacheHits_;
+	else
 	{
-		auto pieceIt = cfind(board.get_pieces(), it->second);
-		if (pieceIt != board.get_pieces().end()
-			&& pieceIt->get_color() == color
-			&& pieceIt->move_list().size() != 0)
+		moves = top_n_likely_moves(board, color, 0);
+		if (info)
 		{
-			topPieces.push_back(*pieceIt);
-			++j;
+			++info->stats_.networkCalls_;
+			info->policies_.store(board.hash(), moves);
 		}
 	}
 
-	return topPieces;
+	if (!board.checkers(color))
+		moves.resize(min(moves.size(), size_t(widened_moves(n, depth))));
+
+	return moves;
 }
 
 ////////////////////////////////////////
 // min max calling func for cpu moves
-Node Agent::min_max_call(const Board &board, const Color &maximizingColor, const int &depth, const int &n)
+Node Agent::min_max_call(const Board &board, const Color &maximizingColor, const int &depth, const int &n,
+						 SearchInfo *info) const
 {
 	// init alpha and beta
 	double alpha = -1 * std::numeric_limits<double>::max(),
@@ -320,8 +449,33 @@ Node Agent::min_max_call(const Board &board, const Color &maximizingColor, const
 	// create vector for async functions
 	//vector<future<double>> minMaxAsync;
 
-	// use policy net to find most probable pieces to move
-	vector<Piece> topPieces = top_n_likely_pieces_to_move(board, maximizingColor, n);
+	// a search given no info uses its own so repetitions are still found
+	RootInfo root(info);
+	info = root.get();
+
+	DepthTimer timer(info, depth);
+	if (info)
+	{
+		info->rootDepth_ = depth;
+		info->enter(0);
+	}
+
+	// endgame tables know the best move without searching, wins are worth
+	// more than any favor bucket
+	TablebaseResult result;
+	Node tablebaseMove;
+	if (info && info->tablebases_ && info->tablebases_->probe_root(board, tablebaseMove, result))
+	{
+		++info->stats_.tablebaseHits_;
+		double draw = double(favor_to_index(0.0));
+		tablebaseMove.value_ = result.value(maximizingColor, draw, BUCKETS);
+		info->pv_[0][0] = tablebaseMove;
+		info->pvLength_[0] = 1;
+		return tablebaseMove;
+	}
+
+	// use policy net to find most probable moves
+	vector<Node> topMoves = select_moves(board, maximizingColor, n, depth, info);
 
 	Node value(0, Position(), Position());
 	if (maximizingColor == Color::White)
@@ -329,108 +483,478 @@ Node Agent::min_max_call(const Board &board, const Color &maximizingColor, const
 	else
 		value.value_ = std::numeric_limits<double>::max();
 
-	cout << topPieces.size() << endl;
-
 	// for every move
 	vector<Node> tieMoves;
-	double prevVal = 0;
-	for (const Piece &p : topPieces)
-		for (const Position &move : p.move_list())
+	for (const Node &move : topMoves)
+	{
+		// copy board
+		Board update(board);
+
+		// move piece
+		update.make_move(move.current_, move.desired_, move.promotion_);
+
+		// update move set after move completed
+		update.update_move_set();
+
+		Node node(move);
+		if (maximizingColor == Color::White)
+			node.value_ = min_max(update, depth - 1, alpha, beta, Color::Black, n, info);
+		else
+			node.value_ = min_max(update, depth - 1, alpha, beta, Color::White, n, info);
+
+		// stopped searches return the best move found so far
+		if (info && info->stop_)
+			return value;
+
+		// new best move, previous ties no longer matter
+		if (tieMoves.empty() ||
+			(maximizingColor == Color::White ? value < node : node < value))
 		{
-			// copy board
-			Board update(board);
-
-			// move piece
-			update.make_move(p.get_position(), move);
-
-			// update move set after move completed
-			update.update_move_set();
-
-			if (maximizingColor == Color::White)
-				value = max(Node(min_max(update, depth - 1, alpha, beta, Color::Black, n),
-							p.get_position(), move), value);
-			else
-				value = min(Node(min_max(update, depth - 1, alpha, beta, Color::White, n),
-							p.get_position(), move), value);
-
-			// move tied with previous
-			if (prevVal != value.value_)
-				tieMoves.clear();		
-			prevVal = value.value_;
-			tieMoves.push_back(value);
-			
-			cout << "tieMoves size: " << tieMoves.size() << endl;
-			// set alpha/beta
-			if (maximizingColor == Color::White)
-				alpha = max(value.value_, alpha);
-			else
-				beta = min(beta, value.value_);
+			value = node;
+			tieMoves.clear();
+			if (info)
+				info->update_pv(0, node);
 		}
 
+		// move tied with best
+		if (node.value_ == value.value_)
+			tieMoves.push_back(node);
+		
+		// set alpha/beta
+		if (maximizingColor == Color::White)
+			alpha = max(value.value_, alpha);
+		else
+			beta = min(beta, value.value_);
+	}
+
+	// no moves
+	if (tieMoves.empty())
+		return value;
+
 	// select a random move amongst ties
 	std::default_random_engine generator;
-	std::uniform_int_distribution<int> dist(0, tieMoves.size());
+	std::uniform_int_distribution<int> dist(0, tieMoves.size() - 1);
 	int selection = dist(generator);
+
+	// line below the selected move wasn't kept
+	if (info && selection != 0)
+	{
+		info->pv_[0][0] = tieMoves[selection];
+		info->pvLength_[0] = 1;
+	}
+
 	return tieMoves[selection];
 }
 
 ////////////////////////////////////////
-// min max branching function
-double Agent::min_max(const Board &board, int depth, double alpha, double beta, Color maximizingColor, const int &n)
+// searches every root move with a full window so each value is exact within
+// the moves select_moves keeps, for choosing moves by score instead of only
+// taking the best
+vector<Node> Agent::score_moves(const Board &board, const Color &maximizingColor, const int &depth, const int &n,
+								SearchInfo *info) const
+{
+	// a search given no info uses its own so repetitions are still found
+	RootInfo root(info);
+	info = root.get();
+
+	DepthTimer timer(info, depth);
+	if (info)
+	{
+		info->rootDepth_ = depth;
+		info->enter(0);
+	}
+
+	// use policy net to find most probable moves
+	vector<Node> topMoves = select_moves(board, maximizingColor, n, depth, info);
+
+	vector<Node> scores;
+	for (const Node &move : topMoves)
+	{
+		// copy board
+		Board update(board);
+
+		// move piece
+		update.make_move(move.current_, move.desired_, move.promotion_);
+
+		// update move set after move completed
+		update.update_move_set();
+
+		scores.push_back(move);
+		scores.back().value_ = min_max(update, depth - 1, -1 * std::numeric_limits<double>::max(),
+									   std::numeric_limits<double>::max(),
+									   maximizingColor == Color::White ? Color::Black : Color::White, n, info);
+
+		if (info && info->stop_)
+			return scores;
+	}
+
+	return scores;
+}
+
+////////////////////////////////////////
+// value of a repeated, finished or tablebase position, these aren't searched
+bool Agent::decided_value(const Board &board, const int &ply, const Color &maximizingColor, SearchInfo *info,
+						  double &value) const
 {
-	//cout << depth << endl;
+	// values are favor buckets so draws are the bucket holding even favor
+	double draw = double(favor_to_index(0.0));
+
+	// a repeated position is scored as a draw, the side that could avoid it
+	// would have if it was better for them
+	if (ply > 0 && board.repetitions() > 0)
+	{
+		value = draw;
+		return true;
+	}
+
 	// check if game is over
 	int outcome = board.end_game(Color(maximizingColor));
 
-	cout << valarray_argmax(favorNet_.forwardPropagation(create_board_state(board, favorNet_.getInputSize()))) << endl;
-	if (depth == 0 && outcome == 0)
-		return valarray_argmax(favorNet_.forwardPropagation(create_board_state(board, favorNet_.getInputSize())));
-	else if (outcome == 1 && maximizingColor == Color::White)
-		return -1 * std::numeric_limits<double>::max();
-	else if (outcome == 1 && maximizingColor == Color::Black)
-		return std::numeric_limits<double>::max();
+	// positions in the endgame tables are scored without searching them
+	TablebaseResult result;
+	if (outcome == 0 && ply > 0 && info && info->tablebases_ && info->tablebases_->probe(board, result))
+	{
+		++info->stats_.tablebaseHits_;
+		value = result.value(maximizingColor, draw, BUCKETS);
+		return true;
+	}
+
+	if (outcome == 1)
+		value = maximizingColor == Color::White ? -1 * std::numeric_limits<double>::max() : std::numeric_limits<double>::max();
 	else if (outcome == 2)
-		return 0.0;
+		value = draw;
+
+	return outcome != 0;
+}
+
+////////////////////////////////////////
+// min max branching function, only the moves select_moves picks are searched
+double Agent::min_max(const Board &board, int depth, double alpha, double beta, Color maximizingColor, const int &n,
+					  SearchInfo *info) const
+{
+	// count node and check if search was stopped
+	int ply = 0;
+	if (info)
+	{
+		ply = info->rootDepth_ - depth;
+		info->enter(ply);
+		if (info->should_stop())
+			return 0.0;
+	}
+
+	// repeated, finished and tablebase positions aren't searched
+	double decided;
+	if (decided_value(board, ply, maximizingColor, info, decided))
+		return decided;
+
+	if (depth == 0)
+	{
+		if (info)
+		{
+			++info->stats_.evals_;
+			++info->stats_.networkCalls_;
+		}
+		return valarray_argmax(favor_output(board));
+	}
 
-	// use policy net to find most probable pieces to move
-	vector<Piece> topPieces = top_n_likely_pieces_to_move(board, maximizingColor, n);
+	// earlier result for this position, its best move is tried first otherwise
+	TranspositionTable *table = info ? info->table_ : nullptr;
+	uint64_t key = 0;
+	TableEntry entry;
+	bool hashMove = false;
+	if (table)
+	{
+		key = board.hash();
+		++info->stats_.tableProbes_;
+		if (table->probe(key, entry))
+		{
+			++info->stats_.tableHits_;
+			if (entry.usable(depth, alpha, beta))
+			{
+				++info->stats_.tableCutoffs_;
+				return entry.value_;
+			}
+			hashMove = board.legal_move(entry.move().current_, entry.move().desired_);
+		}
+	}
 
+	// the most likely moves by policy, best first so they cause more cutoffs.
+	// the hash move is searched even when the policy would skip it
+	vector<Node> moves = select_moves(board, maximizingColor, n, depth, info);
+
+	double alphaStart = alpha, betaStart = beta;
 	double value;
 	if (maximizingColor == Color::White)
 		value = -1 * std::numeric_limits<double>::max();
 	else 
 		value = std::numeric_limits<double>::max();
+	Node best;
+	int searched = 0;
+
+	// searches one move, returns true if no more moves need to be searched
+	auto search_move = [&](const Node &move) {
+		++searched;
+
+		// copy board
+		Board update(board);
+
+		// move piece
+		update.make_move(move.current_, move.desired_, move.promotion_);
+
+		// update move set after move completed
+		update.update_move_set();
+
+		double score;
+		if (maximizingColor == Color::White)
+			score = min_max(update, depth - 1, alpha, beta, Color::Black, n, info);
+		else
+			score = min_max(update, depth - 1, alpha, beta, Color::White, n, info);
+
+		if (info && info->stop_)
+			return true;
+
+		if (maximizingColor == Color::White ? score > value : score < value)
+		{
+			value = score;
+			best = move;
+			best.value_ = score;
+			if (info)
+				info->update_pv(ply, best);
+		}
+
+		// set alpha/beta
+		if (maximizingColor == Color::White)
+			alpha = max(value, alpha);
+		else
+			beta = min(beta, value);
+
+		return alpha >= beta;
+	};
+
+	bool done = hashMove && search_move(entry.move());
 
 	// for every move
-	for (const Piece &p : board.get_pieces())
-		if (p.get_color() == maximizingColor)
-			for (const Position &move : p.move_list())
-			{
-				// copy board
-				Board update(board);
+	for (auto move = moves.begin(); !done && move != moves.end(); ++move)
+		if (!(hashMove && move->same_move(entry.move())))
+			done = search_move(*move);
+
+	if (info && info->stop_)
+		return 0.0;
+
+	// cutoff counts show how well moves are ordered
+	if (info && done)
+	{
+		++info->stats_.cutoffs_;
+		info->stats_.firstMoveCutoffs_ += searched == 1;
+	}
+
+	if (table)
+		table->store(key, depth, value, alphaStart, betaStart, best);
+
+	return value;
+}
 
-				// move piece
-				update.make_move(p.get_position(), move);
+#if defined(__cpp_impl_coroutine)
+////////////////////////////////////////////////////////////////////////////////
+//
+// AGENT coroutine functions
+////////////////////////////////////////
+// scores every root move of every board like score_moves, each root move is
+// its own path so one thread keeps a path per move waiting on the scheduler's
+// batches. values and node counts match score_moves when info has no table,
+// a shared table sees positions in a different order. paths run interleaved
+// so the principal variation isn't kept
+vector<vector<Node>> Agent::score_moves_interleaved(const vector<Board> &boards, const int &depth, const int &n,
+													EvalScheduler &scheduler, SearchInfo *info) const
+{
+	// a search given no info uses its own so repetitions are still found
+	RootInfo root(info);
+	info = root.get();
+
+	DepthTimer timer(info, depth);
+	if (info)
+		info->rootDepth_ = depth;
+
+	// root moves of every board come from one batch
+	vector<SearchTask<vector<Node>>> rootTasks;
+	for (const Board &board : boards)
+	{
+		if (info)
+			info->enter(0);
+		rootTasks.push_back(co_select_moves(scheduler, board, board.to_move(), n, depth, info));
+	}
+	scheduler.run(rootTasks);
 
-				// update move set after move completed
-				update.update_move_set();
+	// every position after a root move, made before any task refers to them
+	vector<Board> updates;
+	vector<pair<size_t, Node>> rootMoves; // board index and move
+	for (size_t b = 0; b < boards.size(); ++b)
+		for (const Node &move : rootTasks[b].result())
+		{
+			updates.push_back(boards[b]);
+			updates.back().make_move(move.current_, move.desired_, move.promotion_);
+			updates.back().update_move_set();
+			rootMoves.push_back(make_pair(b, Node(0.0, move.current_, move.desired_, move.promotion_)));
+		}
+
+	vector<SearchTask<double>> tasks;
+	for (size_t i = 0; i < updates.size(); ++i)
+	{
+		Color color = boards[rootMoves[i].first].to_move();
+		tasks.push_back(co_min_max(scheduler, updates[i], depth - 1, -1 * std::numeric_limits<double>::max(),
+								   std::numeric_limits<double>::max(),
+								   color == Color::White ? Color::Black : Color::White, n, info));
+	}
+	scheduler.run(tasks);
+
+	vector<vector<Node>> scores(boards.size());
+	for (size_t i = 0; i < tasks.size(); ++i)
+	{
+		rootMoves[i].second.value_ = tasks[i].result();
+		scores[rootMoves[i].first].push_back(rootMoves[i].second);
+	}
+
+	return scores;
+}
+
+////////////////////////////////////////
+// select_moves with the policy net evaluated by scheduler
+SearchTask<vector<Node>> Agent::co_select_moves(EvalScheduler &scheduler, const Board &board, Color color, int n, int depth,
+												 SearchInfo *info) const
+{
+	vector<Node> moves;
+	if (info && info->policies_.probe(board.hash(), moves))
+		++info->stats_.policyCacheHits_;
+	else
+	{
+		ValD output = co_await scheduler.evaluate(*policyWeights_, create_board_state(board, policyWeights_->get()->getInputSize()));
+		moves = top_moves(board, color, 0, output);
+		if (info)
+		{
+			++info->stats_.networkCalls_;
+			info->policies_.store(board.hash(), moves);
+		}
+	}
+
+	if (!board.checkers(color))
+		moves.resize(min(moves.size(), size_t(widened_moves(n, depth))));
+
+	co_return moves;
+}
+
+////////////////////////////////////////
+// min_max with every network evaluation awaited, moves are searched in the
+// same order so the same nodes are visited
+SearchTask<double> Agent::co_min_max(EvalScheduler &scheduler, const Board &board, int depth, double alpha, double beta,
+									 Color maximizingColor, int n, SearchInfo *info) const
+{
+	// count node and check if search was stopped
+	int ply = 0;
+	if (info)
+	{
+		ply = info->rootDepth_ - depth;
+		info->enter(ply);
+		if (info->should_stop())
+			co_return 0.0;
+	}
 
-				if (maximizingColor == Color::White)
-					value = max(value, min_max(update, depth - 1, alpha, beta, Color::Black, n));
-				else
-					value = min(value, min_max(update, depth - 1, alpha, beta, Color::White, n));
+	// repeated, finished and tablebase positions aren't searched
+	double decided;
+	if (decided_value(board, ply, maximizingColor, info, decided))
+		co_return decided;
 
-				// set alpha/beta
-				if (maximizingColor == Color::White)
-					alpha = max(value, alpha);
-				else
-					beta = min(beta, value);
+	if (depth == 0)
+	{
+		if (info)
+		{
+			++info->stats_.evals_;
+			++info->stats_.networkCalls_;
+		}
+		ValD favor = co_await scheduler.evaluate(*favorWeights_, create_board_state(board, favorWeights_->get()->getInputSize()));
+		co_return double(valarray_argmax(favor));
+	}
 
-				if (alpha >= beta)
-					return value;
+	// earlier result for this position, its best move is tried first otherwise
+	TranspositionTable *table = info ? info->table_ : nullptr;
+	uint64_t key = 0;
+	TableEntry entry;
+	bool hashMove = false;
+	if (table)
+	{
+		key = board.hash();
+		++info->stats_.tableProbes_;
+		if (table->probe(key, entry))
+		{
+			++info->stats_.tableHits_;
+			if (entry.usable(depth, alpha, beta))
+			{
+				++info->stats_.tableCutoffs_;
+				co_return entry.value_;
 			}
+			hashMove = board.legal_move(entry.move().current_, entry.move().desired_);
+		}
+	}
 
-	return value;
+	// moves in the order min_max searches them
+	vector<Node> ordered = co_await co_select_moves(scheduler, board, maximizingColor, n, depth, info);
+
+	vector<Node> moves;
+	if (hashMove)
+		moves.push_back(entry.move());
+	for (const Node &move : ordered)
+		if (!(hashMove && move.same_move(entry.move())))
+			moves.push_back(move);
+
+	double alphaStart = alpha, betaStart = beta;
+	double value;
+	if (maximizingColor == Color::White)
+		value = -1 * std::numeric_limits<double>::max();
+	else 
+		value = std::numeric_limits<double>::max();
+	Node best;
+	int searched = 0;
+	bool done = false;
+	for (size_t i = 0; !done && i < moves.size(); ++i)
+	{
+		++searched;
+
+		Board update(board);
+		update.make_move(moves[i].current_, moves[i].desired_, moves[i].promotion_);
+		update.update_move_set();
+
+		double score = co_await co_min_max(scheduler, update, depth - 1, alpha, beta,
+										   maximizingColor == Color::White ? Color::Black : Color::White, n, info);
+		if (info && info->stop_)
+			co_return 0.0;
+
+		if (maximizingColor == Color::White ? score > value : score < value)
+		{
+			value = score;
+			best = moves[i];
+			best.value_ = score;
+		}
+
+		// set alpha/beta
+		if (maximizingColor == Color::White)
+			alpha = max(value, alpha);
+		else
+			beta = min(beta, value);
+
+		done = alpha >= beta;
+	}
+
+	// cutoff counts show how well moves are ordered
+	if (info && done)
+	{
+		++info->stats_.cutoffs_;
+		info->stats_.firstMoveCutoffs_ += searched == 1;
+	}
+
+	if (table)
+		table->store(key, depth, value, alphaStart, betaStart, best);
+
+	co_return value;
 }
+#endif // __cpp_impl_coroutine
 
 #endif // AGENT_H
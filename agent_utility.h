@@ -10,12 +10,12 @@
 
 #include <string>
 #include <list>
-#include <sstream>
 #include <cmath>
+#include <cctype>
+#include <algorithm>
 
 using std::string;
 using std::list;
-using std::stringstream;
 
 ////////////////////////////////////////////////////////////////////////////////
 //
@@ -23,33 +23,27 @@ using std::stringstream;
 const int BUCKETS = 60; // buckets for favorNet to output to
 const double STARTING_BUCKET_SIZE = .001; // starting increment
 const double EXPANSION_RATE = 1.1; // rate that bucket sizes expand at
+const int UNDERPROMOTIONS = 3 * 3 * SIZE; // knight, bishop or rook, by capture direction and file
+const int WIDENING_MOVES = 2; // moves the agent searches for each ply of depth left past the last
+const int POLICY_MOVES = SIZE * SIZE * SIZE * SIZE + UNDERPROMOTIONS; // policyNet outputs, every from to pair then underpromotions
 
 ////////////////////////////////////////////////////////////////////////////////
 //
 // HELPER functions
 ////////////////////////////////////////
-// split string by a delimiter
-list<string> split_string(const string &str)
+// fills state with the board state used as input to the network, only the
+// squares holding a piece have a nonzero input. a state filled before is
+// reused without allocating
+void create_board_state(const Board &board, const int &inputSize, SparseInput &state)
 {
-	list<string> subStrings;
-	stringstream stream(str);
-	string sub;
-	while (!stream.eof())
-	{
-		stream >> sub;
-		subStrings.push_back(sub);
-	}
-	
-	return subStrings;
-}
-
-////////////////////////////////////////
-// creates a valarray of the board state be used as input to the network
-ValD create_board_state(const Board &board, const int &inputSize)
-{
-	ValD state(0.0, inputSize);
+	state.clear(inputSize);
+	state.active_.reserve(32); // one for each piece
 	for (const Piece &p : board.get_pieces())
 	{
+		// en passant markers aren't pieces
+		if (p.get_rep() == EMPTY_REP)
+			continue;
+
 		// map each piece to an input neuron
 		Position pos = p.get_position();
 		int map = (pos.first * SIZE + pos.second) * 6; // * 6 for the six pieces
@@ -78,11 +72,18 @@ ValD create_board_state(const Board &board, const int &inputSize)
 
 		// activate input neuron
 		if (p.get_color() == Color::Black)
-			state[map] = -1.0;
+			state.add(map, -1.0);
 		else
-			state[map] = 1.0;
+			state.add(map, 1.0);
 	}
+}
 
+////////////////////////////////////////
+// creates the board state used as input to the network
+SparseInput create_board_state(const Board &board, const int &inputSize)
+{
+	SparseInput state;
+	create_board_state(board, inputSize, state);
 	return state;
 }
 
@@ -100,6 +101,47 @@ Position get_board_position(const int &index)
 	return Position(index / SIZE, index % SIZE);
 }
 
+////////////////////////////////////////
+// policy output of a move, from index * 64 + to index. queen promotions use
+// the plain from to output, other promotions come after every from to pair
+size_t get_move_index(const Piece &piece, const Position &desired, const char &promotion = QUEEN_REP)
+{
+	Position current = piece.get_position();
+	Position to = move_destination(current, desired, piece.get_color());
+	size_t index = get_board_index(current) * SIZE * SIZE + get_board_index(to);
+
+	if (piece.get_rep() != PAWN_REP || (to.first != 0 && to.first != SIZE - 1))
+		return index;
+
+	int promoted;
+	switch (toupper((unsigned char)promotion))
+	{
+	case KNIGHT_REP:
+		promoted = 0;
+		break;
+	case BISHOP_REP:
+		promoted = 1;
+		break;
+	case ROOK_REP:
+		promoted = 2;
+		break;
+	default:
+		return index;
+	}
+
+	// direction is 0 capturing toward file a, 1 straight and 2 toward file h
+	int direction = to.second - current.second + 1;
+	return SIZE * SIZE * SIZE * SIZE + (promoted * 3 + direction) * SIZE + current.second;
+}
+
+////////////////////////////////////////
+// moves searched at a node with depth left when n are searched one ply
+// from the leaves, nodes nearer the root look at more of the policy's moves
+int widened_moves(const int &n, const int &depth)
+{
+	return n + WIDENING_MOVES * std::max(depth - 1, 0);
+}
+
 ////////////////////////////////////////
 // takes in favor and outputs an index
 size_t favor_to_index(const double &favor)
@@ -125,6 +167,21 @@ size_t favor_to_index(const double &favor)
 	return -1;
 }
 
+////////////////////////////////////////
+// takes in an index and outputs the favor in the middle of its bucket
+double index_to_favor(const size_t &index)
+{
+	auto y = [&](const int &x) {
+		if (x < 0)
+			return -1 * pow(EXPANSION_RATE, abs(x)) * STARTING_BUCKET_SIZE;
+		else
+			return pow(EXPANSION_RATE, x) * STARTING_BUCKET_SIZE;
+	};
+
+	int i = int(index) - BUCKETS / 2;
+	return (y(i) + y(i + 1)) / 2;
+}
+
 ////////////////////////////////////////
 // finds argmax in a valarray
 size_t valarray_argmax(const ValD &arr)
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        attacks.cpp
+// DESCRIPTION: contains attack table generation
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "attacks.h"
+
+const AttackTables ATTACKS;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ATTACK TABLES functions
+////////////////////////////////////////
+// fills every table once at start up
+AttackTables::AttackTables()
+{
+	// row and col steps for each direction
+	const int rayStep[8][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, -1 },
+								{ -1, 0 }, { 0, -1 }, { -1, -1 }, { -1, 1 } };
+	const int knightStep[8][2] = { { 2, 1 }, { 1, 2 }, { 2, -1 }, { 1, -2 },
+								   { -2, 1 }, { -1, 2 }, { -2, -1 }, { -1, -2 } };
+
+	for (int i = 0; i < SIZE; ++i)
+		for (int j = 0; j < SIZE; ++j)
+		{
+			int square = i * SIZE + j;
+			knight_[square] = king_[square] = 0;
+			pawn_[int(Color::White)][square] = pawn_[int(Color::Black)][square] = 0;
+
+			for (int d = 0; d < 8; ++d)
+			{
+				// knight jumps
+				if (in_bounds(i + knightStep[d][0], j + knightStep[d][1]))
+					knight_[square] |= square_bit((i + knightStep[d][0]) * SIZE + j + knightStep[d][1]);
+
+				// king steps
+				if (in_bounds(i + rayStep[d][0], j + rayStep[d][1]))
+					king_[square] |= square_bit((i + rayStep[d][0]) * SIZE + j + rayStep[d][1]);
+
+				// rays up to the edge
+				rays_[d][square] = 0;
+				for (int r = i + rayStep[d][0], c = j + rayStep[d][1]; in_bounds(r, c); r += rayStep[d][0], c += rayStep[d][1])
+					rays_[d][square] |= square_bit(r * SIZE + c);
+			}
+
+			// pawn captures, white moves up the board and black moves down
+			for (int side = -1; side <= 1; side += 2)
+			{
+				if (in_bounds(i + 1, j + side))
+					pawn_[int(Color::White)][square] |= square_bit((i + 1) * SIZE + j + side);
+				if (in_bounds(i - 1, j + side))
+					pawn_[int(Color::Black)][square] |= square_bit((i - 1) * SIZE + j + side);
+			}
+		}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// squares a piece of type rep and color on square attacks
+Bitboard piece_attacks(const char &rep, const Color &color, const int &square, const Bitboard &occupied)
+{
+	switch (rep)
+	{
+	case KING_REP:
+		return ATTACKS.king_[square];
+	case QUEEN_REP:
+		return rook_attacks(square, occupied) | bishop_attacks(square, occupied);
+	case KNIGHT_REP:
+		return ATTACKS.knight_[square];
+	case BISHOP_REP:
+		return bishop_attacks(square, occupied);
+	case ROOK_REP:
+		return rook_attacks(square, occupied);
+	case PAWN_REP:
+		return ATTACKS.pawn_[int(color)][square];
+	default:
+		return 0;
+	}
+}
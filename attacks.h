@@ -0,0 +1,96 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        attacks.h
+// DESCRIPTION: contains bitboard type and precomputed attack tables
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "piece.h"
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// BITBOARD
+// note: bit i is the square with board index i, index = row * SIZE + col
+typedef uint64_t Bitboard;
+
+// ray directions, first four move toward higher indices
+enum Direction { North, East, NorthEast, NorthWest, South, West, SouthWest, SouthEast };
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ATTACK TABLES
+// note: pawn attacks are indexed by the color of the attacking pawn
+struct AttackTables {
+	AttackTables();
+
+	Bitboard knight_[SIZE * SIZE];
+	Bitboard king_[SIZE * SIZE];
+	Bitboard pawn_[2][SIZE * SIZE];
+	Bitboard rays_[8][SIZE * SIZE]; // every square in a direction up to the edge
+};
+
+extern const AttackTables ATTACKS;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// single bit for a square
+inline Bitboard square_bit(const int &square) { return Bitboard(1) << square; }
+
+////////////////////////////////////////
+// square index of a position
+inline int square_of(const Position &pos) { return pos.first * SIZE + pos.second; }
+
+////////////////////////////////////////
+// index of lowest set bit, bitboard must not be empty
+inline int lsb(const Bitboard &b) { return __builtin_ctzll(b); }
+
+////////////////////////////////////////
+// index of highest set bit, bitboard must not be empty
+inline int msb(const Bitboard &b) { return 63 - __builtin_clzll(b); }
+
+////////////////////////////////////////
+// number of set bits
+inline int popcount(const Bitboard &b) { return __builtin_popcountll(b); }
+
+////////////////////////////////////////
+// squares attacked along one ray, stops at and includes the first blocker
+inline Bitboard ray_attacks(const int &square, const Direction &dir, const Bitboard &occupied)
+{
+	Bitboard attacks = ATTACKS.rays_[dir][square];
+	Bitboard blockers = attacks & occupied;
+	if (blockers)
+	{
+		int blocker = dir < South ? lsb(blockers) : msb(blockers);
+		attacks ^= ATTACKS.rays_[dir][blocker];
+	}
+
+	return attacks;
+}
+
+////////////////////////////////////////
+// squares a rook on square attacks
+inline Bitboard rook_attacks(const int &square, const Bitboard &occupied)
+{
+	return ray_attacks(square, North, occupied) | ray_attacks(square, East, occupied) |
+		ray_attacks(square, South, occupied) | ray_attacks(square, West, occupied);
+}
+
+////////////////////////////////////////
+// squares a bishop on square attacks
+inline Bitboard bishop_attacks(const int &square, const Bitboard &occupied)
+{
+	return ray_attacks(square, NorthEast, occupied) | ray_attacks(square, NorthWest, occupied) |
+		ray_attacks(square, SouthEast, occupied) | ray_attacks(square, SouthWest, occupied);
+}
+
+////////////////////////////////////////
+// squares a piece of type rep and color on square attacks
+Bitboard piece_attacks(const char &rep, const Color &color, const int &square, const Bitboard &occupied);
+
+#endif // ATTACKS_H
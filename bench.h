@@ -0,0 +1,233 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        bench.h
+// DESCRIPTION: contains fixed position benchmark that searches a built in set
+//              of positions to fixed depths and reports nodes, speed and a
+//              signature for checking a change didn't alter search results
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "agent.h"
+#include "san.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const int BENCH_BOARD_DEPTH = 3;
+const int BENCH_AGENT_DEPTH = 2;
+const int BENCH_AGENT_MOVES = 8;
+const size_t BENCH_TABLE_MB = 16;
+
+// middlegame and endgame positions searched by bench, order is part of the signature
+const vector<string> BENCH_FENS = {
+	START_FEN,
+	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+	"4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+	"rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+	"r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+	"r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+	"r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+	"r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+	"4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+	"2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+	"r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+	"3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+	"r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+	"4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+	"3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+	"rnbqkb1r/pp1p1ppp/2p5/4P3/2B5/8/PPP1NnPP/RNBQK2R w KQkq - 0 6",
+	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+	"r3k2r/3nnpbp/q2pp1p1/p7/Pp1PPPP1/4BNN1/1P5P/R2Q1RK1 w kq - 0 16",
+	"4rrk1/1p1nq3/p7/2p1P1pp/3P2bp/3Q1Bn1/PPPB4/1K2R1NR w - - 40 21",
+	"5rk1/q6p/2p3bR/1pPp1rP1/1P1Pp3/P3B1Q1/1K3P2/R7 w - - 93 90",
+	"3Qb1k1/1r2ppb1/pN1n2q1/Pp1Pp1Pr/4P2p/4BP2/4B1R1/1R5K b - - 11 40",
+	"4k3/3q1r2/1N2r1b1/3ppN2/2nPP3/1B1R2n1/2R1Q3/3K4 w - - 5 1",
+	"6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+	"r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1",
+	"1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
+	"6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+	"6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
+	"6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/3N4 b - - 0 1",
+	"3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
+	"2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+	"8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+	"7k/3p2pp/4q3/8/4Q3/5Kp1/P6b/8 w - - 0 1",
+	"8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+	"8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+	"8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
+	"8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
+	"5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+	"8/3p3B/5p2/5P2/p7/PP5b/k7/6K1 w - - 0 1",
+	"8/k7/3p4/p2P1p2/P2P1P2/8/8/K7 w - - 0 1",
+	"8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+	"8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+	"8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+	"8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+	"8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+	"8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+	"8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+	"8/8/8/8/8/6k1/6p1/6K1 b - - 0 1",
+	"7k/7P/6K1/8/3B4/8/8/8 w - - 0 1",
+	"4k3/8/8/8/8/8/8/R3K2R w KQ - 0 1"
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// BENCH RESULT
+struct BenchResult {
+	uint64_t    nodes_ = 0;
+	uint64_t    signature_ = 0; // hash of every positions node count and best move
+	int64_t     ms_ = 0;
+	SearchStats stats_;
+
+	// methods
+	uint64_t nps () const { return nodes_ * 1000 / uint64_t(max<int64_t>(ms_, 1)); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// mixes value into a running fnv-1a hash a byte at a time
+uint64_t bench_hash(uint64_t hash, const uint64_t &value)
+{
+	for (int i = 0; i < 8; ++i)
+	{
+		hash ^= (value >> (8 * i)) & 0xFF;
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+////////////////////////////////////////
+// searches every bench position to depth with a fresh table so results don't
+// depend on what ran before, the agent is skipped if agentDepth is 0. runs on
+// one thread so node counts are the same on every machine
+BenchResult run_bench(const Agent &agent, const int &boardDepth = BENCH_BOARD_DEPTH, const int &agentDepth = 0,
+					  const int &moves = BENCH_AGENT_MOVES, std::ostream *json = nullptr)
+{
+	BenchResult result;
+	result.signature_ = 14695981039346656037ULL;
+
+	TranspositionTable table(BENCH_TABLE_MB);
+	if (json)
+		*json << "{\"board_depth\":" << boardDepth << ",\"agent_depth\":" << agentDepth << ",\"positions\":[";
+
+	int64_t start = now_ms();
+	for (size_t i = 0; i < BENCH_FENS.size(); ++i)
+	{
+		Board board;
+		board.load_fen(BENCH_FENS[i]);
+		Color color = board.to_move();
+
+		// board search then agent search, each deepening one ply at a time
+		for (int searcher = 0; searcher < 2; ++searcher)
+		{
+			int depth = searcher == 0 ? boardDepth : agentDepth;
+			if (depth <= 0)
+				continue;
+
+			table.clear();
+			SearchInfo info(&table);
+			int64_t positionStart = now_ms();
+			Node node;
+			for (int d = 1; d <= depth; ++d)
+				node = searcher == 0 ? board.min_max_call(board, color, d, &info)
+									 : agent.min_max_call(board, color, d, moves, &info);
+			int64_t ms = now_ms() - positionStart;
+
+			string move = info.pvLength_[0] > 0 ? move_to_lan(board, node.current_, node.desired_, node.promotion_) : "0000";
+			result.nodes_ += info.stats_.nodes_;
+			result.stats_ += info.stats_;
+			result.signature_ = bench_hash(result.signature_, info.stats_.nodes_);
+			for (char c : move)
+				result.signature_ = bench_hash(result.signature_, uint64_t(c));
+
+			cout << "Position " << i + 1 << "/" << BENCH_FENS.size() << (searcher == 0 ? " board " : " agent ")
+				<< move << " nodes " << info.stats_.nodes_ << endl;
+			if (json)
+				*json << (i == 0 && searcher == 0 ? "" : ",") << "{\"fen\":\"" << BENCH_FENS[i]
+					<< "\",\"searcher\":\"" << (searcher == 0 ? "board" : "agent") << "\",\"move\":\"" << move
+					<< "\",\"nodes\":" << info.stats_.nodes_ << ",\"ms\":" << ms << "}";
+		}
+	}
+	result.ms_ = now_ms() - start;
+
+	cout << endl
+		<< "Total time (ms) : " << result.ms_ << endl
+		<< "Nodes searched  : " << result.nodes_ << endl
+		<< "Nodes/second    : " << result.nps() << endl
+		<< "Signature       : " << result.signature_ << endl;
+
+	if (json)
+		*json << "],\"nodes\":" << result.nodes_ << ",\"signature\":" << result.signature_
+			<< ",\"ms\":" << result.ms_ << ",\"nps\":" << result.nps()
+			<< ",\"stats\":" << result.stats_.to_json() << "}" << endl;
+
+	return result;
+}
+
+////////////////////////////////////////
+// reads the signature out of json written by run_bench, 0 if there is none
+uint64_t read_bench_signature(const string &fileName)
+{
+	ifstream in(fileName);
+	string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	// only the run as a whole has a signature, it follows the position list
+	size_t pos = text.rfind("\"signature\":");
+	uint64_t signature = 0;
+	if (pos != string::npos)
+		std::istringstream(text.substr(pos + 12)) >> signature;
+
+	return signature;
+}
+
+#if defined(__cpp_impl_coroutine)
+////////////////////////////////////////
+// scores the root moves of every bench position with score_moves one
+// position at a time, then with every position interleaved on one thread.
+// returns false if any score or the node count differs
+bool run_interleaved_bench(const Agent &agent, const int &depth, const int &moves)
+{
+	vector<Board> boards(BENCH_FENS.size());
+	for (size_t i = 0; i < BENCH_FENS.size(); ++i)
+		boards[i].load_fen(BENCH_FENS[i]);
+
+	SearchInfo recursive;
+	int64_t start = now_ms();
+	vector<vector<Node>> expected;
+	for (const Board &board : boards)
+		expected.push_back(agent.score_moves(board, board.to_move(), depth, moves, &recursive));
+	int64_t recursiveMs = now_ms() - start;
+
+	SearchInfo interleaved;
+	EvalScheduler scheduler;
+	start = now_ms();
+	vector<vector<Node>> scores = agent.score_moves_interleaved(boards, depth, moves, scheduler, &interleaved);
+	int64_t interleavedMs = now_ms() - start;
+
+	bool same = recursive.stats_.nodes_ == interleaved.stats_.nodes_;
+	for (size_t i = 0; i < boards.size(); ++i)
+	{
+		same = same && scores[i].size() == expected[i].size();
+		for (size_t j = 0; same && j < scores[i].size(); ++j)
+			same = scores[i][j].value_ == expected[i][j].value_ && scores[i][j].current_ == expected[i][j].current_ &&
+				   scores[i][j].desired_ == expected[i][j].desired_;
+	}
+
+	cout << "Recursive (ms)   : " << recursiveMs << ", nodes " << recursive.stats_.nodes_ << endl
+		<< "Interleaved (ms) : " << interleavedMs << ", nodes " << interleaved.stats_.nodes_ << endl
+		<< "Scheduler stats  : " << scheduler.stats().to_json() << endl
+		<< (same ? "Scores match" : "Scores differ") << endl;
+
+	return same;
+}
+#endif // __cpp_impl_coroutine
+
+#endif // BENCH_H
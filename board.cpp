@@ -6,6 +6,58 @@
 // DATE:        7/1/2020
 
 #include "board.h"
+#include "tablebase.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ZOBRIST KEYS
+// note: random key of each feature of a position, generated once with a
+//       fixed seed so hashes are the same every run
+struct ZobristKeys {
+	ZobristKeys()
+	{
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		auto next = [&]() { // splitmix64
+			uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		};
+
+		for (int i = 0; i < 16; ++i)
+			for (int j = 0; j < SIZE * SIZE; ++j)
+				pieces_[i][j] = next();
+		for (int i = 0; i < 16; ++i)
+			castling_[i] = next();
+		for (int i = 0; i < SIZE; ++i)
+			enPassant_[i] = next();
+		white_ = next();
+	}
+
+	uint64_t pieces_[16][SIZE * SIZE];
+	uint64_t castling_[16];
+	uint64_t enPassant_[SIZE];
+	uint64_t white_;
+};
+
+const ZobristKeys &zobrist_keys()
+{
+	static const ZobristKeys keys;
+	return keys;
+}
+
+////////////////////////////////////////
+// castling rights lost when a piece leaves or is taken on pos, the squares
+// kings and rooks start on
+int castling_square(const Position &pos)
+{
+	if (pos.first != 0 && pos.first != SIZE - 1)
+		return 0;
+
+	int king = pos.first == 0 ? CASTLE_WHITE_KING : CASTLE_BLACK_KING;
+	int queen = pos.first == 0 ? CASTLE_WHITE_QUEEN : CASTLE_BLACK_QUEEN;
+	return pos.second == 4 ? king | queen : pos.second == SIZE - 1 ? king : pos.second == 0 ? queen : 0;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 //
@@ -13,7 +65,7 @@
 ////////////////////////////////////////
 // init board
 Board::Board() :
-	totalGridPoints_(0), turn_(1)
+	totalGridPoints_(0), turn_(1), halfmoveClock_(0), mapsValid_(false), checkersValid_{ false, false }
 {
 	// set up white side
 	pieces_.push_front(Piece::rook(Color::White, make_pair(0, 0)));
@@ -54,19 +106,10 @@ Board::Board() :
 		for (int j = 0; j < SIZE; ++j)
 			totalGridPoints_ += get_tile_value(make_pair(i, j));
 
+	reset_key();
 	update_move_set();
 }
 
-////////////////////////////////////////
-// board copy constructor, creates a deep copy so current board state isn't modified
-Board::Board(const Board &board)
-{
-	totalGridPoints_ = board.totalGridPoints_;
-	pieces_ = board.pieces_;
-	kingPos_[0] = board.kingPos_[0];
-	kingPos_[1] = board.kingPos_[1];
-}
-
 ////////////////////////////////////////
 // save game to text file to be loaded later
 void Board::save_game(const string &game) const
@@ -97,6 +140,11 @@ void Board::load_game(const string &game)
 	in >> str;
 	turn_ = stoi(str) % 2;
 
+	// saved games don't keep move history
+	halfmoveClock_ = 0;
+	history_.clear();
+	invalidate_maps();
+
 	// get pieces
 	pieces_.clear();
 	while (!in.eof())
@@ -148,6 +196,7 @@ void Board::load_game(const string &game)
 	}
 
 	// update moves
+	reset_key();
 	update_move_set();
 
 	// close stream
@@ -194,130 +243,140 @@ void Board::print() const
 }
 
 ////////////////////////////////////////
-// check if a player is in check
-bool Board::player_in_check(const Color &color) const
+// builds attack maps from pieces if the board changed since they were built
+void Board::build_maps() const
 {
-	// create blank position to check with
-	Position blank(-1, -1);
+	if (mapsValid_)
+		return;
 
-	// pieces that are closest to the king in each direction
-	// direction elements: 0 = up, 1 = down, 2 = left, 3 = right
-	//		4 = up left, 5 = up right, 6 = down left, 7 = down right
-	vector<Piece> direction(8);
-	for (int i = 0; i < 8; ++i)
-		direction[i] = Piece::empty(Color::Empty, blank);
-
-	// get king int
-	int kingNum = int(color);
-
-	// go through all pieces
+	memset(pieceMaps_, 0, sizeof(pieceMaps_));
+	memset(colorMaps_, 0, sizeof(colorMaps_));
 	for (const Piece &p : pieces_)
 		if (p.get_rep() != EMPTY_REP)
 		{
-			Position piecePos = p.get_position();
+			Bitboard bit = square_bit(square_of(p.get_position()));
+			pieceMaps_[int(p.get_color())][piece_code(p) & 7] |= bit;
+			colorMaps_[int(p.get_color())] |= bit;
+		}
 
-			// check up and down
-			if (kingPos_[kingNum].second == piecePos.second)
-			{
-				// check up
-				if ((piecePos.first < direction[0].get_position().first || direction[0].get_position() == blank) &&
-					piecePos.first > kingPos_[kingNum].first)
-					direction[0] = p;
-				// check down
-				else if ((piecePos.first > direction[1].get_position().first || direction[1].get_position() == blank) &&
-						 piecePos.first < kingPos_[kingNum].first)
-					direction[1] = p;
-			}
-			// check left and right
-			else if (kingPos_[kingNum].first == piecePos.first)
-			{
-				// check left
-				if ((piecePos.second > direction[2].get_position().second || direction[2].get_position() == blank) &&
-					piecePos.second < kingPos_[kingNum].second)
-					direction[2] = p;
-				// check right
-				else if ((piecePos.second < direction[3].get_position().second || direction[3].get_position() == blank) &&
-						 piecePos.second > kingPos_[kingNum].second)
-					direction[3] = p;
-			}
-			// check up left and down right
-			else if (double(kingPos_[kingNum].second - piecePos.second) / double(kingPos_[kingNum].first - piecePos.first) == -1) // check slope 
-			{
-				// check up left
-				if ((distance(kingPos_[kingNum], piecePos) < distance(kingPos_[kingNum], direction[4].get_position()) ||
-					 direction[4].get_position() == blank) &&
-					piecePos.first < kingPos_[kingNum].first)
-					direction[4] = p;
-				// check down right
-				else if ((distance(kingPos_[kingNum], piecePos) < distance(kingPos_[kingNum], direction[7].get_position()) ||
-						  direction[7].get_position() == blank) &&
-						 piecePos.first > kingPos_[kingNum].first)
-					direction[7] = p;
-			}
-			// check up right and down left
-			else if (double(kingPos_[kingNum].second - piecePos.second) / double(kingPos_[kingNum].first - piecePos.first) == 1) // check slope
-			{
-				// check up right
-				if ((distance(kingPos_[kingNum], piecePos) < distance(kingPos_[kingNum], direction[5].get_position()) ||
-					 direction[5].get_position() == blank) &&
-					piecePos.first > kingPos_[kingNum].first)
-					direction[5] = p;
-				// check down left
-				else if ((distance(kingPos_[kingNum], piecePos) < distance(kingPos_[kingNum], direction[6].get_position()) ||
-						  direction[6].get_position() == blank) &&
-						 piecePos.first < kingPos_[kingNum].first)
-					direction[6] = p;
-			}
+	mapsValid_ = true;
+	checkersValid_[0] = checkersValid_[1] = false;
+}
 
-			// check all knight positions that can attack the king
-			if (p.get_rep() == KNIGHT_REP && p.get_color() != color &&
-				 // check up right moves
-				(make_pair(kingPos_[kingNum].first + 2, kingPos_[kingNum].second + 1) == piecePos ||
-				 make_pair(kingPos_[kingNum].first + 1, kingPos_[kingNum].second + 2) == piecePos ||
-				 // check up left moves
-				 make_pair(kingPos_[kingNum].first + 2, kingPos_[kingNum].second - 1) == piecePos ||
-				 make_pair(kingPos_[kingNum].first + 1, kingPos_[kingNum].second - 2) == piecePos ||
-				 // check down right moves
-				 make_pair(kingPos_[kingNum].first - 2, kingPos_[kingNum].second + 1) == piecePos ||
-				 make_pair(kingPos_[kingNum].first - 1, kingPos_[kingNum].second + 2) == piecePos ||
-				 // check down left moves
-				 make_pair(kingPos_[kingNum].first - 2, kingPos_[kingNum].second - 1) == piecePos ||
-				 make_pair(kingPos_[kingNum].first - 1, kingPos_[kingNum].second - 2) == piecePos))
-				return true;
-
-			// check white pawn attacks
-			if (p.get_rep() == PAWN_REP && p.get_color() != color && color == Color::Black &&
-				// up left attack
-				piecePos.first + 1 == kingPos_[kingNum].first&&
-				(piecePos.second - 1 == kingPos_[kingNum].second || piecePos.second + 1 == kingPos_[kingNum].second))
-				return true;
-			// check black pawn attacks
-			else if (p.get_rep() == PAWN_REP && p.get_color() != color && color == Color::White &&
-					 // up left attack
-					 piecePos.first - 1 == kingPos_[kingNum].first &&
-					 (piecePos.second - 1 == kingPos_[kingNum].second || piecePos.second + 1 == kingPos_[kingNum].second))
-				return true;
-		}
+////////////////////////////////////////
+// pieces of byColor attacking square, attacks are symmetric so each piece
+// type's attacks are looked up from square and matched against that type
+Bitboard Board::attackers(const int &square, const Color &byColor, const Bitboard &occupied,
+						  const Bitboard &captured) const
+{
+	build_maps();
 
-	// now go through all directions the king can be attacked and verify it is a piece that can attack
-	// check rook attacking directions
-	for (int i = 0; i < 4; ++i)
-		if ((direction[i].get_rep() == ROOK_REP || direction[i].get_rep() == QUEEN_REP) && direction[i].get_color() != color)
-			return true;
+	const Bitboard *maps = pieceMaps_[int(byColor)];
+	Bitboard queens = maps[QUEEN_CODE];
+	Color other = byColor == Color::White ? Color::Black : Color::White;
 
-	// check bishop attacking directions
-	for (int i = 4; i < 8; ++i)
-		if ((direction[i].get_rep() == BISHOP_REP || direction[i].get_rep() == QUEEN_REP) && direction[i].get_color() != color)
-			return true;
+	return ((ATTACKS.knight_[square] & maps[KNIGHT_CODE]) |
+			(ATTACKS.king_[square] & maps[KING_CODE]) |
+			(ATTACKS.pawn_[int(other)][square] & maps[PAWN_CODE]) |
+			(rook_attacks(square, occupied) & (maps[ROOK_CODE] | queens)) |
+			(bishop_attacks(square, occupied) & (maps[BISHOP_CODE] | queens))) & ~captured;
+}
 
-	// if nothing can attack the king then its not in check
-	return false;
+////////////////////////////////////////
+// pieces of byColor attacking square on the current board
+Bitboard Board::attackers(const int &square, const Color &byColor) const
+{
+	build_maps();
+	return attackers(square, byColor, colorMaps_[0] | colorMaps_[1], 0);
+}
+
+////////////////////////////////////////
+// pieces giving check to colors king
+Bitboard Board::checkers(const Color &color) const
+{
+	build_maps();
+
+	int c = int(color);
+	if (!checkersValid_[c])
+	{
+		checkers_[c] = attackers(square_of(kingPos_[c]), color == Color::White ? Color::Black : Color::White);
+		checkersValid_[c] = true;
+	}
+
+	return checkers_[c];
+}
+
+////////////////////////////////////////
+// squares holding rep pieces of color
+Bitboard Board::piece_map(const Color &color, const char &rep) const
+{
+	build_maps();
+	for (int code = 1; code < 7; ++code)
+		if (CODE_REPS[code] == rep)
+			return pieceMaps_[int(color)][code];
+
+	return 0;
+}
+
+////////////////////////////////////////
+// checks if a move leaves its sides king attacked by playing it on the
+// attack maps only, castling also can't start in or cross an attacked square
+bool Board::leaves_king_attacked(const Position &currentPos, const Position &desiredPos) const
+{
+	build_maps();
+
+	auto piece = cfind(pieces_, currentPos);
+	Color color = piece->get_color(), enemy = color == Color::White ? Color::Black : Color::White;
+	int dir = color == Color::White ? 1 : -1;
+	int from = square_of(currentPos);
+
+	// castling
+	if (desiredPos.first == -1 || desiredPos.first == -2)
+	{
+		int step = desiredPos.first == -1 ? 1 : -1;
+		return checkers(color) != 0 ||
+			is_square_attacked(from + step, enemy) ||
+			is_square_attacked(from + 2 * step, enemy);
+	}
+
+	// destination and captured piece, en passant captures beside the destination
+	int to;
+	Bitboard captured;
+	if (desiredPos.first == -3)
+	{
+		to = square_of(make_pair(currentPos.first + 2 * dir, desiredPos.second));
+		captured = 0;
+	}
+	else if (desiredPos.first == -4)
+	{
+		to = square_of(make_pair(currentPos.first + dir, desiredPos.second));
+		captured = square_bit(square_of(make_pair(currentPos.first, desiredPos.second)));
+	}
+	else
+	{
+		to = square_of(desiredPos);
+		captured = square_bit(to);
+	}
+
+	Bitboard occupied = ((colorMaps_[0] | colorMaps_[1]) & ~square_bit(from) & ~captured) | square_bit(to);
+	int king = piece->get_rep() == KING_REP ? to : square_of(kingPos_[int(color)]);
+
+	return attackers(king, enemy, occupied, captured) != 0;
 }
 
 ////////////////////////////////////////
 // moving a piece
-void Board::make_move(const Position &currentPos, const Position &desiredPos)
+// note: promotion is the piece a pawn reaching the last row becomes
+void Board::make_move(const Position &currentPos, const Position &desiredPos, const char &promotion)
 {
+	// position before the move, for repetition checks. key_ is updated as
+	// pieces are lifted and placed, castling rights can only change when a
+	// king or rook square is left or taken
+	const ZobristKeys &keys = zobrist_keys();
+	auto toggle = [&](const Piece &piece) { key_ ^= keys.pieces_[piece_code(piece)][square_of(piece.get_position())]; };
+	uint64_t before = key_;
+	int castling = castling_square(currentPos) | castling_square(desiredPos) ? castling_rights() : -1;
+
 	// get piece
 	auto p = find(pieces_, currentPos);
 
@@ -335,12 +394,18 @@ void Board::make_move(const Position &currentPos, const Position &desiredPos)
 
 	// get piece, iterator may have gone stale from erase function
 	p = find(pieces_, currentPos);
+	toggle(*p);
+
+	// pawn moves and captures can't be undone, reset fifty move count
+	bool irreversible = p->get_rep() == PAWN_REP;
+	bool promoted = false;
 
 	// update board
 	if (desiredPos.first == -1) // check king side castle 
 	{
 		// get rook
 		auto rook = find(pieces_, make_pair(currentPos.first, currentPos.second + 3));
+		toggle(*rook);
 
 		// change king position
 		p->set_position(make_pair(currentPos.first, currentPos.second + 2));
@@ -350,11 +415,13 @@ void Board::make_move(const Position &currentPos, const Position &desiredPos)
 		// change rook position
 		rook->set_position(make_pair(currentPos.first, currentPos.second + 1));
 		rook->set_has_moved(true);
+		toggle(*rook);
 	}
 	else if (desiredPos.first == -2) // check queen side castle 
 	{
 		// get rook
 		auto rook = find(pieces_, make_pair(currentPos.first, currentPos.second - 4));
+		toggle(*rook);
 
 		// change king position
 		p->set_position(make_pair(currentPos.first, currentPos.second - 2));
@@ -364,6 +431,7 @@ void Board::make_move(const Position &currentPos, const Position &desiredPos)
 		// change rook position
 		rook->set_position(make_pair(currentPos.first, currentPos.second - 1));
 		rook->set_has_moved(true);
+		toggle(*rook);
 	}
 	else if (desiredPos.first == -3 && color == Color::Black) // black pawn jump
 	{
@@ -408,13 +476,14 @@ void Board::make_move(const Position &currentPos, const Position &desiredPos)
 
 		// delete pawn that was captured
 		it = find(pieces_, make_pair(currentPos.first, desiredPos.second));
+		toggle(*it);
 		pieces_.erase(it);
 	}
-	else if ((desiredPos.first == 0 || // check pawn queen promotion
+	else if ((desiredPos.first == 0 || // check pawn promotion
 			  desiredPos.first == SIZE - 1) &&
 			 p->get_rep() == PAWN_REP)
 	{
-		// delete pawn and replace with queen
+		// delete pawn and replace with promoted piece
 		auto it = find(pieces_, currentPos);
 		pieces_.erase(it);
 
@@ -422,10 +491,15 @@ void Board::make_move(const Position &currentPos, const Position &desiredPos)
 		it = find(pieces_, desiredPos);
 
 		if (it != pieces_.end()) // there is a piece at that pos
+		{
+			toggle(*it);
 			pieces_.erase(it);
+		}
 
-		// create queen
-		pieces_.push_front(Piece::queen(color, desiredPos, true));
+		// create promoted piece
+		pieces_.push_front(Piece::create(promotion, color, desiredPos, true));
+		toggle(pieces_.front());
+		promoted = true;
 	}
 	else
 	{
@@ -433,7 +507,12 @@ void Board::make_move(const Position &currentPos, const Position &desiredPos)
 		auto it = find(pieces_, desiredPos);
 
 		if (it != pieces_.end()) // there is a piece at that pos
+		{
+			irreversible = irreversible || it->get_rep() != EMPTY_REP;
+			if (it->get_rep() != EMPTY_REP)
+				toggle(*it);
 			pieces_.erase(it);
+		}
 
 		// change position to desired
 		p->set_position(desiredPos);
@@ -444,70 +523,464 @@ void Board::make_move(const Position &currentPos, const Position &desiredPos)
 
 		p->set_has_moved(true);
 	}
+
+	// next turn, earlier positions can't repeat after an irreversible move
+	halfmoveClock_ = irreversible ? 0 : halfmoveClock_ + 1;
+	if (irreversible)
+		history_.clear();
+	else
+		history_.push_back(before);
+	++turn_;
+	invalidate_maps();
+
+	// the moved piece where it landed, the other side to move, the pawn that
+	// just jumped if it can be taken and the castles still possible
+	if (!promoted)
+		toggle(*p);
+	key_ ^= keys.white_;
+	if (keyedEnPassant_ >= 0)
+		key_ ^= keys.enPassant_[keyedEnPassant_];
+	keyedEnPassant_ = desiredPos.first == -3 && en_passant_legal(currentPos.second) ? currentPos.second : -1;
+	if (keyedEnPassant_ >= 0)
+		key_ ^= keys.enPassant_[keyedEnPassant_];
+	if (castling >= 0)
+		key_ ^= keys.castling_[castling] ^ keys.castling_[castling_rights()];
 }
 
 ////////////////////////////////////////
-// check for stalemate or checkmate, 0 = game not over, 1 = checkmate, 2 = stalemate
-int Board::end_game(const Color &color) const
+// squares holding pieces of color, Empty gives both colors, en passant markers aren't pieces
+Bitboard Board::occupancy(const Color &color) const
 {
-	bool check = player_in_check(color);
+	build_maps();
+	if (color == Color::Empty)
+		return colorMaps_[0] | colorMaps_[1];
+
+	return colorMaps_[int(color)];
+}
 
-	// find all pieces that have moves
-	vector<Piece> colorPiecesWithMoves, piecesWithMoves;
+////////////////////////////////////////
+// castles that are still possible, king and rook must not have moved
+int Board::castling_rights() const
+{
+	auto unmoved = [&](const Position &pos, const char &rep, const Color &color) {
+		auto it = cfind(pieces_, pos);
+		return it != pieces_.end() && it->get_rep() == rep && it->get_color() == color && !it->has_moved();
+	};
+
+	int rights = 0;
+	if (unmoved(make_pair(0, 4), KING_REP, Color::White))
+	{
+		if (unmoved(make_pair(0, SIZE - 1), ROOK_REP, Color::White))
+			rights |= CASTLE_WHITE_KING;
+		if (unmoved(make_pair(0, 0), ROOK_REP, Color::White))
+			rights |= CASTLE_WHITE_QUEEN;
+	}
+	if (unmoved(make_pair(SIZE - 1, 4), KING_REP, Color::Black))
+	{
+		if (unmoved(make_pair(SIZE - 1, SIZE - 1), ROOK_REP, Color::Black))
+			rights |= CASTLE_BLACK_KING;
+		if (unmoved(make_pair(SIZE - 1, 0), ROOK_REP, Color::Black))
+			rights |= CASTLE_BLACK_QUEEN;
+	}
+
+	return rights;
+}
+
+////////////////////////////////////////
+// column of the pawn that just jumped, the marker left behind by the player
+// to move is stale and is removed on their next move
+int Board::en_passant_col() const
+{
 	for (const Piece &p : pieces_)
-		// if piece has at least one move, add it to the list
-		if (!p.move_list().empty())
+		if (p.get_rep() == EMPTY_REP && p.get_color() != to_move())
+			return p.get_position().second;
+
+	return -1;
+}
+
+////////////////////////////////////////
+// the pawn that jumped on col stands beside a pawn of the side to move that
+// can take it without leaving its king attacked
+bool Board::en_passant_legal(const int &col) const
+{
+	Color color = to_move();
+	int row = color == Color::White ? SIZE / 2 : SIZE / 2 - 1;
+	for (int side : { col - 1, col + 1 })
+	{
+		if (side < 0 || side >= SIZE)
+			continue;
+
+		auto it = cfind(pieces_, make_pair(row, side));
+		if (it != pieces_.end() && it->get_rep() == PAWN_REP && it->get_color() == color &&
+			!leaves_king_attacked(make_pair(row, side), make_pair(-4, col)))
+			return true;
+	}
+
+	return false;
+}
+
+////////////////////////////////////////
+// sets up board from piece codes and position state, shared by load_fen and unpack.
+// returns false and leaves board unchanged if the position can't happen
+bool Board::set_position(const uint8_t codes[SIZE][SIZE], const Color &color, const int &castling,
+						 const int &enPassantCol, const int &halfmove, const int &fullmove)
+{
+	// pieces are placed as moved so only castling rights and unmoved pawns can change that
+	PieceList pieces;
+	Position kingPos[2];
+	int kings[2] = { 0, 0 };
+	for (int i = 0; i < SIZE; ++i)
+		for (int j = 0; j < SIZE; ++j)
 		{
-			if (p.get_color() == color)
-				colorPiecesWithMoves.push_back(p);
+			if (codes[i][j] == 0)
+				continue;
 
-			piecesWithMoves.push_back(p);
+			char rep = CODE_REPS[codes[i][j] & 7];
+			Color pieceColor = codes[i][j] & 8 ? Color::Black : Color::White;
+			if (rep == EMPTY_REP)
+				return false;
+
+			bool hasMoved = true;
+			if (rep == KING_REP)
+			{
+				kingPos[int(pieceColor)] = make_pair(i, j);
+				++kings[int(pieceColor)];
+			}
+			else if (rep == PAWN_REP)
+			{
+				if (i == 0 || i == SIZE - 1)
+					return false;
+				hasMoved = !((pieceColor == Color::White && i == 1) || (pieceColor == Color::Black && i == SIZE - 2));
+			}
+
+			pieces.push_back(Piece::create(rep, pieceColor, make_pair(i, j), hasMoved));
 		}
 
-	// if no piece can move, and player is in check then player has been checkmated
-	if (colorPiecesWithMoves.empty() && check)
-		return 1;
-	// if no pieces can move, and player isnt in check then player has been stalemated
-	else if (colorPiecesWithMoves.empty())
-		return 2;
-	// king vs king stalemate
-	else if (piecesWithMoves.size() == 2)
-		return 2;
-	// check all unsufficient material to checkmate possibilities
-	else if (piecesWithMoves.size() == 3 || piecesWithMoves.size() == 4)
-	{
-		// count how many of which pieces are in left
-		int darkBishop = 0,
-			lightBishop = 0,
-			knight = 0;
-		for (const Piece &p : pieces_)
+	if (kings[0] != 1 || kings[1] != 1 || halfmove < 0 || fullmove < 1)
+		return false;
+
+	// the side not to move can't be in check, its king would be taken.
+	// kings next to each other attack each other
+	Color other = color == Color::White ? Color::Black : Color::White;
+	Bitboard occupied = 0, king = square_bit(square_of(kingPos[int(other)]));
+	for (const Piece &p : pieces)
+		occupied |= square_bit(square_of(p.get_position()));
+	for (const Piece &p : pieces)
+		if (p.get_color() == color && (piece_attacks(p.get_rep(), color, square_of(p.get_position()), occupied) & king))
+			return false;
+
+	// castling rights mark king and rook as unmoved, rights without them in place are ignored
+	auto unmove = [&](const Position &kingPosition, const Position &rookPosition, const Color &c) {
+		auto king = find(pieces, kingPosition), rook = find(pieces, rookPosition);
+		if (king == pieces.end() || rook == pieces.end() ||
+			king->get_rep() != KING_REP || king->get_color() != c ||
+			rook->get_rep() != ROOK_REP || rook->get_color() != c)
+			return;
+
+		king->set_has_moved(false);
+		rook->set_has_moved(false);
+	};
+	if (castling & CASTLE_WHITE_KING)
+		unmove(make_pair(0, 4), make_pair(0, SIZE - 1), Color::White);
+	if (castling & CASTLE_WHITE_QUEEN)
+		unmove(make_pair(0, 4), make_pair(0, 0), Color::White);
+	if (castling & CASTLE_BLACK_KING)
+		unmove(make_pair(SIZE - 1, 4), make_pair(SIZE - 1, SIZE - 1), Color::Black);
+	if (castling & CASTLE_BLACK_QUEEN)
+		unmove(make_pair(SIZE - 1, 4), make_pair(SIZE - 1, 0), Color::Black);
+
+	// en passant marker is left on the square the opponents pawn jumped over
+	if (enPassantCol >= 0)
+	{
+		if (enPassantCol >= SIZE)
+			return false;
+
+		Color jumped = color == Color::White ? Color::Black : Color::White;
+		pieces.push_front(Piece::empty(jumped, make_pair(jumped == Color::White ? 2 : SIZE - 3, enPassantCol)));
+	}
+
+	pieces_ = pieces;
+	kingPos_[0] = kingPos[0];
+	kingPos_[1] = kingPos[1];
+	turn_ = 2 * fullmove - (color == Color::White ? 1 : 0);
+	halfmoveClock_ = halfmove;
+	history_.clear();
+	invalidate_maps();
+	reset_key();
+	update_move_set();
+
+	return true;
+}
+
+////////////////////////////////////////
+// sets up board from a fen string, move counters may be left off
+bool Board::load_fen(const string &fen)
+{
+	std::istringstream in(fen);
+	string placement, side, castling, enPassant;
+	if (!(in >> placement >> side))
+		return false;
+	if (!(in >> castling))
+		castling = "-";
+	if (!(in >> enPassant))
+		enPassant = "-";
+
+	int halfmove = 0, fullmove = 1;
+	if (!(in >> halfmove))
+		halfmove = 0;
+	if (!(in >> fullmove))
+		fullmove = 1;
+
+	// piece placement, listed from the last row down
+	uint8_t codes[SIZE][SIZE] = {};
+	int i = SIZE - 1, j = 0;
+	for (const char &c : placement)
+	{
+		if (c == '/')
+		{
+			if (j != SIZE || i == 0)
+				return false;
+			--i;
+			j = 0;
+		}
+		else if (c >= '1' && c <= '8')
+			j += c - '0';
+		else
+		{
+			Piece p = Piece::create(char(toupper(c)), isupper(c) ? Color::White : Color::Black, make_pair(i, j));
+			if (p.get_rep() == EMPTY_REP || j >= SIZE)
+				return false;
+			codes[i][j++] = piece_code(p);
+		}
+
+		if (j > SIZE)
+			return false;
+	}
+	if (i != 0 || j != SIZE || (side != "w" && side != "b"))
+		return false;
+
+	// castling rights
+	int rights = 0;
+	for (const char &c : castling)
+		switch (c)
+		{
+		case 'K': rights |= CASTLE_WHITE_KING; break;
+		case 'Q': rights |= CASTLE_WHITE_QUEEN; break;
+		case 'k': rights |= CASTLE_BLACK_KING; break;
+		case 'q': rights |= CASTLE_BLACK_QUEEN; break;
+		case '-': break;
+		default: return false;
+		}
+
+	// en passant square, only the column is needed
+	int enPassantCol = -1;
+	if (enPassant != "-")
+	{
+		if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' ||
+			enPassant[1] != (side == "w" ? '6' : '3'))
+			return false;
+		enPassantCol = enPassant[0] - 'a';
+	}
+
+	return set_position(codes, side == "w" ? Color::White : Color::Black, rights, enPassantCol, halfmove, fullmove);
+}
+
+////////////////////////////////////////
+// creates fen string of board
+string Board::to_fen() const
+{
+	char squares[SIZE][SIZE] = {};
+	for (const Piece &p : pieces_)
+		if (p.get_rep() != EMPTY_REP)
+			squares[p.get_position().first][p.get_position().second] =
+				p.get_color() == Color::White ? p.get_rep() : char(tolower(p.get_rep()));
+
+	// piece placement, empty squares are counted
+	string fen;
+	for (int i = SIZE - 1; i >= 0; --i)
+	{
+		int empty = 0;
+		for (int j = 0; j < SIZE; ++j)
 		{
-			char rep = p.get_rep();
-
-			if (rep == BISHOP_REP &&
-				(p.get_position().first + p.get_position().second) % 2 == 1)
-				++lightBishop;
-			else if (rep == BISHOP_REP &&
-					 (p.get_position().first + p.get_position().second) % 2 == 0)
-				++darkBishop;
-			else if (rep == KNIGHT_REP)
-				++knight;
+			if (!squares[i][j])
+			{
+				++empty;
+				continue;
+			}
+
+			if (empty)
+				fen += char('0' + empty);
+			fen += squares[i][j];
+			empty = 0;
 		}
 
-		// king vs king and bishop
-		if ((((darkBishop == 1 && lightBishop == 0) ||
-			  (darkBishop == 0 && lightBishop == 1)) &&
-			 knight == 0 &&
-			 piecesWithMoves.size() == 3) ||
-			// king vs king and knight
-			(darkBishop == 0 && lightBishop == 0 &&
-			 knight == 1 &&
-			 piecesWithMoves.size() == 3) ||
-			// bishop and king vs bishop and king with same color bishop
-			(darkBishop == 2 || lightBishop == 2))
-			return 2;
+		if (empty)
+			fen += char('0' + empty);
+		if (i != 0)
+			fen += '/';
+	}
+
+	// side to move
+	fen += to_move() == Color::White ? " w " : " b ";
+
+	// castling rights
+	int rights = castling_rights();
+	if (rights & CASTLE_WHITE_KING) fen += 'K';
+	if (rights & CASTLE_WHITE_QUEEN) fen += 'Q';
+	if (rights & CASTLE_BLACK_KING) fen += 'k';
+	if (rights & CASTLE_BLACK_QUEEN) fen += 'q';
+	if (!rights) fen += '-';
+
+	// en passant square
+	int col = en_passant_col();
+	if (col >= 0)
+	{
+		fen += ' ';
+		fen += char('a' + col);
+		fen += to_move() == Color::White ? '6' : '3';
+	}
+	else
+		fen += " -";
+
+	return fen + ' ' + std::to_string(halfmoveClock_) + ' ' + std::to_string((turn_ + 1) / 2);
+}
+
+////////////////////////////////////////
+// packs board into 32 bytes
+PackedPosition Board::pack() const
+{
+	PackedPosition packed;
+	memset(&packed, 0, sizeof(packed));
+
+	uint8_t codes[SIZE * SIZE] = {};
+	for (const Piece &p : pieces_)
+		if (p.get_rep() != EMPTY_REP)
+			codes[square_of(p.get_position())] = piece_code(p);
+
+	// piece codes of occupied squares in order
+	packed.occupied_ = occupancy();
+	int n = 0;
+	for (Bitboard b = packed.occupied_; b; b &= b - 1, ++n)
+		packed.pieces_[n / 2] |= codes[lsb(b)] << (n % 2 * 4);
+
+	int col = en_passant_col();
+	packed.flags_ = uint8_t((to_move() == Color::White ? 1 : 0) | castling_rights() << 1);
+	packed.enPassant_ = col >= 0 ? uint8_t(col) : NO_EN_PASSANT;
+	packed.halfmoveClock_ = uint16_t(halfmoveClock_);
+	packed.fullmove_ = uint16_t((turn_ + 1) / 2);
+
+	return packed;
+}
+
+////////////////////////////////////////
+// sets up board from a packed position
+bool Board::unpack(const PackedPosition &packed)
+{
+	// at most 32 pieces fit
+	if (popcount(packed.occupied_) > 32)
+		return false;
+
+	uint8_t codes[SIZE][SIZE] = {};
+	int n = 0;
+	for (Bitboard b = packed.occupied_; b; b &= b - 1, ++n)
+	{
+		int square = lsb(b);
+		codes[square / SIZE][square % SIZE] = (packed.pieces_[n / 2] >> (n % 2 * 4)) & 0xF;
 	}
 
+	return set_position(codes, packed.flags_ & 1 ? Color::White : Color::Black, packed.flags_ >> 1,
+						packed.enPassant_ == NO_EN_PASSANT ? -1 : packed.enPassant_,
+						packed.halfmoveClock_, packed.fullmove_);
+}
+
+////////////////////////////////////////
+// hashes the whole position, each feature of the position has a random key
+// and the hash is every present feature's key xored together
+void Board::reset_key()
+{
+	const ZobristKeys &keys = zobrist_keys();
+	key_ = 0;
+	for (const Piece &p : pieces_)
+		if (p.get_rep() != EMPTY_REP)
+			key_ ^= keys.pieces_[piece_code(p)][square_of(p.get_position())];
+
+	// the jumped pawn is only part of the position when it can be taken
+	keyedEnPassant_ = en_passant_col();
+	if (keyedEnPassant_ >= 0 && !en_passant_legal(keyedEnPassant_))
+		keyedEnPassant_ = -1;
+	if (keyedEnPassant_ >= 0)
+		key_ ^= keys.enPassant_[keyedEnPassant_];
+	if (to_move() == Color::White)
+		key_ ^= keys.white_;
+
+	key_ ^= keys.castling_[castling_rights()];
+}
+
+////////////////////////////////////////
+// counts earlier occurrences of the current position, positions with the same
+// side to move are every second entry and history starts after the last
+// irreversible move so nothing further back needs to be checked. each side
+// has to move a piece away and back, so the nearest possible repeat is four
+// plies ago
+int Board::repetitions() const
+{
+	int count = 0;
+	for (int i = int(history_.size()) - 4; i >= 0; i -= 2)
+		if (history_[i] == key_)
+			++count;
+
+	return count;
+}
+
+////////////////////////////////////////
+// checks fifty move rule and threefold repetition
+bool Board::is_draw() const
+{
+	return halfmoveClock_ >= 100 || repetitions() >= 2;
+}
+
+////////////////////////////////////////
+// check if game is over, 1 = color has been checkmated, 2 = draw
+// note: uses counts kept by update_move_set and the hash kept by make_move,
+//       check is only looked for when color has no moves
+int Board::end_game(const Color &color) const
+{
+	// if no piece can move, player has been checkmated if in check otherwise stalemated
+	if (movable_[int(color)] == 0)
+		return player_in_check(color) ? 1 : 2;
+
+	// fifty move rule, threefold repetition or not enough material to checkmate
+	if (is_draw() || insufficient_material())
+		return 2;
+
+	return 0;
+}
+
+////////////////////////////////////////
+// checks if neither side can checkmate, kings with at most one minor piece
+// or with only bishops that are all on the same shade of square
+bool Board::insufficient_material() const
+{
+	for (Color color : { Color::Black, Color::White })
+		if (material(color, PAWN_REP) || material(color, ROOK_REP) || material(color, QUEEN_REP))
+			return false;
+
+	int knights = material(Color::White, KNIGHT_REP) + material(Color::Black, KNIGHT_REP);
+	int bishops = bishopShades_[0] + bishopShades_[1];
+
+	return knights + bishops <= 1 ||
+		(knights == 0 && (bishopShades_[0] == 0 || bishopShades_[1] == 0));
+}
+
+////////////////////////////////////////
+// number of rep pieces color has
+int Board::material(const Color &color, const char &rep) const
+{
+	// code of a piece is the index of its letter
+	for (int code = 1; code < 7; ++code)
+		if (CODE_REPS[code] == rep)
+			return material_[int(color)][code];
+
 	return 0;
 }
 
@@ -517,6 +990,25 @@ void Board::update_move_set()
 {
 	for (Piece &p : pieces_)
 		p.get_moves(*this);
+
+	// count material and pieces that can move for end_game
+	memset(material_, 0, sizeof(material_));
+	memset(bishopShades_, 0, sizeof(bishopShades_));
+	memset(movable_, 0, sizeof(movable_));
+	pieceCount_ = 0;
+	for (const Piece &p : pieces_)
+	{
+		if (p.get_rep() == EMPTY_REP)
+			continue;
+
+		int color = int(p.get_color());
+		++material_[color][piece_code(p) & 7];
+		++pieceCount_;
+		if (p.get_rep() == BISHOP_REP)
+			++bishopShades_[(p.get_position().first + p.get_position().second) % 2];
+		if (!p.move_list().empty())
+			++movable_[color];
+	}
 }
 
 ////////////////////////////////////////
@@ -605,9 +1097,21 @@ double Board::favor() const
 		(favor[int(Color::Black)] + (positionFavor[int(Color::Black)] / 10));
 }
 
+////////////////////////////////////////
+// checks that the side to move has a piece at currentPos that can move to desiredPos
+bool Board::legal_move(const Position &currentPos, const Position &desiredPos) const
+{
+	auto it = cfind(pieces_, currentPos);
+	if (it == pieces_.end() || it->get_color() != to_move() || it->get_rep() == EMPTY_REP)
+		return false;
+
+	const vector<Position> &moves = it->move_list();
+	return std::find(moves.begin(), moves.end(), desiredPos) != moves.end();
+}
+
 ////////////////////////////////////////
 // min max calling func for cpu moves
-Node Board::min_max_call(const Board &board, const Color &maximizingColor, const int &depth)
+Node Board::min_max_call(const Board &board, const Color &maximizingColor, const int &depth, SearchInfo *info)
 {
 	// init alpha and beta
 	double alpha = -1 * std::numeric_limits<double>::max(),
@@ -621,72 +1125,138 @@ Node Board::min_max_call(const Board &board, const Color &maximizingColor, const
 	// create vector for async functions
 	//vector<future<double>> minMaxAsync;
 
-	Node value(0, Position(), Position());
-	if (maximizingColor == Color::White)
+	// a search given no info uses its own so repetitions are still found
+	RootInfo root(info);
+	info = root.get();
+
+	DepthTimer timer(info, depth);
+	if (info)
 	{
-		value.value_ = -1 * std::numeric_limits<double>::max();
+		info->rootDepth_ = depth;
+		info->enter(0);
+	}
 
-		// for every move
-		for (const Piece &p : board.pieces_)
-			if (p.get_color() == maximizingColor)
-				for (const Position &move : p.move_list())
-				{
-					// copy board
-					Board update(board);
+	// endgame tables know the best move without searching
+	TablebaseResult result;
+	Node tablebaseMove;
+	if (info && info->tablebases_ && info->tablebases_->probe_root(board, tablebaseMove, result))
+	{
+		++info->stats_.tablebaseHits_;
+		tablebaseMove.value_ = result.value(maximizingColor, 0.0, TABLEBASE_WIN);
+		info->pv_[0][0] = tablebaseMove;
+		info->pvLength_[0] = 1;
+		return tablebaseMove;
+	}
 
-					// move piece
-					update.make_move(p.get_position(), move);
+	// best move of an earlier search is tried first
+	TranspositionTable *table = info ? info->table_ : nullptr;
+	TableEntry entry;
+	bool hashMove = table && table->probe(board.hash(), entry) &&
+		board.legal_move(entry.move().current_, entry.move().desired_);
+	if (table)
+	{
+		++info->stats_.tableProbes_;
+		info->stats_.tableHits_ += hashMove;
+	}
 
-					// update move set after move completed
-					update.update_move_set();
+	bool white = maximizingColor == Color::White;
+	Node value(white ? -1 * std::numeric_limits<double>::max() : std::numeric_limits<double>::max(),
+			   Position(), Position());
+	bool found = false; // first move is kept even if every move loses
 
-					value = max(value,
-								Node(min_max(update, depth - 1, alpha, beta, Color::Black),
-									 p.get_position(), move));
-			
-					// set alpha
-					alpha = max(value.value_, alpha);
-				}
-	}
-	else
-	{
-		value.value_ = std::numeric_limits<double>::max();
+	// searches one move, returns false if the search was stopped
+	auto search_move = [&](const Position &current, const Position &move, const char &promotion) {
+		// copy board
+		Board update(board);
 
-		// for every move
-		for (const Piece &p : board.pieces_)
-			if (p.get_color() == maximizingColor)
-				for (const Position &move : p.move_list())
-				{
-					// copy board
-					Board update(board);
+		// move piece
+		update.make_move(current, move, promotion);
 
-					// move piece
-					update.make_move(p.get_position(), move);
+		// update move set after move completed
+		update.update_move_set();
 
-					// update move set after move completed
-					update.update_move_set();
+		Node node(min_max(update, depth - 1, alpha, beta, white ? Color::Black : Color::White, info),
+				  current, move, promotion);
 
-					value = min(value,
-								Node(min_max(update, depth - 1, alpha, beta, Color::White),
-									 p.get_position(), move));
+		// stopped searches return the best move found so far
+		if (info && info->stop_)
+			return false;
 
-					// set beta
-					beta = min(beta, value.value_);
-				}
-	}
+		if (!found || (white ? value < node : node < value))
+		{
+			value = node;
+			found = true;
+			if (info)
+				info->update_pv(0, node);
+		}
+
+		// set alpha/beta
+		if (white)
+			alpha = max(value.value_, alpha);
+		else
+			beta = min(beta, value.value_);
+
+		return true;
+	};
+
+	Node hash = entry.move();
+	if (hashMove && !search_move(hash.current_, hash.desired_, hash.promotion_))
+		return value;
+
+	// for every move, pawns reaching the last row once for each promotion
+	for (const Piece &p : board.pieces_)
+		if (p.get_color() == maximizingColor)
+			for (const Position &move : p.move_list())
+				for (int i = 0; i < promotion_choices(p, move); ++i)
+					if (!(hashMove && hash.same_move(Node(0, p.get_position(), move, PROMOTIONS[i]))) &&
+						!search_move(p.get_position(), move, PROMOTIONS[i]))
+						return value;
+
+	// root is searched with a full window so its value is exact
+	if (table && found)
+		table->store(board.hash(), depth, value.value_, -1 * std::numeric_limits<double>::max(),
+					 std::numeric_limits<double>::max(), value);
 
 	return value;
 }
 
 ////////////////////////////////////////
 // min max branching function
-double Board::min_max(const Board &board, int depth, double alpha, double beta, Color maximizingColor)
+double Board::min_max(const Board &board, int depth, double alpha, double beta, Color maximizingColor, SearchInfo *info)
 {
+	// count node and check if search was stopped
+	int ply = 0;
+	if (info)
+	{
+		ply = info->rootDepth_ - depth;
+		info->enter(ply);
+		if (info->should_stop())
+			return 0.0;
+	}
+
+	// a repeated position is scored as a draw, the side that could avoid it
+	// would have if it was better for them
+	if (ply > 0 && board.repetitions() > 0)
+		return 0.0;
+
 	//cout << depth << endl;
 	// check if game is over
 	int outcome = board.end_game(Color(maximizingColor));
+
+	// positions in the endgame tables are scored without searching them
+	TablebaseResult result;
+	if (outcome == 0 && ply > 0 && info && info->tablebases_ && info->tablebases_->probe(board, result))
+	{
+		++info->stats_.tablebaseHits_;
+		return result.value(maximizingColor, 0.0, TABLEBASE_WIN);
+	}
+
 	if (depth == 0 && outcome == 0)
+	{
+		if (info)
+			++info->stats_.evals_;
 		return board.favor();
+	}
 	else if (outcome == 1 && maximizingColor == Color::White)
 		return -1 * std::numeric_limits<double>::max();
 	else if (outcome == 1 && maximizingColor == Color::Black)
@@ -694,72 +1264,111 @@ double Board::min_max(const Board &board, int depth, double alpha, double beta,
 	else if (outcome == 2)
 		return 0.0;
 
-	double value;
-	if (maximizingColor == Color::White)
+	// earlier result for this position, its best move is tried first otherwise
+	TranspositionTable *table = info ? info->table_ : nullptr;
+	uint64_t key = 0;
+	TableEntry entry;
+	bool hashMove = false;
+	if (table)
 	{
-		value = -1 * std::numeric_limits<double>::max();
+		key = board.hash();
+		++info->stats_.tableProbes_;
+		if (table->probe(key, entry))
+		{
+			++info->stats_.tableHits_;
+			if (entry.usable(depth, alpha, beta))
+			{
+				++info->stats_.tableCutoffs_;
+				return entry.value_;
+			}
+			hashMove = board.legal_move(entry.move().current_, entry.move().desired_);
+		}
+	}
 
-		// for every move
-		for (const Piece &p : board.pieces_)
-			if (p.get_color() == maximizingColor)
-				for (const Position &move : p.move_list())
-				{
-					// copy board
-					Board update(board);
+	bool white = maximizingColor == Color::White;
+	double alphaStart = alpha, betaStart = beta;
+	double value = white ? -1 * std::numeric_limits<double>::max() : std::numeric_limits<double>::max();
+	Node best;
+	int searched = 0;
 
-					// move piece
-					update.make_move(p.get_position(), move);
+	// searches one move, returns true if no more moves need to be searched
+	auto search_move = [&](const Position &current, const Position &move, const char &promotion) {
+		++searched;
 
-					// update move set after move completed
-					update.update_move_set();
+		// copy board
+		Board update(board);
 
-					value = max(value, min_max(update, depth - 1, alpha, beta, Color::Black));
+		// move piece
+		update.make_move(current, move, promotion);
 
-					// set alpha
-					alpha = max(value, alpha);
+		// update move set after move completed
+		update.update_move_set();
 
-					if (alpha >= beta)
-						return value;
-				}
-				
-	}
-	else // maximizeColor == Black
-	{
-		value = std::numeric_limits<double>::max();
+		double score = min_max(update, depth - 1, alpha, beta, white ? Color::Black : Color::White, info);
+		if (info && info->stop_)
+			return true;
 
-		// for every move
-		for (const Piece &p : board.pieces_)
-			if (p.get_color() == maximizingColor)
-				for (const Position &move : p.move_list())
-				{
-					// copy board
-					Board update(board);
-					
-					// move piece
-					update.make_move(p.get_position(), move);
+		if (white ? score > value : score < value)
+		{
+			value = score;
+			best = Node(score, current, move, promotion);
+			if (info)
+				info->update_pv(ply, best);
+		}
 
-					// update move set after move completed
-					update.update_move_set();
+		// set alpha/beta
+		if (white)
+			alpha = max(value, alpha);
+		else
+			beta = min(beta, value);
 
-					value = min(value, min_max(update, depth - 1, alpha, beta, Color::White));
+		return alpha >= beta;
+	};
 
-					// set beta
-					beta = min(beta, value);
+	Node hash = entry.move();
+	bool done = hashMove && search_move(hash.current_, hash.desired_, hash.promotion_);
 
-					if (alpha >= beta)
-						return value;
-				}
+	// for every move, pawns reaching the last row once for each promotion
+	for (auto p = board.pieces_.begin(); !done && p != board.pieces_.end(); ++p)
+		if (p->get_color() == maximizingColor)
+			for (auto move = p->move_list().begin(); !done && move != p->move_list().end(); ++move)
+				for (int i = 0; !done && i < promotion_choices(*p, *move); ++i)
+					if (!(hashMove && hash.same_move(Node(0, p->get_position(), *move, PROMOTIONS[i]))))
+						done = search_move(p->get_position(), *move, PROMOTIONS[i]);
+
+	if (info && info->stop_)
+		return 0.0;
+
+	// cutoff counts show how well moves are ordered
+	if (info && done)
+	{
+		++info->stats_.cutoffs_;
+		info->stats_.firstMoveCutoffs_ += searched == 1;
 	}
 
+	if (table)
+		table->store(key, depth, value, alphaStart, betaStart, best);
+
 	return value;
 }
 
 ////////////////////////////////////////
 // play chess against basic cpu
-void Board::play(const Color &cpu, const int &depth)
+void Board::play(const Color &cpu, const int &depth, const bool &ponder)
 {
-	// color of player whos turn it is, begin with white
-	Color color = Color(turn_);
+	// color of player whos turn it is
+	Color color = to_move();
+
+	// search results are kept between turns, pondering fills the table
+	// with the position the cpu expects to face next
+	TranspositionTable table;
+	SearchInfo info(&table), ponderInfo(&table);
+	std::thread ponderThread;
+	Node predicted, pondered, ponderedReply; // pondered and the reply its line expects are from the deepest ponder search that finished
+	int ponderedDepth = 0;
+	bool ponderedHasReply = false;
+	bool ponderHit = false;
+	int64_t searchMs = 0; // time the last cpu search took, a ponder hit gets as long to finish
 
 	// display current board
 	print();
@@ -783,14 +1392,66 @@ void Board::play(const Color &cpu, const int &depth)
 		// if cpu is playing, take turn
 		if (cpu == color)
 		{
-			Node node = min_max_call(*this, color, depth);
+			// a ponder hit already searched this position, otherwise deepen
+			// one ply at a time so earlier results order the moves. the reply
+			// is taken from the same finished search as the move
+			Node node, reply;
+			bool hasReply = false;
+			if (ponderHit && ponderedDepth > 0)
+			{
+				node = pondered;
+				reply = ponderedReply;
+				hasReply = ponderedHasReply;
+			}
+			else
+			{
+				int64_t start = now_ms();
+				info.reset();
+				for (int d = 1; d <= depth; ++d)
+					node = min_max_call(*this, color, d, &info);
+				searchMs = now_ms() - start;
+				hasReply = info.pvLength_[0] > 1;
+				if (hasReply)
+					reply = info.pv_[0][1];
+			}
+			ponderHit = false;
 
 			cout << "CPU played: " 
 				<< char(97 + node.current_.second) << node.current_.first + 1  << " -> " 
 				<< char(97 + node.desired_.second) << node.desired_.first + 1 << endl << endl;
 
 			// make move and end turn
-			make_move(node.current_, node.desired_);
+			make_move(node.current_, node.desired_, node.promotion_);
+
+			// search the expected reply while the player thinks
+			Board expected(*this);
+			expected.update_move_set();
+			if (ponder && hasReply && expected.legal_move(reply.current_, reply.desired_))
+			{
+				predicted = reply;
+				expected.make_move(predicted.current_, predicted.desired_, predicted.promotion_);
+				expected.update_move_set();
+
+				ponderInfo.reset();
+				ponderedDepth = 0;
+				ponderedHasReply = false;
+				ponderThread = std::thread([&ponderInfo, &pondered, &ponderedReply, &ponderedHasReply, &ponderedDepth,
+											expected, depth]() mutable {
+					for (int d = 1; d <= depth; ++d)
+					{
+						Node node = expected.min_max_call(expected, expected.to_move(), d, &ponderInfo);
+						if (ponderInfo.stop_)
+							break;
+
+						// an interrupted deeper search may change the line, so it's copied now
+						pondered = node;
+						ponderedHasReply = ponderInfo.pvLength_[0] > 1;
+						if (ponderedHasReply)
+							ponderedReply = ponderInfo.pv_[0][1];
+						ponderedDepth = d;
+					}
+				});
+			}
 		}
 		// human turn
 		else
@@ -836,12 +1497,30 @@ void Board::play(const Color &cpu, const int &depth)
 				cout << "Selection: ";
 				cin >> moveNum;
 
-				if (moveNum != piecesWithMoves[pieceNum].move_list().size()) 
+				if (size_t(moveNum) != piecesWithMoves[pieceNum].move_list().size()) 
 					selectionMade = true;
 			}
 
+			Position current = piecesWithMoves[pieceNum].get_position(),
+				desired = piecesWithMoves[pieceNum].move_list()[moveNum];
+
+			// on a ponder hit the ponder search gets as long as the last cpu
+			// search took and its result is played, otherwise it is stopped
+			if (ponderThread.joinable())
+			{
+				ponderHit = predicted.same_move(Node(0, current, desired)); // players always promote to a queen
+				if (ponderHit)
+				{
+					cout << "Ponder hit" << endl;
+					ponderInfo.deadline_ = now_ms() + max<int64_t>(searchMs, 1);
+				}
+				else
+					ponderInfo.stop_ = true;
+				ponderThread.join();
+			}
+
 			// make move and end turn
-			make_move(piecesWithMoves[pieceNum].get_position(), piecesWithMoves[pieceNum].move_list()[moveNum]);
+			make_move(current, desired);
 
 		} // end of humans turn
 
@@ -856,11 +1535,8 @@ void Board::play(const Color &cpu, const int &depth)
 		// check outcome of turn
 		outcome = end_game(color);
 
-		// next turn
-		++turn_;
-
-		// flip between white and black turns
-		color = Color(turn_ % 2);
+		// flip between white and black turns, turn number was advanced by make_move
+		color = to_move();
 
 		// save game
 		cout << endl << "Save game? (y/n): ";
@@ -869,10 +1545,17 @@ void Board::play(const Color &cpu, const int &depth)
 		if (ans == 'y') save_game();
 	}
 
+	// game ended while pondering
+	if (ponderThread.joinable())
+	{
+		ponderInfo.stop_ = true;
+		ponderThread.join();
+	}
+
 	if (outcome == 1 && color == Color::Black)
 		cout << "WHITE HAS WON!" << endl;
 	else if (outcome == 1 && color == Color::White)
 		cout << "BLACK HAS WON!" << endl;
 	else if (outcome == 2)
-		cout << "STALEMATE!" << endl;
+		cout << "DRAW!" << endl;
 }
\ No newline at end of file
@@ -9,10 +9,15 @@
 // DATE:        7/1/2020
 
 #include "piece.h"
+#include "attacks.h"
+#include "search.h"
+#include "transposition.h"
 #include <string>
 #include <fstream>
 #include <future>
 #include <thread>
+#include <cstring>
+#include <sstream>
 
 using std::string;
 using std::ofstream; using std::ifstream;
@@ -20,20 +25,30 @@ using std::future;
 
 ////////////////////////////////////////////////////////////////////////////////
 //
-// NODE
-// note: return type for min_max function
-struct Node {
-	Node(const double &value, const Position &cur, const Position &des) :
-		value_(value), current_(cur), desired_(des) {}
-
-	// for algorithms
-	bool operator<(const Node &rhs) const { return value_ < rhs.value_; }
-
-	double value_;
-	Position current_;
-	Position desired_;
+// PACKED POSITION
+// note: fixed size encoding of a full position. pieces_ holds the piece code
+//       of each occupied square in board index order, two per byte
+struct PackedPosition {
+	uint64_t occupied_;      // bit set for each square with a piece
+	uint8_t  pieces_[16];
+	uint8_t  flags_;         // bit 0 = white to move, bits 1-4 = castling rights, see CASTLE constants
+	uint8_t  enPassant_;     // column of en passant capture, NO_EN_PASSANT if none
+	uint16_t halfmoveClock_;
+	uint16_t fullmove_;
+	uint8_t  padding_[2];
+
+	bool operator==(const PackedPosition &rhs) const { return memcmp(this, &rhs, sizeof(PackedPosition)) == 0; }
 };
 
+static_assert(sizeof(PackedPosition) == 32, "packed positions are 32 bytes");
+
+// castling right bits
+const int CASTLE_WHITE_KING = 1, CASTLE_WHITE_QUEEN = 2, CASTLE_BLACK_KING = 4, CASTLE_BLACK_QUEEN = 8;
+const uint8_t NO_EN_PASSANT = 0xFF;
+
+// standard starting position
+const string START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // BOARD
@@ -41,22 +56,45 @@ class Board {
 public:
 	// constructors
 	Board();
-	Board(const Board &board);
+	Board(const Board &board) = default; // deep copy, pieces_ and history_ are copied
+	Board &operator=(const Board &board) = default;
 
 	// methods
 	const PieceList &get_pieces() const { return pieces_; }
 	void print() const;
 	void save_game(const string &game = "game.txt") const;
 	void load_game(const string &game = "game.txt");
-	bool player_in_check(const Color &color) const;
-	void make_move(const Position &currentPos, const Position &desiredPos);
-	int end_game(const Color &color) const;
+	bool player_in_check(const Color &color) const { return checkers(color) != 0; }
+	bool is_square_attacked(const int &square, const Color &byColor) const { return attackers(square, byColor) != 0; }
+	Bitboard attackers(const int &square, const Color &byColor) const; // pieces of byColor attacking square
+	Bitboard checkers(const Color &color) const; // pieces giving check to colors king, cached until the board changes
+	Bitboard piece_map(const Color &color, const char &rep) const; // squares holding rep pieces of color
+	bool leaves_king_attacked(const Position &currentPos, const Position &desiredPos) const; // move would leave its sides king attacked, castling also checks the squares the king crosses
+	void make_move(const Position &currentPos, const Position &desiredPos, const char &promotion = QUEEN_REP);
+	bool legal_move(const Position &currentPos, const Position &desiredPos) const; // side to move has a piece at currentPos that can move to desiredPos
+	int end_game(const Color &color) const; // 0 = not over, 1 = color is checkmated, 2 = draw
 	void update_move_set();
 	double favor() const; // positive = favor of white, negative = favor of black, 0 = neutral
-	Node min_max_call(const Board &board, const Color &maximizingColor, const int &depth);
-	double min_max(const Board &board, int depth, double alpha, double beta, Color maximizingColor);
-	void play(const Color &cpu = Color::Empty, const int &depth = 3);
+	Node min_max_call(const Board &board, const Color &maximizingColor, const int &depth, SearchInfo *info = nullptr);
+	double min_max(const Board &board, int depth, double alpha, double beta, Color maximizingColor, SearchInfo *info = nullptr);
+	void play(const Color &cpu = Color::Empty, const int &depth = 3, const bool &ponder = false); // ponder searches the expected reply during the players turn
 	Position get_king_pos(const Color &c) const { return kingPos_[int(c)]; }
+	Bitboard occupancy(const Color &color = Color::Empty) const; // squares holding pieces of color, Empty for both colors
+	Color to_move() const { return Color(turn_ % 2); }
+	int castling_rights() const; // CASTLE bits of castles still possible
+	int en_passant_col() const; // column a pawn can be captured en passant on, -1 if none
+	bool en_passant_legal(const int &col) const; // a pawn of the side to move can take the pawn that jumped on col
+	bool load_fen(const string &fen); // returns false and leaves board unchanged if fen isn't valid
+	string to_fen() const;
+	PackedPosition pack() const;
+	bool unpack(const PackedPosition &packed); // returns false and leaves board unchanged if packed isn't valid
+	uint64_t hash() const { return key_; } // zobrist hash of pieces, side to move, castling rights and en passant captures that are legal
+	int halfmove_clock() const { return halfmoveClock_; }
+	int repetitions() const; // times the current position was seen before, only back to the last irreversible move
+	bool is_draw() const; // fifty move rule or threefold repetition
+	bool insufficient_material() const; // neither side has enough pieces left to checkmate
+	int material(const Color &color, const char &rep) const; // number of rep pieces color has
+	int piece_count() const { return pieceCount_; } // pieces on board including kings
 
 	// friends
 	friend Piece;
@@ -65,10 +103,37 @@ public:
 								   vector<Position> &moves);
 
 protected:
+	// helpers
+	bool set_position(const uint8_t codes[SIZE][SIZE], const Color &color, const int &castling,
+					  const int &enPassantCol, const int &halfmove, const int &fullmove);
+	Bitboard attackers(const int &square, const Color &byColor, const Bitboard &occupied,
+					   const Bitboard &captured) const; // attackers on a board with occupied squares and captured pieces removed
+	void build_maps() const;
+	void invalidate_maps() { mapsValid_ = false; checkersValid_[0] = checkersValid_[1] = false; }
+	void reset_key(); // hashes the whole position into key_, make_move keeps it up to date after
+
 	PieceList pieces_; // list of pieces on board, position not listed then its empty
 	Position kingPos_[2]; // king positions for quick access
 	double totalGridPoints_; // for reuse in favor function
-	int turn_; // turn number
+	int turn_; // turn number, odd when white is to move
+	int halfmoveClock_; // moves since last capture or pawn move
+	vector<uint64_t> history_; // hashes of earlier positions since the last capture or pawn move
+	uint64_t key_; // hash of the position
+	int keyedEnPassant_; // column whose en passant key is in key_, -1 if none
+
+	// kept by update_move_set so end_game doesn't have to look at every piece
+	int material_[2][8]; // pieces of each color by piece code, see piece_code
+	int bishopShades_[2]; // bishops of either color on dark (0) and light (1) squares
+	int movable_[2]; // pieces of each color with at least one legal move
+	int pieceCount_;
+
+	// attack maps built from pieces_ the first time they are needed after the
+	// board changes, a board shouldn't be shared between threads while in use
+	mutable bool     mapsValid_;
+	mutable Bitboard pieceMaps_[2][8]; // squares of each color by piece code
+	mutable Bitboard colorMaps_[2];
+	mutable Bitboard checkers_[2];
+	mutable bool     checkersValid_[2];
 };
 
 #endif // BOARD_H
\ No newline at end of file
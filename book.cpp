@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        book.cpp
+// DESCRIPTION: contains opening book implementation
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "book.h"
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const char BOOK_MAGIC[BOOK_HEADER_SIZE] = { 'C', 'H', 'B', 'K', 0, 0, 0, 1 };
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// orders entries by position then move
+bool book_entry_less(const BookEntry &a, const BookEntry &b)
+{
+	if (a.key_ != b.key_)
+		return a.key_ < b.key_;
+	return memcmp(a.current_, b.current_, 4) < 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// OPENING BOOK functions
+////////////////////////////////////////
+// maps book file, the header is checked and the rest must be whole entries
+bool OpeningBook::open(const string &fileName)
+{
+	close();
+	if (fileName.empty())
+		return false;
+
+	file_ = MappedFile(fileName);
+	if (!file_.is_open() || file_.size() < BOOK_HEADER_SIZE ||
+		(file_.size() - BOOK_HEADER_SIZE) % sizeof(BookEntry) != 0 ||
+		memcmp(file_.data(), BOOK_MAGIC, BOOK_HEADER_SIZE) != 0)
+	{
+		close();
+		return false;
+	}
+
+	entries_ = reinterpret_cast<const BookEntry *>(file_.data() + BOOK_HEADER_SIZE);
+	size_ = (file_.size() - BOOK_HEADER_SIZE) / sizeof(BookEntry);
+	return size_ > 0;
+}
+
+////////////////////////////////////////
+// finds entries of the position by binary search, moves that aren't legal
+// are dropped in case two positions share a hash
+vector<BookEntry> OpeningBook::moves(const Board &board) const
+{
+	vector<BookEntry> found;
+	if (!is_open())
+		return found;
+
+	uint64_t key = board.hash();
+	const BookEntry *first = std::lower_bound(entries_, entries_ + size_, key,
+											  [](const BookEntry &entry, const uint64_t &k) { return entry.key_ < k; });
+	for (const BookEntry *entry = first; entry != entries_ + size_ && entry->key_ == key; ++entry)
+		if (board.legal_move(entry->current(), entry->desired()))
+			found.push_back(*entry);
+
+	return found;
+}
+
+////////////////////////////////////////
+// picks a book move with probability proportional to its weight
+bool OpeningBook::pick(const Board &board, Node &move, std::mt19937 &generator) const
+{
+	vector<BookEntry> found = moves(board);
+	if (found.empty())
+		return false;
+
+	vector<double> weights;
+	for (const BookEntry &entry : found)
+		weights.push_back(entry.weight_);
+
+	std::discrete_distribution<size_t> distribution(weights.begin(), weights.end());
+	const BookEntry &chosen = found[distribution(generator)];
+	move = Node(0.0, chosen.current(), chosen.desired());
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// BOOK BUILDER functions
+////////////////////////////////////////
+// adds a move played in the position on board
+void BookBuilder::add(const Board &board, const Position &current, const Position &desired, const uint32_t &weight)
+{
+	BookEntry entry = { board.hash(),
+						{ int8_t(current.first), int8_t(current.second) },
+						{ int8_t(desired.first), int8_t(desired.second) },
+						weight };
+	entries_.push_back(entry);
+}
+
+////////////////////////////////////////
+// sorts and merges entries, then writes those with at least minWeight
+size_t BookBuilder::write(const string &fileName, const uint32_t &minWeight)
+{
+	std::sort(entries_.begin(), entries_.end(), book_entry_less);
+
+	// same move in the same position is one entry
+	vector<BookEntry> merged;
+	for (const BookEntry &entry : entries_)
+		if (!merged.empty() && merged.back().key_ == entry.key_ && merged.back().same_move(entry))
+			merged.back().weight_ += entry.weight_;
+		else
+			merged.push_back(entry);
+
+	ofstream out(fileName, ofstream::binary);
+	out.write(BOOK_MAGIC, BOOK_HEADER_SIZE);
+
+	size_t written = 0;
+	for (const BookEntry &entry : merged)
+		if (entry.weight_ >= max(minWeight, uint32_t(1)))
+		{
+			out.write(reinterpret_cast<const char *>(&entry), sizeof(BookEntry));
+			++written;
+		}
+
+	return out ? written : 0;
+}
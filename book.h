@@ -0,0 +1,82 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        book.h
+// DESCRIPTION: contains opening book built from played games and read from a
+//              memory mapped file of moves sorted by position hash
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "board.h"
+#include "mapped_file.h"
+#include <random>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const int BOOK_MAX_PLIES = 24; // moves this deep into a game are added to a book
+const size_t BOOK_HEADER_SIZE = 8; // magic and format version
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// BOOK ENTRY
+// note: move is stored in board encoding, special moves have negative rows.
+//       weight_ counts games the move was played in, wins count twice and
+//       losses not at all
+struct BookEntry {
+	uint64_t key_;
+	int8_t   current_[2];
+	int8_t   desired_[2];
+	uint32_t weight_;
+
+	// methods
+	Position current () const { return Position(current_[0], current_[1]); }
+	Position desired () const { return Position(desired_[0], desired_[1]); }
+	bool same_move   (const BookEntry &rhs) const { return memcmp(current_, rhs.current_, 4) == 0; }
+};
+
+static_assert(sizeof(BookEntry) == 16, "book entries are 16 bytes");
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// OPENING BOOK
+// note: entries are looked up by binary search over the mapped file so a book
+//       is never read into memory. read only, safe to share between threads
+class OpeningBook {
+public:
+	// constructor
+	OpeningBook(const string &fileName = "") { open(fileName); }
+
+	// methods
+	bool open             (const string &fileName); // returns false if file isn't a book, the book is empty then
+	void close            () { file_.close(); entries_ = nullptr; size_ = 0; }
+	bool is_open          () const { return size_ > 0; }
+	size_t size           () const { return size_; }
+	vector<BookEntry> moves (const Board &board) const; // legal book moves of the position
+	bool pick             (const Board &board, Node &move, std::mt19937 &generator) const; // weighted random book move, false if none
+
+private:
+	MappedFile       file_;
+	const BookEntry *entries_;
+	size_t           size_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// BOOK BUILDER
+// note: collects moves of many games in memory, write sorts them and merges
+//       moves played in the same position
+class BookBuilder {
+public:
+	// methods
+	void add      (const Board &board, const Position &current, const Position &desired, const uint32_t &weight);
+	size_t write  (const string &fileName, const uint32_t &minWeight = 1); // returns entries written
+	size_t size   () const { return entries_.size(); }
+
+private:
+	vector<BookEntry> entries_;
+};
+
+#endif // BOOK_H
@@ -0,0 +1,99 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        bounded_queue.h
+// DESCRIPTION: contains a fixed capacity blocking queue for passing work between threads
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+using std::deque;
+using std::mutex;
+using std::unique_lock;
+using std::condition_variable;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// BOUNDED QUEUE
+// note: push blocks while the queue is full and pop blocks while it is empty,
+//       once closed pop drains what is left then returns false
+template <class T>
+class BoundedQueue {
+public:
+	// constructor
+	BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1), closed_(false) {}
+
+	// methods
+	bool push  (T item); // returns false if the queue was closed
+	bool pop   (T &item); // returns false once closed and empty
+	void close ();
+
+private:
+	deque<T>           items_;
+	size_t             capacity_;
+	bool               closed_;
+	mutex              mutex_;
+	condition_variable notFull_;
+	condition_variable notEmpty_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// BOUNDED QUEUE functions
+////////////////////////////////////////
+// adds an item, waits for space if the queue is full
+template <class T>
+bool BoundedQueue<T>::push(T item)
+{
+	unique_lock<mutex> lock(mutex_);
+	notFull_.wait(lock, [&] { return items_.size() < capacity_ || closed_; });
+
+	if (closed_)
+		return false;
+
+	items_.push_back(std::move(item));
+	lock.unlock();
+	notEmpty_.notify_one();
+
+	return true;
+}
+
+////////////////////////////////////////
+// removes an item, waits for one if the queue is empty
+template <class T>
+bool BoundedQueue<T>::pop(T &item)
+{
+	unique_lock<mutex> lock(mutex_);
+	notEmpty_.wait(lock, [&] { return !items_.empty() || closed_; });
+
+	if (items_.empty())
+		return false;
+
+	item = std::move(items_.front());
+	items_.pop_front();
+	lock.unlock();
+	notFull_.notify_one();
+
+	return true;
+}
+
+////////////////////////////////////////
+// no more items will be pushed, wakes all waiting threads
+template <class T>
+void BoundedQueue<T>::close()
+{
+	{
+		unique_lock<mutex> lock(mutex_);
+		closed_ = true;
+	}
+
+	notFull_.notify_all();
+	notEmpty_.notify_all();
+}
+
+#endif // BOUNDED_QUEUE_H
@@ -0,0 +1,195 @@
+#ifndef CO_SEARCH_H
+#define CO_SEARCH_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        co_search.h
+// DESCRIPTION: contains coroutine task and evaluation scheduler that let one
+//              thread run many search paths, each suspended while its network
+//              evaluation waits to be batched. needs c++20 coroutines, the
+//              file is empty otherwise
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "evaluator.h"
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <exception>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SEARCH TASK
+// note: lazily started coroutine returning T. co_await on a task runs it and
+//       resumes the awaiting coroutine once it returns, so recursive searches
+//       are written like the recursive functions they copy
+template <class T>
+class SearchTask {
+public:
+	struct promise_type;
+	typedef std::coroutine_handle<promise_type> Handle;
+
+	// resumes whoever awaited the task once it finishes
+	struct FinalAwaiter {
+		bool await_ready () noexcept { return false; }
+		std::coroutine_handle<> await_suspend (Handle handle) noexcept {
+			std::coroutine_handle<> continuation = handle.promise().continuation_;
+			return continuation ? continuation : std::noop_coroutine();
+		}
+		void await_resume () noexcept {}
+	};
+
+	struct promise_type {
+		T                       value_{};
+		std::coroutine_handle<> continuation_; // null for tasks the scheduler started
+
+		SearchTask get_return_object () { return SearchTask(Handle::from_promise(*this)); }
+		std::suspend_always initial_suspend () noexcept { return {}; }
+		FinalAwaiter final_suspend () noexcept { return {}; }
+		void return_value (T value) { value_ = std::move(value); }
+		void unhandled_exception () { std::terminate(); }
+	};
+
+	// constructors
+	SearchTask(SearchTask &&rhs) noexcept : handle_(rhs.handle_) { rhs.handle_ = nullptr; }
+	SearchTask(const SearchTask &) = delete;
+	SearchTask &operator=(const SearchTask &) = delete;
+	~SearchTask() {
+		if (handle_)
+			handle_.destroy();
+	}
+
+	// methods
+	void start   () { handle_.resume(); } // runs until the first evaluation
+	bool done    () const { return handle_.done(); }
+	T &result    () { return handle_.promise().value_; }
+
+	// awaiting a task starts it right away on this thread
+	bool await_ready () const { return false; }
+	std::coroutine_handle<> await_suspend (std::coroutine_handle<> awaiting) {
+		handle_.promise().continuation_ = awaiting;
+		return handle_;
+	}
+	T await_resume () { return std::move(handle_.promise().value_); }
+
+private:
+	explicit SearchTask(Handle handle) : handle_(handle) {}
+
+	Handle handle_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// EVAL SCHEDULER
+// note: single threaded. tasks co_await evaluate and are suspended until
+//       every running task is waiting, then all waiting inputs of a network
+//       go through one batched forward pass and the tasks are resumed in the
+//       order they suspended. stats use the evaluator's fields, queue
+//       latency is the wait from suspending to the batch starting
+class EvalScheduler {
+public:
+	// constructor, 0 maxBatch sends every waiting input at once
+	EvalScheduler(const size_t &maxBatch = 0) : maxBatch_(maxBatch) {}
+
+	// waits in a task for a network evaluation
+	struct EvalAwaiter {
+		EvalScheduler          *scheduler_;
+		const SharedNetwork    *network_;
+		SparseInput             input_;
+		ValD                    output_;
+		int64_t                 suspended_;
+		std::coroutine_handle<> handle_;
+
+		bool await_ready () const { return false; }
+		void await_suspend (std::coroutine_handle<> handle) {
+			suspended_ = now_us();
+			handle_ = handle;
+			scheduler_->waiting_.push_back(this);
+		}
+		ValD await_resume () { return std::move(output_); }
+	};
+
+	// methods
+	EvalAwaiter evaluate (const SharedNetwork &network, SparseInput input) { return EvalAwaiter{ this, &network, std::move(input), ValD(), 0, nullptr }; }
+	template <class T>
+	void run             (vector<SearchTask<T>> &tasks); // runs every task to completion
+	const EvaluatorStats &stats () const { return stats_; }
+
+private:
+	// helpers
+	void flush (const vector<EvalAwaiter *> &waiting); // evaluates every waiting input
+
+	size_t                maxBatch_;
+	vector<EvalAwaiter *> waiting_; // in the order their tasks suspended
+	NetworkWorkspace      workspace_;
+	EvaluatorStats        stats_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// EVAL SCHEDULER functions
+////////////////////////////////////////
+// starts every task then keeps batching their evaluations until all are done
+template <class T>
+void EvalScheduler::run(vector<SearchTask<T>> &tasks)
+{
+	for (SearchTask<T> &task : tasks)
+		task.start();
+
+	while (!waiting_.empty())
+	{
+		// resumed tasks queue their next evaluation for the following batch
+		vector<EvalAwaiter *> ready;
+		ready.swap(waiting_);
+		flush(ready);
+		for (EvalAwaiter *awaiter : ready)
+			awaiter->handle_.resume();
+	}
+}
+
+////////////////////////////////////////
+// one forward pass per network of every waiting input, split in maxBatch_
+// sized batches when set
+inline void EvalScheduler::flush(const vector<EvalAwaiter *> &waiting)
+{
+	vector<bool> done(waiting.size(), false);
+	for (size_t first = 0; first < waiting.size(); ++first)
+	{
+		if (done[first])
+			continue;
+
+		// inputs for the same network as the first not yet evaluated
+		const SharedNetwork *network = waiting[first]->network_;
+		vector<EvalAwaiter *> batch;
+		for (size_t i = first; i < waiting.size() && (maxBatch_ == 0 || batch.size() < maxBatch_); ++i)
+			if (!done[i] && waiting[i]->network_ == network)
+			{
+				batch.push_back(waiting[i]);
+				done[i] = true;
+			}
+
+		int64_t start = now_us();
+		vector<SparseInput> inputs;
+		inputs.reserve(batch.size());
+		for (EvalAwaiter *awaiter : batch)
+			inputs.push_back(std::move(awaiter->input_));
+
+		vector<ValD> outputs = network->get()->forwardPropagation(inputs, workspace_);
+		for (size_t i = 0; i < batch.size(); ++i)
+		{
+			batch[i]->output_ = std::move(outputs[i]);
+			stats_.queueUs_ += start - batch[i]->suspended_;
+			stats_.maxQueueUs_ = std::max(stats_.maxQueueUs_, start - batch[i]->suspended_);
+		}
+
+		++stats_.batches_;
+		stats_.positions_ += batch.size();
+		stats_.fullBatches_ += maxBatch_ != 0 && batch.size() == maxBatch_;
+		stats_.maxBatch_ = std::max(stats_.maxBatch_, batch.size());
+		stats_.inferenceUs_ += now_us() - start;
+	}
+}
+
+#endif // __cpp_impl_coroutine
+
+#endif // CO_SEARCH_H
@@ -0,0 +1,303 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        evaluator.h
+// DESCRIPTION: contains network evaluator that collects positions submitted by
+//              many search threads into batches run on one inference thread
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "network.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const size_t EVALUATOR_MAX_BATCH = 64;
+const int64_t EVALUATOR_TIMEOUT_US = 200; // longest a batch waits to fill after its first position
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// microseconds on a steady clock, for queue latency
+inline int64_t now_us()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MPSC QUEUE
+// note: lock free queue of linked nodes, any thread may push but only one
+//       thread may pop. push links a node with a single exchange so
+//       producers never wait on each other. the first node is a stub that
+//       pop replaces with the node it took the item from
+template <class T>
+class MpscQueue {
+public:
+	// constructor
+	MpscQueue() : head_(new QueueNode), tail_(head_.load()) {}
+	~MpscQueue() {
+		T item;
+		while (pop(item)) {}
+		delete tail_;
+	}
+	MpscQueue(const MpscQueue &) = delete;
+	MpscQueue &operator=(const MpscQueue &) = delete;
+
+	// methods
+	void push  (T item); // safe from any thread
+	bool pop   (T &item); // consumer only, false if empty
+	bool empty () const { return tail_->next_.load(std::memory_order_acquire) == nullptr; } // consumer only
+
+private:
+	struct QueueNode {
+		std::atomic<QueueNode *> next_{ nullptr };
+		T item_;
+	};
+
+	std::atomic<QueueNode *> head_; // newest node, producers exchange it
+	QueueNode               *tail_; // stub before the oldest item, owned by the consumer
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MPSC QUEUE functions
+////////////////////////////////////////
+// adds item at the head, a pop may miss it until the link is stored
+template <class T>
+void MpscQueue<T>::push(T item)
+{
+	QueueNode *node = new QueueNode;
+	node->item_ = std::move(item);
+
+	QueueNode *prev = head_.exchange(node, std::memory_order_acq_rel);
+	prev->next_.store(node, std::memory_order_release);
+}
+
+////////////////////////////////////////
+// takes the oldest item, its node becomes the new stub
+template <class T>
+bool MpscQueue<T>::pop(T &item)
+{
+	QueueNode *next = tail_->next_.load(std::memory_order_acquire);
+	if (!next)
+		return false;
+
+	item = std::move(next->item_);
+	delete tail_;
+	tail_ = next;
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// EVALUATOR STATS
+// note: kept by the inference thread, queue latency is the time from submit
+//       to the start of the forward pass of the position's batch
+struct EvaluatorStats {
+	uint64_t batches_ = 0;
+	uint64_t positions_ = 0;
+	uint64_t fullBatches_ = 0; // batches sent because they reached the max size
+	size_t   maxBatch_ = 0;
+	int64_t  queueUs_ = 0; // summed over every position
+	int64_t  maxQueueUs_ = 0;
+	int64_t  inferenceUs_ = 0; // time spent in forward passes
+
+	// methods
+	double average_batch () const { return batches_ ? double(positions_) / batches_ : 0.0; }
+	double average_queue_us () const { return positions_ ? double(queueUs_) / positions_ : 0.0; }
+
+	// stats as one json object
+	string to_json() const {
+		std::ostringstream out;
+		out << "{\"batches\":" << batches_ << ",\"positions\":" << positions_
+			<< ",\"full_batches\":" << fullBatches_ << ",\"average_batch\":" << average_batch()
+			<< ",\"max_batch\":" << maxBatch_ << ",\"average_queue_us\":" << average_queue_us()
+			<< ",\"max_queue_us\":" << maxQueueUs_ << ",\"inference_us\":" << inferenceUs_ << "}";
+		return out.str();
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// NETWORK EVALUATOR
+// note: search threads submit inputs and wait on the returned future. the
+//       inference thread sends a batch once it has maxBatch positions or
+//       timeoutUs has passed since the batch's first position, so with as
+//       many searching threads as maxBatch batches fill without waiting.
+//       each batch uses the network's weights at the time it is run
+class NetworkEvaluator {
+public:
+	// constructor
+	NetworkEvaluator(shared_ptr<SharedNetwork> network, const size_t &maxBatch = EVALUATOR_MAX_BATCH,
+					 const int64_t &timeoutUs = EVALUATOR_TIMEOUT_US) :
+		network_(std::move(network)), maxBatch_(maxBatch > 0 ? maxBatch : 1), timeoutUs_(timeoutUs),
+		stop_(false), sleeping_(false), thread_(&NetworkEvaluator::run, this) {}
+	~NetworkEvaluator(); // finishes every submitted position before returning
+	NetworkEvaluator(const NetworkEvaluator &) = delete;
+	NetworkEvaluator &operator=(const NetworkEvaluator &) = delete;
+
+	// methods
+	future<ValD> submit   (SparseInput input); // safe from any thread
+	ValD evaluate         (SparseInput input) { return submit(std::move(input)).get(); }
+	EvaluatorStats stats  () const;
+
+private:
+	struct Request {
+		SparseInput        input_;
+		std::promise<ValD> result_;
+		int64_t            submitted_; // microseconds
+	};
+
+	// helpers
+	void run   (); // inference thread
+	void flush (vector<Request *> &batch, const bool &full);
+
+	shared_ptr<SharedNetwork> network_;
+	size_t                    maxBatch_;
+	int64_t                   timeoutUs_;
+	MpscQueue<Request *>      queue_;
+	std::atomic<bool>         stop_;
+	std::atomic<bool>         sleeping_; // inference thread is waiting for work
+	std::mutex                wakeMutex_;
+	std::condition_variable   wake_;
+	mutable std::mutex        statsMutex_;
+	EvaluatorStats            stats_;
+	NetworkWorkspace          workspace_;
+	std::thread               thread_; // last so everything it uses exists first
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// NETWORK EVALUATOR functions
+////////////////////////////////////////
+// stops the inference thread once it has run what was submitted
+NetworkEvaluator::~NetworkEvaluator()
+{
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex_);
+		stop_ = true;
+	}
+	wake_.notify_one();
+	thread_.join();
+}
+
+////////////////////////////////////////
+// queues input for the next batch, the inference thread is only woken if
+// it ran out of work
+future<ValD> NetworkEvaluator::submit(SparseInput input)
+{
+	Request *request = new Request;
+	request->input_ = std::move(input);
+	request->submitted_ = now_us();
+	future<ValD> result = request->result_.get_future();
+
+	// fence pairs with the one in run so either this sees the inference
+	// thread sleeping or it sees the position
+	queue_.push(request);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (sleeping_)
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex_);
+		wake_.notify_one();
+	}
+
+	return result;
+}
+
+////////////////////////////////////////
+// copy of the stats so far
+EvaluatorStats NetworkEvaluator::stats() const
+{
+	std::lock_guard<std::mutex> lock(statsMutex_);
+	return stats_;
+}
+
+////////////////////////////////////////
+// collects batches until stopped, sleeps while nothing is queued
+void NetworkEvaluator::run()
+{
+	vector<Request *> batch;
+	Request *request;
+	while (true)
+	{
+		if (!queue_.pop(request))
+		{
+			// sleeping is set under the mutex submit notifies with so a
+			// position queued after the check below always wakes this thread
+			std::unique_lock<std::mutex> lock(wakeMutex_);
+			sleeping_ = true;
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (queue_.empty() && !stop_)
+				wake_.wait_for(lock, std::chrono::milliseconds(1));
+			sleeping_ = false;
+
+			if (stop_ && queue_.empty())
+				break;
+			continue;
+		}
+
+		// fill the batch until it is full or the first position waited long enough
+		batch.push_back(request);
+		int64_t deadline = now_us() + timeoutUs_;
+		while (batch.size() < maxBatch_)
+			if (queue_.pop(request))
+				batch.push_back(request);
+			else if (stop_ || now_us() >= deadline)
+				break;
+			else
+				std::this_thread::yield();
+
+		flush(batch, batch.size() == maxBatch_);
+	}
+}
+
+////////////////////////////////////////
+// runs one batch and completes its futures
+void NetworkEvaluator::flush(vector<Request *> &batch, const bool &full)
+{
+	int64_t start = now_us();
+
+	vector<SparseInput> inputs;
+	inputs.reserve(batch.size());
+	for (Request *request : batch)
+		inputs.push_back(std::move(request->input_));
+
+	vector<ValD> outputs = network_->get()->forwardPropagation(inputs, workspace_);
+	int64_t end = now_us();
+
+	{
+		std::lock_guard<std::mutex> lock(statsMutex_);
+		++stats_.batches_;
+		stats_.positions_ += batch.size();
+		stats_.fullBatches_ += full;
+		stats_.maxBatch_ = std::max(stats_.maxBatch_, batch.size());
+		stats_.inferenceUs_ += end - start;
+		for (Request *request : batch)
+		{
+			stats_.queueUs_ += start - request->submitted_;
+			stats_.maxQueueUs_ = std::max(stats_.maxQueueUs_, start - request->submitted_);
+		}
+	}
+
+	for (size_t i = 0; i < batch.size(); ++i)
+	{
+		batch[i]->result_.set_value(std::move(outputs[i]));
+		delete batch[i];
+	}
+	batch.clear();
+}
+
+#endif // EVALUATOR_H
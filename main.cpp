@@ -6,12 +6,14 @@
 // DATE:        7/1/2020
 
 #include "agent.h"
-#include <fstream>
-#include <filesystem>
+#include "pgn_pipeline.h"
+#include "uci.h"
+#include "match.h"
+#include "selfplay.h"
+#include "bench.h"
+#include "tablebase_check.h"
 
-namespace fs = std::filesystem;
-
-int main()
+int main(int argc, char *argv[])
 {
 	// set up favor network
 	Network favorNet(vector<pair<size_t, Activation *>>
@@ -25,37 +27,149 @@ int main()
 					 ({ make_pair(384, new Sigmoid),
 					  make_pair(100, new Sigmoid),
 					  make_pair(100, new Sigmoid),
-					  make_pair(SIZE * SIZE, new Sigmoid) }),
+					  make_pair(POLICY_MOVES, new Sigmoid) }),
 					 .0000005,
 					 0.0);
 
+	// mini-batch training, gradients are averaged over each batch
+	favorNet.setBatchSize(32);
+	favorNet.setOptimizer(std::make_shared<SGD<>>(0.9));
+	policyNet.setBatchSize(32);
+	policyNet.setOptimizer(std::make_shared<SGD<>>(0.9));
+
 	Agent agent(favorNet, policyNet, 0.4, "agent2.txt");
-	agent.load();
 
-	// comment this section out when not training
-	// iterate through all files in directory containing games
-	for (const auto &file : fs::directory_iterator("data"))
+	// command line modes
+	string mode = argc > 1 ? argv[1] : "";
+	if (mode == "uci") // engine for guis, agent is loaded if the UseAgent option is set
+	{
+		Uci uci(&agent);
+		uci.loop();
+		return 0;
+	}
+
+	else if (mode == "tablebase" && argc > 3 && string(argv[2]) == "verify") // tablebase verify <syzygy directory> [stride], probes real tables against solved endgames
+	{
+		return run_syzygy_verify(argv[3], argc > 4 ? std::stoi(argv[4]) : CHECK_STRIDE) ? 0 : 1;
+	}
+
+	else if (mode == "tablebase" && argc > 2 && string(argv[2]) == "check") // tablebase check [directory] [stride], writes solved tables and probes them back
+	{
+		string directory = argc > 3 ? argv[3] : (std::filesystem::temp_directory_path() / "syzygy_check").string();
+		return run_tablebase_check(directory, argc > 4 ? std::stoi(argv[4]) : CHECK_STRIDE) ? 0 : 1;
+	}
+
+	else if (mode == "tablebase") // tablebase <syzygy directory> <fen>, probes one position
+	{
+		Tablebases tablebases(argc > 2 ? argv[2] : "");
+		Board board;
+		if (argc < 4 || !board.load_fen(argv[3]))
+		{
+			cout << "Found " << tablebases.tables() << " tablebases, give a fen to probe" << endl;
+			return 1;
+		}
+		board.update_move_set();
+
+		TablebaseResult result;
+		Node move;
+		int plies = 0;
+		if (!tablebases.probe(board, result) || !tablebases.probe_dtz(board, plies) ||
+			!tablebases.probe_root(board, move, result))
+		{
+			cout << "Position isn't in the tablebases" << endl;
+			return 1;
+		}
+
+		cout << "WDL: " << result.wdl_ << "  DTZ: " << plies << "  best move: "
+			<< move_to_lan(board, move.current_, move.desired_, move.promotion_) << endl;
+		return 0;
+	}
+
+	else if (mode == "bench") // bench [board depth] [agent depth] [json file] [baseline json file]
+	{
+		int agentDepth = argc > 3 ? std::stoi(argv[3]) : 0;
+		if (agentDepth > 0)
+			agent.load();
+
+		ofstream json;
+		if (argc > 4)
+			json.open(argv[4]);
+		BenchResult result = run_bench(agent, argc > 2 ? std::stoi(argv[2]) : BENCH_BOARD_DEPTH, agentDepth,
+									   BENCH_AGENT_MOVES, json.is_open() ? &json : nullptr);
+
+		// a different signature means a change altered what the search does
+		if (argc > 5)
+		{
+			uint64_t baseline = read_bench_signature(argv[5]);
+			cout << (baseline == result.signature_ ? "Signature matches baseline" : "Signature differs from baseline")
+				<< endl;
+			return baseline == result.signature_ ? 0 : 1;
+		}
+		return 0;
+	}
+#if defined(__cpp_impl_coroutine)
+	else if (mode == "interleave") // interleave [depth] [moves], checks the coroutine search against score_moves
 	{
-		ifstream in(file.path(), ifstream::in);
-		while (!in.eof())
+		agent.load();
+		return run_interleaved_bench(agent, argc > 2 ? std::stoi(argv[2]) : BENCH_AGENT_DEPTH,
+									 argc > 3 ? std::stoi(argv[3]) : BENCH_AGENT_MOVES) ? 0 : 1;
+	}
+#endif
+	else if (mode == "book") // book [pgn directory] [book file]
+	{
+		build_book(argc > 2 ? argv[2] : "data", argc > 3 ? argv[3] : "book.bin");
+		return 0;
+	}
+
+	agent.load();
+	if (mode == "preprocess") // replay pgn files once into binary shards
+	{
+		preprocess_directory(agent, argc > 2 ? argv[2] : "data", argc > 3 ? argv[3] : "shards");
+		return 0;
+	}
+	else if (mode == "match") // match <first> <second> [games] [openings] [threads] [sprt]
+	{
+		MatchPlayer first, second;
+		if (argc < 4 || !parse_player(argv[2], first) || !parse_player(argv[3], second))
 		{
-			// go through lines until move string begins
-			string wholeLine, line;
-			while (std::getline(in, line) && line[0] != '1')
-				cout << line << endl;
-
-			// move string may be spread over multiple lines
-			wholeLine += line + ' ';
-			while (std::getline(in, line) && line[0] != '[')
-			{
-				cout << line << endl;
-				wholeLine += line + ' ';
-			}
-
-			agent.train_from_move_string(wholeLine);
+			cout << "Players are board:<depth>, agent:<depth>:<moves> or mcts:<playouts>" << endl;
+			return 1;
 		}
-		in.close();
+
+		// agent evaluations of every game thread are batched together
+		int threads = argc > 6 ? std::stoi(argv[6]) : 0;
+		if (first.agent_ || second.agent_)
+			agent.start_batching(threads > 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u));
+
+		run_match(agent, first, second, argc > 5 ? load_openings(argv[5]) : vector<string>(),
+				  argc > 4 ? std::stoi(argv[4]) : 100, "match.txt",
+				  threads, argc > 7 && string(argv[7]) == "sprt");
+		if (first.agent_ || second.agent_)
+			cout << "Evaluator stats: " << agent.batching_stats() << endl;
+		return 0;
 	}
+	else if (mode == "selfplay") // selfplay [games] [shards] [threads] [depth]
+	{
+		SelfPlayOptions options;
+		options.games_ = argc > 2 ? std::stoi(argv[2]) : options.games_;
+		options.threads_ = argc > 4 ? std::stoi(argv[4]) : options.threads_;
+		options.depth_ = argc > 5 ? std::stoi(argv[5]) : options.depth_;
+
+		// evaluations of every game thread are batched together
+		agent.start_batching(options.threads_ > 0 ? options.threads_ : std::max(std::thread::hardware_concurrency(), 1u));
+		self_play(agent, argc > 3 ? argv[3] : "selfplay", options);
+		cout << "Evaluator stats: " << agent.batching_stats() << endl;
+		return 0;
+	}
+	else if (mode == "shards") // train from preprocessed shards
+	{
+		agent.train_from_shards(argc > 2 ? argv[2] : "shards", argc > 3 ? std::stoi(argv[3]) : 1);
+		return 0;
+	}
+
+	// comment this section out when not training
+	// train on all files in directory containing games
+	train_from_directory(agent, "data");
 
 	return 0;
 
@@ -63,15 +177,19 @@ int main()
 	// init game
 	Board board;
 
+	// both sides play book moves while the book has the position
+	OpeningBook book("book.bin");
+	std::random_device seed;
+	std::mt19937 generator(seed());
+
 	// begin game
 	// color of player whos turn it is, begin with white
-	int turn = 1;
-	Color color = Color(turn);
+	Color color = board.to_move();
 
 	// display current board
 	board.print();
 
-	// game loop, game continues until a player has been checkmated or a stalemate occurs
+	// game loop, game continues until a player has been checkmated or a draw occurs
 	int outcome = 0;
 	while (!outcome)
 	{
@@ -85,8 +203,17 @@ int main()
 		else
 			cout << "Blacks Turn!" << endl << endl;
 
-		// take min_max turn
-		if (color == Color::White)
+		// take book move or min_max turn
+		Node bookMove;
+		if (book.pick(board, bookMove, generator))
+		{
+			cout << "Book move: "
+				<< char(97 + bookMove.current_.second) << bookMove.current_.first + 1 << " -> "
+				<< char(97 + bookMove.desired_.second) << bookMove.desired_.first + 1 << endl << endl;
+
+			board.make_move(bookMove.current_, bookMove.desired_, bookMove.promotion_);
+		}
+		else if (color == Color::White)
 		{
 			Node node = board.min_max_call(board, color, 2);
 
@@ -95,7 +222,7 @@ int main()
 				<< char(97 + node.desired_.second) << node.desired_.first + 1 << endl << endl;
 
 			// make move and end turn
-			board.make_move(node.current_, node.desired_);
+			board.make_move(node.current_, node.desired_, node.promotion_);
 		}
 		else // neural net turn
 		{
@@ -106,7 +233,7 @@ int main()
 				<< char(97 + node.desired_.second) << node.desired_.first + 1 << endl << endl;
 
 			// make move and end turn
-			board.make_move(node.current_, node.desired_);
+			board.make_move(node.current_, node.desired_, node.promotion_);
 		}
 
 		// update moves after move played
@@ -115,11 +242,8 @@ int main()
 		// display current board
 		board.print();
 
-		// next turn
-		++turn;
-
-		// flip between white and black turns
-		color = Color(turn % 2);
+		// flip between white and black turns, turn number was advanced by make_move
+		color = board.to_move();
 
 		// check outcome of turn
 		outcome = board.end_game(color);
@@ -132,6 +256,6 @@ int main()
 		cout << "WHITE HAS WON!" << endl;
 	else if (outcome == 1 && color == Color::White)
 		cout << "BLACK HAS WON!" << endl;
-	else if (outcome == 2 || turn >= 50)
-		cout << "STALEMATE!" << endl;
+	else if (outcome == 2)
+		cout << "DRAW!" << endl;
 }
\ No newline at end of file
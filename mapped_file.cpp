@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        mapped_file.cpp
+// DESCRIPTION: contains memory mapped file implementation for windows and posix
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MAPPED FILE functions
+////////////////////////////////////////
+// maps file, is_open is false if the file couldn't be mapped or is empty
+MappedFile::MappedFile(const string &fileName) :
+	data_(nullptr), size_(0), handle_(nullptr)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+							  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+	{
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping)
+		{
+			void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (view)
+			{
+				data_ = static_cast<const char *>(view);
+				size_ = size_t(size.QuadPart);
+				handle_ = mapping;
+			}
+			else
+				CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#else
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		void *view = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (view != MAP_FAILED)
+		{
+			data_ = static_cast<const char *>(view);
+			size_ = size_t(info.st_size);
+		}
+	}
+
+	// mapping stays valid after the descriptor is closed
+	::close(fd);
+#endif
+}
+
+////////////////////////////////////////
+// move constructor, rhs no longer owns the mapping
+MappedFile::MappedFile(MappedFile &&rhs) noexcept :
+	data_(rhs.data_), size_(rhs.size_), handle_(rhs.handle_)
+{
+	rhs.data_ = nullptr;
+	rhs.size_ = 0;
+	rhs.handle_ = nullptr;
+}
+
+////////////////////////////////////////
+// move assignment, releases current mapping first
+MappedFile &MappedFile::operator=(MappedFile &&rhs) noexcept
+{
+	if (this != &rhs)
+	{
+		close();
+
+		data_ = rhs.data_;
+		size_ = rhs.size_;
+		handle_ = rhs.handle_;
+
+		rhs.data_ = nullptr;
+		rhs.size_ = 0;
+		rhs.handle_ = nullptr;
+	}
+
+	return *this;
+}
+
+////////////////////////////////////////
+// releases the mapping
+void MappedFile::close()
+{
+	if (!data_)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(data_);
+	CloseHandle(handle_);
+#else
+	munmap(const_cast<char *>(data_), size_);
+#endif
+
+	data_ = nullptr;
+	size_ = 0;
+	handle_ = nullptr;
+}
@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        mapped_file.h
+// DESCRIPTION: contains read only memory mapped file class
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include <string>
+#include <cstddef>
+
+using std::string;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MAPPED FILE
+// note: maps a whole file read only, the mapping is released on destruction
+class MappedFile {
+public:
+	// constructors
+	MappedFile() : data_(nullptr), size_(0), handle_(nullptr) {}
+	MappedFile(const string &fileName);
+	MappedFile(MappedFile &&rhs) noexcept;
+	MappedFile(const MappedFile &) = delete;
+	~MappedFile() { close(); }
+
+	// methods
+	bool is_open        () const { return data_ != nullptr; }
+	const char *data    () const { return data_; }
+	size_t size         () const { return size_; }
+	void close          ();
+
+	// operators
+	MappedFile &operator=(MappedFile &&rhs) noexcept;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+private:
+	const char *data_;
+	size_t      size_;
+	void       *handle_; // platform mapping handle, unused on posix
+};
+
+#endif // MAPPED_FILE_H
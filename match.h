@@ -0,0 +1,341 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        match.h
+// DESCRIPTION: contains match runner that plays many games between two engine
+//              configurations across threads and reports elo and sprt statistics
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "agent.h"
+#include "mcts.h"
+#include "san.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <iomanip>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const int MATCH_MAX_PLIES = 400; // games this long are adjudicated as draws
+const size_t MATCH_TABLE_MB = 4; // table size of each player in each thread
+const double SPRT_ALPHA = 0.05, SPRT_BETA = 0.05; // sprt error rates
+
+// openings played when no openings file is given, a few moves into common
+// lines so games between the same players aren't all the same game
+const vector<string> MATCH_OPENINGS = {
+	"r1bqkbnr/1ppp1ppp/p1n5/1B2p3/4P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 0 4", // e4 e5 Nf3 Nc6 Bb5 a6
+	"r1bqk1nr/pppp1ppp/2n5/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4", // e4 e5 Nf3 Nc6 Bc4 Bc5
+	"rnbqkb1r/ppp2ppp/3p1n2/4N3/4P3/8/PPPP1PPP/RNBQKB1R w KQkq - 0 4", // e4 e5 Nf3 Nf6 Nxe5 d6
+	"rnbqkbnr/pppp1p1p/8/6p1/4Pp2/5N2/PPPP2PP/RNBQKB1R w KQkq g6 0 4", // e4 e5 f4 exf4 Nf3 g5
+	"rnbqkbnr/pp2pppp/3p4/8/3pP3/5N2/PPP2PPP/RNBQKB1R w KQkq - 0 4", // e4 c5 Nf3 d6 d4 cxd4
+	"r1bqkbnr/pp1ppppp/2n5/8/3pP3/5N2/PPP2PPP/RNBQKB1R w KQkq - 0 4", // e4 c5 Nf3 Nc6 d4 cxd4
+	"rnbqkb1r/pp1ppppp/8/2pnP3/8/2P5/PP1P1PPP/RNBQKBNR w KQkq - 1 4", // e4 c5 c3 Nf6 e5 Nd5
+	"rnbqk1nr/ppp2ppp/4p3/3p4/1b1PP3/2N5/PPP2PPP/R1BQKBNR w KQkq - 2 4", // e4 e6 d4 d5 Nc3 Bb4
+	"rn1qkbnr/pp2pppp/2p5/3pPb2/3P4/8/PPP2PPP/RNBQKBNR w KQkq - 1 4", // e4 c6 d4 d5 e5 Bf5
+	"rnb1kbnr/ppp1pppp/8/q7/8/2N5/PPPP1PPP/R1BQKBNR w KQkq - 2 4", // e4 d5 exd5 Qxd5 Nc3 Qa5
+	"rnbqkb1r/ppp1pppp/3p4/3nP3/3P4/8/PPP2PPP/RNBQKBNR w KQkq - 0 4", // e4 Nf6 e5 Nd5 d4 d6
+	"rnbqkb1r/ppp1pp1p/3p1np1/8/3PP3/2N5/PPP2PPP/R1BQKBNR w KQkq - 0 4", // e4 d6 d4 Nf6 Nc3 g6
+	"rnbqkb1r/ppp2ppp/4pn2/3p4/2PP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 2 4", // d4 d5 c4 e6 Nc3 Nf6
+	"rnbqkb1r/ppp1pppp/5n2/8/2pP4/5N2/PP2PPPP/RNBQKB1R w KQkq - 2 4", // d4 d5 c4 dxc4 Nf3 Nf6
+	"rnbqkb1r/pp2pppp/2p2n2/3p4/2PP4/5N2/PP2PPPP/RNBQKB1R w KQkq - 2 4", // d4 d5 c4 c6 Nf3 Nf6
+	"rnbqk2r/ppppppbp/5np1/8/2PP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 2 4", // d4 Nf6 c4 g6 Nc3 Bg7
+	"rnbqk2r/pppp1ppp/4pn2/8/1bPP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 2 4", // d4 Nf6 c4 e6 Nc3 Bb4
+	"rnbqkb1r/p1pp1ppp/1p2pn2/8/2PP4/5N2/PP2PPPP/RNBQKB1R w KQkq - 0 4", // d4 Nf6 c4 e6 Nf3 b6
+	"rnbqkb1r/pp1p1ppp/4pn2/2pP4/2P5/8/PP2PPPP/RNBQKBNR w KQkq - 0 4", // d4 Nf6 c4 c5 d5 e6
+	"rnbqkb1r/ppppp2p/5np1/5p2/3P4/6P1/PPP1PPBP/RNBQK1NR w KQkq - 0 4", // d4 f5 g3 Nf6 Bg2 g6
+	"rnbqkb1r/ppp2ppp/5n2/3pp3/2P5/2N3P1/PP1PPP1P/R1BQKBNR w KQkq d6 0 4", // c4 e5 Nc3 Nf6 g3 d5
+	"r1bqkbnr/pp1ppp1p/2n3p1/2p5/2P5/2N3P1/PP1PPP1P/R1BQKBNR w KQkq - 0 4", // c4 c5 Nc3 Nc6 g3 g6
+	"rnbqkb1r/pp2pppp/2p2n2/3p4/8/5NP1/PPPPPPBP/RNBQK2R w KQkq - 0 4", // Nf3 d5 g3 Nf6 Bg2 c6
+	"rnbqk1nr/ppp1ppbp/3p2p1/8/3PP3/2N5/PPP2PPP/R1BQKBNR w KQkq - 0 4"  // e4 g6 d4 Bg7 Nc3 d6
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MATCH PLAYER
+// note: one engine configuration, written as board:<depth> for Board::min_max_call,
+//       agent:<depth>:<moves> for Agent::min_max_call or mcts:<playouts> for
+//       MctsSearch, whose playouts are kept in depth_
+struct MatchPlayer {
+	string name_;
+	bool   agent_;
+	int    depth_;
+	int    moves_; // root moves the agents policy net picks
+	bool   mcts_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MATCH STATS
+// note: results from the first players view, search_ holds the search counts
+//       of the first and second player over every game
+struct MatchStats {
+	int wins_ = 0, draws_ = 0, losses_ = 0;
+	SearchStats search_[2];
+
+	// methods
+	int games        () const { return wins_ + draws_ + losses_; }
+	double score     () const { return games() ? (wins_ + 0.5 * draws_) / games() : 0.5; }
+	double elo       () const; // elo difference of first player
+	double elo_error () const; // 95% confidence interval half width
+	double llr       (const double &elo0, const double &elo1) const; // sprt log likelihood ratio
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// GAME RESULT
+struct GameResult {
+	int    game_;
+	string opening_;
+	bool   firstIsWhite_;
+	int    result_; // 1 = white won, -1 = black won, 0 = draw
+	int    plies_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// parses board:<depth>, agent:<depth>:<moves> or mcts:<playouts>, returns
+// false if spec isn't valid
+bool parse_player(const string &spec, MatchPlayer &player)
+{
+	std::istringstream in(spec);
+	string type;
+	std::getline(in, type, ':');
+
+	player = MatchPlayer{ spec, type == "agent" || type == "mcts", 2, 4, type == "mcts" };
+	if (player.mcts_)
+		player.depth_ = MCTS_DEFAULT_PLAYOUTS;
+	if (type != "agent" && type != "board" && type != "mcts")
+		return false;
+
+	string field;
+	if (std::getline(in, field, ':') && !(std::istringstream(field) >> player.depth_))
+		return false;
+	if (std::getline(in, field, ':') && !(std::istringstream(field) >> player.moves_))
+		return false;
+
+	return player.depth_ > 0 && player.moves_ > 0;
+}
+
+////////////////////////////////////////
+// reads one fen per line, blank lines and lines starting with # are skipped
+vector<string> load_openings(const string &fileName)
+{
+	vector<string> openings;
+	ifstream in(fileName);
+	string line;
+	while (std::getline(in, line))
+	{
+		// epd operations follow a semicolon
+		line = line.substr(0, line.find(';'));
+		Board board;
+		if (!line.empty() && line[0] != '#' && board.load_fen(line))
+			openings.push_back(line);
+	}
+
+	return openings;
+}
+
+////////////////////////////////////////
+// plays one game from opening, returns 1 if white won, -1 if black won, 0 for a draw.
+// search counts of each move are added to stats of the player that made it
+int play_match_game(const string &opening, const MatchPlayer *players[2], const Agent &agent,
+					TranspositionTable tables[2], MctsSearch *trees[2], SearchStats *stats[2], int &plies)
+{
+	Board board;
+	board.load_fen(opening);
+
+	// games don't depend on the games played before them
+	tables[0].clear();
+	tables[1].clear();
+	trees[0]->clear();
+	trees[1]->clear();
+
+	for (plies = 0; plies < MATCH_MAX_PLIES; ++plies)
+	{
+		Color color = board.to_move();
+		int outcome = board.end_game(color);
+		if (outcome == 1)
+			return color == Color::White ? -1 : 1;
+		else if (outcome == 2)
+			return 0;
+
+		// deepen one ply at a time so earlier results order the moves
+		const MatchPlayer &player = *players[int(color)];
+		SearchInfo info(&tables[int(color)]);
+		Node node;
+		if (player.mcts_)
+			node = trees[int(color)]->search(board, player.depth_, 1, &info);
+		for (int depth = 1; !player.mcts_ && depth <= player.depth_; ++depth)
+			node = player.agent_ ? agent.min_max_call(board, color, depth, player.moves_, &info)
+								 : board.min_max_call(board, color, depth, &info);
+		*stats[int(color)] += info.stats_;
+
+		board.make_move(node.current_, node.desired_, node.promotion_);
+		board.update_move_set();
+	}
+
+	return 0;
+}
+
+////////////////////////////////////////
+// plays games between first and second, each opening is played twice with
+// colors swapped. games are shared out to threads which all search with the
+// same agent, each with its own tables. results are written
+// to resultsFile in game order so runs are reproducible. MATCH_OPENINGS are
+// played if openings is empty. stops early once sprt accepts either
+// hypothesis if sprt is true
+MatchStats run_match(const Agent &agent, const MatchPlayer &first, const MatchPlayer &second,
+					 vector<string> openings, const int &games, const string &resultsFile = "match.txt",
+					 int threads = 0, const bool &sprt = false, const double &elo0 = 0.0, const double &elo1 = 5.0)
+{
+	if (openings.empty())
+		openings = MATCH_OPENINGS;
+	if (threads <= 0)
+		threads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+
+	double lower = log(SPRT_BETA / (1 - SPRT_ALPHA)), upper = log((1 - SPRT_BETA) / SPRT_ALPHA);
+
+	MatchStats stats;
+	vector<GameResult> results;
+	std::mutex mutex;
+	std::atomic<int> next(0);
+	std::atomic<bool> stop(false);
+
+	auto worker = [&]() {
+		TranspositionTable tables[2] = { TranspositionTable(MATCH_TABLE_MB), TranspositionTable(MATCH_TABLE_MB) };
+		size_t nodes = size_t(max(first.mcts_ ? first.depth_ : 0, second.mcts_ ? second.depth_ : 0)) * MCTS_NODES_PER_PLAYOUT;
+		MctsSearch white(agent, nodes), black(agent, nodes); // trees are only allocated once searched
+		MctsSearch *trees[2];
+		trees[int(Color::White)] = &white;
+		trees[int(Color::Black)] = &black;
+		SearchStats search[2]; // merged into stats once the thread is done
+
+		for (int game = next++; game < games && !stop; game = next++)
+		{
+			// pairs of games share an opening with colors swapped
+			GameResult result = { game, openings[game / 2 % openings.size()], game % 2 == 0, 0, 0 };
+			const MatchPlayer *players[2];
+			players[int(Color::White)] = result.firstIsWhite_ ? &first : &second;
+			players[int(Color::Black)] = result.firstIsWhite_ ? &second : &first;
+			SearchStats *playerSearch[2];
+			playerSearch[int(Color::White)] = &search[result.firstIsWhite_ ? 0 : 1];
+			playerSearch[int(Color::Black)] = &search[result.firstIsWhite_ ? 1 : 0];
+			result.result_ = play_match_game(result.opening_, players, agent, tables, trees, playerSearch, result.plies_);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			int firstResult = result.firstIsWhite_ ? result.result_ : -result.result_;
+			if (firstResult == 1)
+				++stats.wins_;
+			else if (firstResult == -1)
+				++stats.losses_;
+			else
+				++stats.draws_;
+			results.push_back(result);
+
+			cout << "Game " << stats.games() << "/" << games << ": +" << stats.wins_ << " =" << stats.draws_
+				<< " -" << stats.losses_ << endl;
+
+			if (sprt)
+			{
+				double llr = stats.llr(elo0, elo1);
+				if (llr <= lower || llr >= upper)
+					stop = true;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		stats.search_[0] += search[0];
+		stats.search_[1] += search[1];
+	};
+
+	vector<std::thread> pool;
+	for (int i = 0; i < threads; ++i)
+		pool.emplace_back(worker);
+	for (std::thread &t : pool)
+		t.join();
+
+	// results file lists games in the order they were scheduled
+	std::sort(results.begin(), results.end(),
+			  [](const GameResult &a, const GameResult &b) { return a.game_ < b.game_; });
+	ofstream out(resultsFile);
+	for (const GameResult &r : results)
+		out << r.game_ << ' ' << (r.firstIsWhite_ ? first.name_ : second.name_) << ' '
+			<< (r.firstIsWhite_ ? second.name_ : first.name_) << ' '
+			<< (r.result_ == 1 ? "1-0" : r.result_ == -1 ? "0-1" : "1/2-1/2") << ' '
+			<< r.plies_ << ' ' << r.opening_ << endl;
+
+	// summary
+	std::ostringstream summary;
+	summary << std::fixed << std::setprecision(2)
+		<< first.name_ << " vs " << second.name_ << ": +" << stats.wins_ << " =" << stats.draws_
+		<< " -" << stats.losses_ << endl
+		<< "Score: " << stats.score() * 100 << "%" << endl
+		<< "Elo: " << stats.elo() << " +/- " << stats.elo_error() << endl
+		<< first.name_ << " search: " << stats.search_[0].to_json() << endl
+		<< second.name_ << " search: " << stats.search_[1].to_json() << endl;
+	if (sprt)
+	{
+		double llr = stats.llr(elo0, elo1);
+		summary << "SPRT [" << elo0 << ", " << elo1 << "]: LLR " << llr << " (" << lower << ", " << upper << ") "
+			<< (llr >= upper ? "H1 accepted" : llr <= lower ? "H0 accepted" : "inconclusive") << endl;
+	}
+	out << endl << summary.str();
+	cout << endl << summary.str();
+
+	return stats;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MATCH STATS functions
+////////////////////////////////////////
+// elo difference from score, logistic model
+double MatchStats::elo() const
+{
+	double s = std::min(std::max(score(), 1e-6), 1 - 1e-6);
+	return -400 * log10(1 / s - 1);
+}
+
+////////////////////////////////////////
+// 95% confidence interval of elo from the trinomial variance of the score
+double MatchStats::elo_error() const
+{
+	int n = games();
+	if (n == 0)
+		return 0.0;
+
+	double s = score();
+	double variance = (wins_ * pow(1 - s, 2) + draws_ * pow(0.5 - s, 2) + losses_ * pow(s, 2)) / n;
+	double margin = 1.96 * sqrt(variance / n);
+
+	auto to_elo = [](double x) {
+		x = std::min(std::max(x, 1e-6), 1 - 1e-6);
+		return -400 * log10(1 / x - 1);
+	};
+	return (to_elo(s + margin) - to_elo(s - margin)) / 2;
+}
+
+////////////////////////////////////////
+// approximate generalized sprt log likelihood ratio of elo1 over elo0
+double MatchStats::llr(const double &elo0, const double &elo1) const
+{
+	int n = games();
+	if (n == 0)
+		return 0.0;
+
+	double s = score();
+	double variance = (wins_ * pow(1 - s, 2) + draws_ * pow(0.5 - s, 2) + losses_ * pow(s, 2)) / n;
+	if (variance <= 0)
+		return 0.0;
+
+	double s0 = 1 / (1 + pow(10, -elo0 / 400)), s1 = 1 / (1 + pow(10, -elo1 / 400));
+	return n * (s1 - s0) * (2 * s - s0 - s1) / (2 * variance);
+}
+
+#endif // MATCH_H
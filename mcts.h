@@ -0,0 +1,460 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        mcts.h
+// DESCRIPTION: contains monte carlo tree search using the agent's policy net
+//              for move priors and favor net for position values, an
+//              alternative to Agent::min_max_call
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "agent.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const double MCTS_CPUCT = 1.5; // weight of the prior against the value in selection
+const int32_t MCTS_VIRTUAL_LOSS = 3; // losses a path counts while a thread is on it
+const int MCTS_DEFAULT_PLAYOUTS = 800;
+const size_t MCTS_NODES_PER_PLAYOUT = 48; // arena size for a search is about this many per playout
+const int64_t MCTS_VALUE_SCALE = 1 << 20; // values are summed as fixed point so they can be atomic
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MCTS NODE
+// note: nodes live in an arena and the children of a node are one contiguous
+//       block starting at firstChild_. values are from the view of the side
+//       that made move_ so a parent picks the child with the highest value
+struct MctsNode {
+	enum State : uint8_t { Unexpanded, Expanding, Expanded, Terminal };
+
+	std::atomic<uint32_t> visits_;
+	std::atomic<int32_t>  virtualLoss_;
+	std::atomic<int64_t>  valueSum_; // fixed point, MCTS_VALUE_SCALE is a win
+	std::atomic<uint8_t>  state_;
+	uint16_t              childCount_;
+	uint32_t              firstChild_;
+	float                 prior_;
+	float                 terminal_; // value of a finished game for the side to move
+	int8_t                move_[4]; // current and desired position in board encoding
+	char                  promotion_;
+
+	// methods
+	void init(const Position &current, const Position &desired, const char &promotion, const float &prior) {
+		visits_.store(0, std::memory_order_relaxed);
+		virtualLoss_.store(0, std::memory_order_relaxed);
+		valueSum_.store(0, std::memory_order_relaxed);
+		state_.store(Unexpanded, std::memory_order_relaxed);
+		childCount_ = 0;
+		firstChild_ = 0;
+		prior_ = prior;
+		terminal_ = 0;
+		move_[0] = int8_t(current.first);
+		move_[1] = int8_t(current.second);
+		move_[2] = int8_t(desired.first);
+		move_[3] = int8_t(desired.second);
+		promotion_ = promotion;
+	}
+	Position current () const { return Position(move_[0], move_[1]); }
+	Position desired () const { return Position(move_[2], move_[3]); }
+	double value     () const { // average value, 0 if never visited
+		uint32_t visits = visits_.load(std::memory_order_relaxed);
+		return visits ? double(valueSum_.load(std::memory_order_relaxed)) / MCTS_VALUE_SCALE / visits : 0.0;
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MCTS SEARCH
+// note: puct search over an arena of nodes. threads descend the tree at the
+//       same time, virtual loss steers them onto different paths and a node
+//       is expanded by the first thread to reach it. the tree is kept
+//       between searches, if the next position is a child or grandchild of
+//       the last root its subtree is compacted into a fresh arena and
+//       searched further. one search may run at a time
+class MctsSearch {
+public:
+	// constructor
+	MctsSearch(const Agent &agent, const size_t &capacity = MCTS_DEFAULT_PLAYOUTS * MCTS_NODES_PER_PLAYOUT) :
+		agent_(agent), capacity_(max<size_t>(capacity, 1024)), size_(0), root_(0), hasTree_(false), full_(false) {}
+
+	// methods
+	Node search (const Board &board, const int &playouts, const int &threads = 1,
+				 SearchInfo *info = nullptr); // best move by visits, value_ in favor buckets like Agent::min_max_call
+	void clear  () { hasTree_ = false; }
+	uint32_t root_visits () const { return hasTree_ ? arena_[root_].visits_.load() : 0; }
+
+private:
+	// helpers
+	bool reuse     (const Board &board); // moves root to board if it is in the tree
+	void compact   (); // copies root's subtree into a new arena
+	bool playout   (const Board &board, vector<uint32_t> &path, SearchInfo *info, SearchStats &stats); // false if it hit a node being expanded
+	double expand  (const uint32_t &index, const Board &board, const bool &isRoot, SearchInfo *info,
+					SearchStats &stats); // value for the side to move
+	uint32_t select (const MctsNode &node) const; // puct choice among children
+	double leaf_value (const Board &board) const; // favor net output as a value for the side to move
+	void fill_pv   (SearchInfo *info) const; // most visited line
+
+	const Agent                &agent_;
+	size_t                      capacity_;
+	std::unique_ptr<MctsNode[]> arena_;
+	std::atomic<size_t>         size_; // nodes used in arena_
+	uint32_t                    root_;
+	Board                       rootBoard_;
+	bool                        hasTree_;
+	std::atomic<bool>           full_; // arena ran out of nodes during a search
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MCTS SEARCH functions
+////////////////////////////////////////
+// runs playouts on threads until playouts more have reached the root, the
+// search is stopped or the arena is full
+Node MctsSearch::search(const Board &board, const int &playouts, const int &threads, SearchInfo *info)
+{
+	if (!arena_)
+		arena_.reset(new MctsNode[capacity_]);
+
+	// start a new tree if the position isn't in the old one
+	if (!reuse(board))
+	{
+		rootBoard_ = board;
+		arena_[0].init(Position(), Position(), QUEEN_REP, 1.0f);
+		size_ = 1;
+		root_ = 0;
+		hasTree_ = true;
+	}
+	full_ = false;
+
+	if (info)
+	{
+		info->rootDepth_ = 0;
+		info->enter(0);
+	}
+
+	// each thread counts into its own stats, added to info once they are done
+	uint64_t target = arena_[root_].visits_ + uint64_t(max(playouts, 0));
+	vector<SearchStats> stats(max(threads, 1));
+	auto worker = [&](SearchStats &counts) {
+		vector<uint32_t> path;
+		while (arena_[root_].visits_.load(std::memory_order_relaxed) < target && !full_ &&
+			   !(info && info->should_stop()))
+			if (!playout(rootBoard_, path, info, counts))
+				std::this_thread::yield();
+	};
+
+	vector<std::thread> helpers;
+	for (int t = 1; t < threads; ++t)
+		helpers.push_back(std::thread(worker, std::ref(stats[t])));
+	worker(stats[0]);
+	for (std::thread &helper : helpers)
+		helper.join();
+
+	if (info)
+		for (const SearchStats &counts : stats)
+			info->stats_ += counts;
+
+	// most visited move, its value is put back into favor buckets for white
+	const MctsNode &root = arena_[root_];
+	Node best;
+	if (root.state_ != MctsNode::Expanded)
+		return best;
+
+	uint32_t bestChild = root.firstChild_;
+	for (uint32_t c = root.firstChild_; c < root.firstChild_ + root.childCount_; ++c)
+		if (arena_[c].visits_ > arena_[bestChild].visits_)
+			bestChild = c;
+
+	double draw = double(favor_to_index(0.0));
+	double scale = max(draw, BUCKETS - 1 - draw);
+	double value = arena_[bestChild].value();
+	best = Node(draw + (board.to_move() == Color::White ? value : -value) * scale,
+				arena_[bestChild].current(), arena_[bestChild].desired(), arena_[bestChild].promotion_);
+
+	fill_pv(info);
+	return best;
+}
+
+////////////////////////////////////////
+// finds board among the children and grandchildren of the root and makes it
+// the new root, false if it isn't there
+bool MctsSearch::reuse(const Board &board)
+{
+	if (!hasTree_)
+		return false;
+
+	uint64_t key = board.hash();
+	if (rootBoard_.hash() == key)
+	{
+		rootBoard_ = board;
+		return true;
+	}
+
+	const MctsNode &root = arena_[root_];
+	if (root.state_ != MctsNode::Expanded)
+		return false;
+
+	for (uint32_t c = root.firstChild_; c < root.firstChild_ + root.childCount_; ++c)
+	{
+		Board child(rootBoard_);
+		child.make_move(arena_[c].current(), arena_[c].desired(), arena_[c].promotion_);
+		child.update_move_set();
+		if (child.hash() == key)
+		{
+			root_ = c;
+			rootBoard_ = board;
+			compact();
+			return true;
+		}
+
+		if (arena_[c].state_ != MctsNode::Expanded)
+			continue;
+
+		for (uint32_t g = arena_[c].firstChild_; g < arena_[c].firstChild_ + arena_[c].childCount_; ++g)
+		{
+			Board grandchild(child);
+			grandchild.make_move(arena_[g].current(), arena_[g].desired(), arena_[g].promotion_);
+			grandchild.update_move_set();
+			if (grandchild.hash() == key)
+			{
+				root_ = g;
+				rootBoard_ = board;
+				compact();
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+////////////////////////////////////////
+// copies the root's subtree into a new arena breadth first so every block
+// of children stays contiguous, the rest of the old tree is dropped
+void MctsSearch::compact()
+{
+	std::unique_ptr<MctsNode[]> arena(new MctsNode[capacity_]);
+
+	auto copy = [&](const MctsNode &from, MctsNode &to) {
+		to.init(from.current(), from.desired(), from.promotion_, from.prior_);
+		to.visits_.store(from.visits_.load());
+		to.valueSum_.store(from.valueSum_.load());
+		to.terminal_ = from.terminal_;
+		uint8_t state = from.state_.load();
+		to.state_.store(state == MctsNode::Expanding ? uint8_t(MctsNode::Unexpanded) : state);
+	};
+
+	copy(arena_[root_], arena[0]);
+	size_t size = 1;
+	vector<pair<uint32_t, uint32_t>> queue = { make_pair(root_, 0u) }; // old and new index
+	for (size_t i = 0; i < queue.size(); ++i)
+	{
+		const MctsNode &from = arena_[queue[i].first];
+		MctsNode &to = arena[queue[i].second];
+		if (from.state_ != MctsNode::Expanded)
+			continue;
+
+		to.firstChild_ = uint32_t(size);
+		to.childCount_ = from.childCount_;
+		for (uint16_t c = 0; c < from.childCount_; ++c)
+		{
+			copy(arena_[from.firstChild_ + c], arena[size + c]);
+			queue.push_back(make_pair(from.firstChild_ + c, uint32_t(size + c)));
+		}
+		size += from.childCount_;
+	}
+
+	arena_ = std::move(arena);
+	size_ = size;
+	root_ = 0;
+}
+
+////////////////////////////////////////
+// descends from the root adding virtual loss, expands the leaf and backs its
+// value up the path. a path that meets a node another thread is expanding
+// takes its virtual loss back and is retried
+bool MctsSearch::playout(const Board &rootBoard, vector<uint32_t> &path, SearchInfo *info, SearchStats &stats)
+{
+	path.clear();
+	Board board(rootBoard);
+	uint32_t index = root_;
+	double value = 0; // for the side to move at the end of the path
+	while (true)
+	{
+		MctsNode &node = arena_[index];
+		node.virtualLoss_.fetch_add(MCTS_VIRTUAL_LOSS, std::memory_order_relaxed);
+		path.push_back(index);
+		++stats.nodes_;
+
+		uint8_t state = node.state_.load(std::memory_order_acquire);
+		if (state == MctsNode::Terminal)
+		{
+			value = node.terminal_;
+			break;
+		}
+		else if (state == MctsNode::Expanded)
+		{
+			index = select(node);
+			board.make_move(arena_[index].current(), arena_[index].desired(), arena_[index].promotion_);
+			board.update_move_set();
+			continue;
+		}
+
+		uint8_t expected = MctsNode::Unexpanded;
+		if (state == MctsNode::Unexpanded && node.state_.compare_exchange_strong(expected, MctsNode::Expanding))
+		{
+			value = expand(index, board, path.size() == 1, info, stats);
+			break;
+		}
+
+		// another thread is expanding this node
+		for (uint32_t i : path)
+			arena_[i].virtualLoss_.fetch_sub(MCTS_VIRTUAL_LOSS, std::memory_order_relaxed);
+		return false;
+	}
+
+	// each node's value is from the view of the side that moved into it
+	for (size_t i = path.size(); i-- > 0;)
+	{
+		value = -value;
+		MctsNode &node = arena_[path[i]];
+		node.valueSum_.fetch_add(int64_t(value * MCTS_VALUE_SCALE), std::memory_order_relaxed);
+		node.visits_.fetch_add(1, std::memory_order_relaxed);
+		node.virtualLoss_.fetch_sub(MCTS_VIRTUAL_LOSS, std::memory_order_relaxed);
+	}
+
+	return true;
+}
+
+////////////////////////////////////////
+// scores a new leaf and adds its children with policy priors, finished games
+// and tablebase positions become terminal. returns the leaf's value for the
+// side to move
+double MctsSearch::expand(const uint32_t &index, const Board &board, const bool &isRoot, SearchInfo *info,
+						  SearchStats &stats)
+{
+	MctsNode &node = arena_[index];
+	Color color = board.to_move();
+
+	// repetitions are draws below the root like in min_max
+	int outcome = board.end_game(color);
+	if (!isRoot && outcome == 0 && board.repetitions() > 0)
+		outcome = 2;
+	TablebaseResult result;
+	if (outcome == 0 && !isRoot && info && info->tablebases_ && info->tablebases_->probe(board, result))
+	{
+		++stats.tablebaseHits_;
+		outcome = result.wdl_ > 0 ? 3 : result.wdl_ < 0 ? 1 : 2;
+	}
+
+	// outcome 3 is a tablebase win for the side to move
+	if (outcome != 0)
+	{
+		node.terminal_ = outcome == 1 ? -1.0f : outcome == 3 ? 1.0f : 0.0f;
+		node.state_.store(MctsNode::Terminal, std::memory_order_release);
+		return node.terminal_;
+	}
+
+	// every legal move is a child, priors are the policy's move probabilities
+	vector<Node> moves = agent_.top_n_likely_moves(board, color, 0);
+
+	size_t first = size_.fetch_add(moves.size());
+	if (first + moves.size() > capacity_)
+	{
+		// tree is full, the leaf is scored but stays a leaf
+		full_ = true;
+		node.state_.store(MctsNode::Unexpanded, std::memory_order_release);
+		++stats.evals_;
+		stats.networkCalls_ += 2;
+		return leaf_value(board);
+	}
+
+	for (size_t i = 0; i < moves.size(); ++i)
+		arena_[first + i].init(moves[i].current_, moves[i].desired_, moves[i].promotion_, float(moves[i].value_));
+
+	node.firstChild_ = uint32_t(first);
+	node.childCount_ = uint16_t(moves.size());
+	node.state_.store(MctsNode::Expanded, std::memory_order_release);
+
+	++stats.evals_;
+	stats.networkCalls_ += 2;
+	return leaf_value(board);
+}
+
+////////////////////////////////////////
+// child with the highest puct score, children counted as visited and lost
+// once for each thread below them
+uint32_t MctsSearch::select(const MctsNode &node) const
+{
+	double parentVisits = node.visits_.load(std::memory_order_relaxed) + node.virtualLoss_.load(std::memory_order_relaxed);
+	double explore = MCTS_CPUCT * sqrt(max(parentVisits, 1.0));
+
+	uint32_t best = node.firstChild_;
+	double bestScore = -std::numeric_limits<double>::max();
+	for (uint32_t c = node.firstChild_; c < node.firstChild_ + node.childCount_; ++c)
+	{
+		const MctsNode &child = arena_[c];
+		double loss = child.virtualLoss_.load(std::memory_order_relaxed);
+		double visits = child.visits_.load(std::memory_order_relaxed) + loss;
+		double sum = double(child.valueSum_.load(std::memory_order_relaxed)) / MCTS_VALUE_SCALE - loss;
+		double score = (visits > 0 ? sum / visits : 0.0) + explore * child.prior_ / (1.0 + visits);
+		if (score > bestScore)
+		{
+			bestScore = score;
+			best = c;
+		}
+	}
+
+	return best;
+}
+
+////////////////////////////////////////
+// expected favor bucket of the favor net's output scaled to [-1, 1], then
+// turned to the view of the side to move
+double MctsSearch::leaf_value(const Board &board) const
+{
+	const ValD &favor = agent_.favor_output(board);
+	double total = favor.sum(), expected = 0;
+	for (size_t i = 0; i < favor.size(); ++i)
+		expected += i * favor[i];
+	expected = total > 0 ? expected / total : 0.0;
+
+	double draw = double(favor_to_index(0.0));
+	double value = max(-1.0, min(1.0, (expected - draw) / max(draw, BUCKETS - 1 - draw)));
+	return board.to_move() == Color::White ? value : -value;
+}
+
+////////////////////////////////////////
+// follows the most visited child from the root into info's principal variation
+void MctsSearch::fill_pv(SearchInfo *info) const
+{
+	if (!info)
+		return;
+
+	int length = 0;
+	uint32_t index = root_;
+	while (length < MAX_PLY && arena_[index].state_ == MctsNode::Expanded)
+	{
+		const MctsNode &node = arena_[index];
+		uint32_t best = node.firstChild_;
+		for (uint32_t c = node.firstChild_; c < node.firstChild_ + node.childCount_; ++c)
+			if (arena_[c].visits_ > arena_[best].visits_)
+				best = c;
+
+		if (arena_[best].visits_ == 0)
+			break;
+
+		info->pv_[0][length++] = Node(arena_[best].value(), arena_[best].current(), arena_[best].desired(),
+									  arena_[best].promotion_);
+		index = best;
+	}
+	info->pvLength_[0] = length;
+}
+
+#endif // MCTS_H
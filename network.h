@@ -1,5 +1,5 @@
 #ifndef NETWORK_H
-#define NETWORK__H
+#define NETWORK_H
 
 ////////////////////////////////////////////////////////////////////////////////
 //
@@ -14,40 +14,250 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 using std::cout; using std::endl; using std::ostream;
 using std::ofstream; using std::ifstream;
 using std::string;
 using std::istringstream;
+using std::future;
+using std::shared_ptr;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// NETWORK WORKSPACE
+// note: scratch space for forward propagation, one per thread so a set of
+//       weights can be evaluated by many threads at once. buffers are kept
+//       for each layer and size so networks of different shapes can share a
+//       workspace, once every shape has been seen evaluations don't allocate
+class NetworkWorkspace {
+public:
+	// methods
+	template <class A>
+	valarray<A> *rows (size_t layer, size_t size, size_t count); // count buffers of size for layer
+
+private:
+	template <class A>
+	struct Buffers {
+		size_t              layer_;
+		size_t              size_;
+		vector<valarray<A>> rows_; // one per input of a batch
+	};
+
+	// helpers
+	template <class A>
+	vector<Buffers<A>> &buffers () { if constexpr (std::is_same<A, float>::value) return float_; else return double_; }
+
+	vector<Buffers<double>> double_;
+	vector<Buffers<float>>  float_;
+};
+
+////////////////////////////////////////
+// buffers of layer for size values, only allocates for a new shape or a
+// bigger batch than before
+template <class A>
+valarray<A> *NetworkWorkspace::rows(size_t layer, size_t size, size_t count)
+{
+	vector<Buffers<A>> &all = buffers<A>();
+	size_t i = 0;
+	while (i != all.size() && (all[i].layer_ != layer || all[i].size_ != size))
+		++i;
+	if (i == all.size())
+		all.push_back(Buffers<A>{ layer, size, vector<valarray<A>>() });
+
+	vector<valarray<A>> &found = all[i].rows_;
+	if (found.size() < count)
+		found.resize(count, valarray<A>(A(0), size));
+
+	return found.data();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// NETWORK WEIGHTS
+// note: read only copy of a network's layers used for inference, shared
+//       between threads and agents through shared_ptr. activations are
+//       stateless so sharing their pointers is safe. the precision the
+//       weights are stored in is picked when they are copied from a network,
+//       outputs are always doubles. outputs already sized by an earlier call
+//       are written without allocating
+class NetworkWeights {
+public:
+	virtual ~NetworkWeights() {}
+
+	// methods
+	virtual size_t getInputSize  () const = 0;
+	virtual size_t getOutputSize () const = 0;
+	virtual Precision getPrecision () const = 0;
+	virtual void forwardPropagation (const ValD &inputs, NetworkWorkspace &workspace, ValD &outputs) const = 0; // writes output layer activations into outputs
+	virtual void forwardPropagation (const SparseInput &inputs, NetworkWorkspace &workspace, ValD &outputs) const = 0;
+	virtual void forwardPropagation (const vector<ValD> &inputs, NetworkWorkspace &workspace, vector<ValD> &outputs) const = 0; // output activations of each input
+	virtual void forwardPropagation (const vector<SparseInput> &inputs, NetworkWorkspace &workspace, vector<ValD> &outputs) const = 0;
+
+	// returning the outputs
+	template <class Input>
+	ValD forwardPropagation (const Input &inputs, NetworkWorkspace &workspace) const
+	{
+		ValD outputs;
+		forwardPropagation(inputs, workspace, outputs);
+		return outputs;
+	}
+	template <class Input>
+	vector<ValD> forwardPropagation (const vector<Input> &inputs, NetworkWorkspace &workspace) const
+	{
+		vector<ValD> outputs;
+		forwardPropagation(inputs, workspace, outputs);
+		return outputs;
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// STORED WEIGHTS
+// note: network weights stored as S and evaluated in S's accumulator type.
+//       the first layer's weights are only stored by input so each nonzero
+//       input adds one contiguous column. activations are applied in place
+//       so each layer's buffer holds its weighted inputs then alphas
+template <class S>
+class StoredWeights : public NetworkWeights {
+public:
+	typedef typename Accumulator<S>::type A;
+
+	// constructor
+	template <class T>
+	StoredWeights(const vector<Activation *> &activations, const vector<Layer<T>> &layers);
+
+	// methods
+	using NetworkWeights::forwardPropagation;
+	size_t getInputSize  () const { return layers_.front().size_; }
+	size_t getOutputSize () const { return layers_.back().size_; }
+	Precision getPrecision () const;
+	void forwardPropagation (const ValD &inputs, NetworkWorkspace &workspace, ValD &outputs) const;
+	void forwardPropagation (const SparseInput &inputs, NetworkWorkspace &workspace, ValD &outputs) const;
+	void forwardPropagation (const vector<ValD> &inputs, NetworkWorkspace &workspace, vector<ValD> &outputs) const;
+	void forwardPropagation (const vector<SparseInput> &inputs, NetworkWorkspace &workspace, vector<ValD> &outputs) const;
+
+private:
+	struct StoredLayer {
+		valarray<valarray<S>> weights_;
+		valarray<A>           biases_;
+		size_t                size_;
+	};
+
+	// helpers
+	const valarray<A> *propagateFrom (size_t first, const valarray<A> *alphas, size_t count,
+									  NetworkWorkspace &workspace) const; // layers first on for count inputs, alphas are the layer before's
+	void weighDense                  (const valarray<A> &inputs, valarray<A> &z) const; // first layer weighted inputs
+	void weighSparse                 (const SparseInput &inputs, valarray<A> &z) const;
+
+	vector<Activation *> activations_;
+	vector<StoredLayer>  layers_; // first layer weights are in inputColumns_ instead
+	vector<valarray<S>>  inputColumns_; // inputColumns_[i][j] is the weight from input i to neuron j
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SHARED NETWORK
+// note: holds the weights searches evaluate with. set swaps in new weights
+//       atomically while other threads are evaluating, those threads keep
+//       the weights they already got until their evaluation is done
+class SharedNetwork {
+public:
+	// constructor
+	SharedNetwork(shared_ptr<const NetworkWeights> weights = nullptr) : weights_(std::move(weights)) {}
+
+	// methods
+	shared_ptr<const NetworkWeights> get () const { return std::atomic_load(&weights_); }
+	void set (shared_ptr<const NetworkWeights> weights) { std::atomic_store(&weights_, std::move(weights)); }
+
+private:
+	shared_ptr<const NetworkWeights> weights_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TRAINING HELPERS
+// note: threads that compute slices of each mini-batch's gradient for a
+//       network's train calls and the state they share. copies start without
+//       threads, the threads belong to the network that started them
+struct TrainingHelpers {
+	// constructors
+	TrainingHelpers() {}
+	TrainingHelpers(const TrainingHelpers &) {}
+	TrainingHelpers &operator=(const TrainingHelpers &) { return *this; }
+
+	vector<std::thread>     threads_; // helper t computes slice t, this thread computes slice 0
+	vector<double>          losses_; // loss of each slice of the current batch
+	std::mutex              mutex_;
+	std::condition_variable started_, finished_;
+	size_t                  begin_ = 0, end_ = 0; // current batch
+	size_t                  slices_ = 1; // slices of the current batch, helpers past it skip the batch
+	size_t                  generation_ = 0; // counts batches so helpers know when the next one starts
+	size_t                  running_ = 0; // helpers still on the current batch
+	bool                    stop_ = false;
+};
 
 ////////////////////////////////////////////////////////////////////////////////
 //
 // NETWORK
+// note: T is the scalar type weights are trained in, float or double
+template <class T = double>
 class Network {
 public:
+	typedef valarray<T> Values;
+
 	// constructor
 	Network(vector<pair<size_t, Activation*>> layerSizes, double stepConst, double lambda);
+	~Network(); // stops the training helpers
 
 	// methods
 	void   dropout   (size_t layer, size_t toDrop);                                         // randomly chooses toDrop amount of neurons to dropout in layer
 	void   setLambda (double lambda)                       { lambda_ = lambda; }
 	void   setStep   (double step)                         { stepConstant_ = step; }
+	void   setBatchSize (size_t batchSize)                 { batchSize_ = batchSize > 0 ? batchSize : 1; }
+	void   setThreads   (size_t threads)                   { threads_ = threads > 0 ? threads : 1; }
+	void   setOptimizer (shared_ptr<Optimizer<T>> optimizer) { optimizer_ = std::move(optimizer); } // null uses plain SGD, copies of the network share it
 	void   save      (string name = "save.txt")     const;                                  // stores layer sizes, weights, and biases in a text file
 	void   load      (string name = "save.txt");                                            // loads layers, weights, and biases from a text file
 	size_t getInputSize  () const { return layers_.front().size_; }
 	size_t getOutputSize () const { return layers_.back().size_; }
+	shared_ptr<const NetworkWeights> weights () const; // copy of the current weights for inference in T
+	shared_ptr<const NetworkWeights> weights (const Precision &precision) const;
 
 	// helper functions
-	void backPropagation    (const ValD& alpha, const ValD& Yvalue); // uses backprop to adjust weights and biases
-	ValD forwardPropagation (const ValD& inputs);                    // returns a valarray of output layer activations
+	void backPropagation             (const Values& alpha, const Values& Yvalue); // uses backprop to adjust weights and biases
+	const Values &forwardPropagation (const Values& inputs);                      // returns output layer activations, valid until the next call
+	template <class Input>
+	double train            (const vector<pair<Input, Values>> &samples); // mini-batch training on (input, Yvalue) pairs, input is Values or SparseInput, returns total absolute error
 
 private:
-	vector<Activation *> activations_;
-	vector<Layer>        layers_;
-	vector<ValD>         z_; // need to store z values after each forward prop to be used in back prop alg
-	double               stepConstant_;
-	double               lambda_;
-	size_t               trainingSetSize_;
+	// training helpers
+	template <class Input>
+	double accumulateGradient (const Input &inputs, const Values &Yvalue, Gradient<T> &grad, TrainingWorkspace<T> &work) const; // adds sample's gradient to grad, returns its absolute error
+	void   applyGradient      (const Gradient<T> &grad);
+	void   prepare            (size_t threads, bool gradients); // sizes scratch space for threads, starts helpers when training
+	template <class Input>
+	void   trainSlice         (size_t t); // adds slice t of the current batch to grads_[t]
+	void   runHelper          (size_t t, size_t seen); // helper thread t, seen is the last batch it was started after
+
+	vector<Activation *>         activations_;
+	vector<Layer<T>>             layers_;
+	vector<TrainingWorkspace<T>> workspaces_; // one per training thread, the first is also used by forward and back prop
+	vector<Gradient<T>>          grads_; // one per training thread, reused by every mini-batch
+	double                       stepConstant_;
+	double                       lambda_;
+	size_t                       trainingSetSize_;
+	shared_ptr<Optimizer<T>>     optimizer_;
+	size_t                       batchSize_;
+	size_t                       threads_; // threads used to compute a mini-batch's gradient
+	const void                  *samples_; // samples of the running train call
+	void (Network::*slice_)(size_t); // trainSlice for their input type
+	TrainingHelpers              helpers_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -55,13 +265,17 @@ private:
 // NETWORK functions
 ////////////////////////////////////////
 // constructor
-Network::Network(vector<pair<size_t, Activation *>> layerSizes, double stepConst, double lambda) :
+template <class T>
+Network<T>::Network(vector<pair<size_t, Activation *>> layerSizes, double stepConst, double lambda) :
 	activations_(vector<Activation *>(layerSizes.size())),
-	layers_(vector<Layer>(layerSizes.size())),
-	z_(vector<ValD>(layerSizes.size())),
+	layers_(vector<Layer<T>>(layerSizes.size())),
 	stepConstant_(stepConst),
 	lambda_(lambda),
-	trainingSetSize_(1)
+	trainingSetSize_(1),
+	batchSize_(1),
+	threads_(std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1),
+	samples_(nullptr),
+	slice_(nullptr)
 {
 	// init activations vector, first activation is null since it is never used
 	for (size_t i = 1; i != layers_.size(); ++i)
@@ -70,80 +284,300 @@ Network::Network(vector<pair<size_t, Activation *>> layerSizes, double stepConst
 	// init layers, start from 1 since 0 is the input layer which doesn't have weights or biases
 	layers_[0].size_ = layerSizes[0].first;
 	for (size_t i = 1; i != layers_.size(); ++i)
-		layers_[i] = Layer(layerSizes[i - 1].first, layerSizes[i].first);
+		layers_[i] = Layer<T>(layerSizes[i - 1].first, layerSizes[i].first);
 }
 
 ////////////////////////////////////////
-// forward propagation, returns a valarray of output layer activations
-ValD Network::forwardPropagation(const ValD & inputs)
+// destructor, the helpers are between batches so they stop right away
+template <class T>
+Network<T>::~Network()
 {
-	// alpha is the activation from the previous neuron
-	// input layer
-	ValD alpha = inputs;
+	{
+		std::lock_guard<std::mutex> lock(helpers_.mutex_);
+		helpers_.stop_ = true;
+	}
+	helpers_.started_.notify_all();
+	for (std::thread &helper : helpers_.threads_)
+		helper.join();
+}
+
+////////////////////////////////////////
+// forward propagation, returns output layer activations. z and alpha of
+// every layer are kept in the first workspace to be used in back prop
+template <class T>
+const valarray<T> &Network<T>::forwardPropagation(const valarray<T> & inputs)
+{
+	prepare(1, false);
+	vector<valarray<T>> &z = workspaces_[0].z_, &alpha = workspaces_[0].alpha_;
 
-	// also store inputs in z_[0] for use in backprop function
-	z_[0] = inputs;
+	// input layer
+	alpha[0] = inputs;
 
 	// begin progatating forward, layer 0 is the input layer so start at layer 1
 	for (size_t l = 1; l != layers_.size(); ++l)
 	{
-		ValD z(layers_[l].size_);
-		for (size_t j = 0; j != layers_[l].size_; ++j) // finding z for the j-th neuron in the l-th layer
-			z[j] = (layers_[l].weights_[j] * alpha).sum() + layers_[l].biases_[j];
+		weighInputs(layers_[l], alpha[l - 1], z[l]);
+		activations_[l]->activate(z[l], alpha[l]);
+	}
 
-		// save z values
-		z_[l] = z;
+	return alpha.back();
+}
 
-		// get activations
-		alpha = activations_[l]->activate(z);
-	}
+////////////////////////////////////////
+// copy of the current weights for inference, training doesn't change it
+template <class T>
+shared_ptr<const NetworkWeights> Network<T>::weights() const
+{
+	return weights(std::is_same<T, float>::value ? Precision::Float : Precision::Double);
+}
 
-	return alpha;
+////////////////////////////////////////
+// copy of the current weights stored in precision
+template <class T>
+shared_ptr<const NetworkWeights> Network<T>::weights(const Precision &precision) const
+{
+	switch (precision)
+	{
+	case Precision::Float:
+		return std::make_shared<StoredWeights<float>>(activations_, layers_);
+	case Precision::BFloat16:
+		return std::make_shared<StoredWeights<BFloat16>>(activations_, layers_);
+	default:
+		return std::make_shared<StoredWeights<double>>(activations_, layers_);
+	}
 }
 
 ////////////////////////////////////////
-// back propagation algorithm to adjust weights and biases in each layer
-void Network::backPropagation(const ValD & alpha, const ValD & Yvalue)
+// back propagation algorithm to adjust weights and biases in each layer,
+// uses the values the last forward propagation left in the first workspace
+template <class T>
+void Network<T>::backPropagation(const valarray<T> & alpha, const valarray<T> & Yvalue)
 {
-	// init vector of deltas for each layer
-	const size_t L = layers_.size() - 1; // final layer
-	valarray<ValD> delta(L + 1);
+	prepare(1, false);
+	TrainingWorkspace<T> &work = workspaces_[0];
+	vector<valarray<T>> &delta = work.delta_;
 
 	// begin with delta in the output layer
-	delta[L] = Yvalue * (1.0 - alpha) - alpha * (1.0 - Yvalue);
+	const size_t L = layers_.size() - 1; // final layer
+	delta[L] = Yvalue * (T(1) - alpha) - alpha * (T(1) - Yvalue);
 
-	// now propagate backward to find deltas
+	// now propagate backward to find deltas, the derivative is the same for
+	// every k so it is applied once to the sum
 	for (size_t l = L - 1; l > 0; --l)
 	{
-		ValD deltaSum(0.0, layers_[l].size_);
+		activations_[l]->prime(work.z_[l], work.alpha_[l], work.prime_[l]);
+		delta[l] = T(0);
 		for (size_t k = 0; k != layers_[l + 1].size_; ++k)
-			deltaSum += layers_[l + 1].weights_[k] * delta[l + 1][k] * activations_[l]->prime(z_[l]);
+			delta[l] += layers_[l + 1].weights_[k] * delta[l + 1][k];
 
-		delta[l] = deltaSum;
+		delta[l] *= work.prime_[l];
 	}
 
-	// adjust weights and biases
+	// adjust weights and biases, the input layer's activations are the raw inputs
+	T regularization = T(lambda_ / trainingSetSize_);
 	for (size_t l = 1; l != layers_.size(); ++l)
 	{
-		layers_[l].biases_ += stepConstant_ * delta[l];
-		ValD activation = activations_[l - 1]->activate(z_[l - 1]);
-
+		layers_[l].biases_ += T(stepConstant_) * delta[l];
 		for (size_t j = 0; j != layers_[l].size_; ++j)
 		{
-			double deltaAndRatio = stepConstant_ * delta[l][j];
-			double regularization = lambda_ / trainingSetSize_;
+			T deltaAndRatio = T(stepConstant_) * delta[l][j];
+			layers_[l].weights_[j] += deltaAndRatio * work.alpha_[l - 1] + regularization * layers_[l].weights_[j];
+		}
+	}
+}
 
-			if (l - 1 != 0)
-				layers_[l].weights_[j] += deltaAndRatio * activation + regularization * layers_[l].weights_[j];
-			else
-				layers_[l].weights_[j] += deltaAndRatio * z_[l - 1] + regularization * layers_[l].weights_[j]; // doesn't need sigmoid since its the raw input
+////////////////////////////////////////
+// trains on samples in mini-batches, the gradient of each batch is computed in
+// parallel with each thread summing its own slice before one weight update.
+// the helper threads, workspaces and gradients are kept by the network so
+// batches and calls don't start threads or allocate
+template <class T>
+template <class Input>
+double Network<T>::train(const vector<pair<Input, valarray<T>>> &samples)
+{
+	size_t maxThreads = std::min(threads_, std::min(batchSize_, samples.size()));
+	prepare(maxThreads, true);
+	samples_ = &samples;
+	slice_ = &Network::template trainSlice<Input>;
+
+	double totalLoss = 0;
+	for (size_t first = 0; first < samples.size(); first += batchSize_)
+	{
+		{
+			std::lock_guard<std::mutex> lock(helpers_.mutex_);
+			helpers_.begin_ = first;
+			helpers_.end_ = std::min(first + batchSize_, samples.size());
+			helpers_.slices_ = std::min(maxThreads, helpers_.end_ - helpers_.begin_);
+			helpers_.running_ = helpers_.slices_ - 1;
+			++helpers_.generation_;
+		}
+		helpers_.started_.notify_all();
+
+		// first slice runs on this thread
+		trainSlice<Input>(0);
+		{
+			std::unique_lock<std::mutex> lock(helpers_.mutex_);
+			helpers_.finished_.wait(lock, [this]() { return helpers_.running_ == 0; });
 		}
+
+		// reduce gradients
+		totalLoss += helpers_.losses_[0];
+		for (size_t t = 1; t < helpers_.slices_; ++t)
+		{
+			totalLoss += helpers_.losses_[t];
+			grads_[0] += grads_[t];
+		}
+
+		// average over batch and update weights once
+		grads_[0] *= 1.0 / double(helpers_.end_ - helpers_.begin_);
+		applyGradient(grads_[0]);
 	}
+
+	samples_ = nullptr;
+	return totalLoss;
+}
+
+////////////////////////////////////////
+// gradient of every slices_'th sample of the current batch from t on, also
+// sets the slice's loss
+template <class T>
+template <class Input>
+void Network<T>::trainSlice(size_t t)
+{
+	const vector<pair<Input, Values>> &samples = *static_cast<const vector<pair<Input, Values>> *>(samples_);
+	grads_[t].clear();
+	double loss = 0;
+	for (size_t i = helpers_.begin_ + t; i < helpers_.end_; i += helpers_.slices_)
+		loss += accumulateGradient(samples[i].first, samples[i].second, grads_[t], workspaces_[t]);
+
+	helpers_.losses_[t] = loss;
+}
+
+////////////////////////////////////////
+// helper thread t waits for each batch, ones not needed for a short batch
+// skip it
+template <class T>
+void Network<T>::runHelper(size_t t, size_t seen)
+{
+	std::unique_lock<std::mutex> lock(helpers_.mutex_);
+	while (true)
+	{
+		helpers_.started_.wait(lock, [&]() { return helpers_.stop_ || helpers_.generation_ != seen; });
+		if (helpers_.stop_)
+			return;
+
+		seen = helpers_.generation_;
+		if (t >= helpers_.slices_)
+			continue;
+
+		lock.unlock();
+		(this->*slice_)(t);
+		lock.lock();
+		if (--helpers_.running_ == 0)
+			helpers_.finished_.notify_one();
+	}
+}
+
+////////////////////////////////////////
+// forward and back propagation for one sample without changing the network,
+// work holds the values of each layer. the first layer reads the inputs
+// directly so sparse inputs only touch their own weights
+template <class T>
+template <class Input>
+double Network<T>::accumulateGradient(const Input &inputs, const valarray<T> &Yvalue, Gradient<T> &grad, TrainingWorkspace<T> &work) const
+{
+	const size_t L = layers_.size() - 1; // final layer
+	vector<valarray<T>> &z = work.z_, &alpha = work.alpha_, &delta = work.delta_;
+
+	// forward propagation
+	weighInputs(layers_[1], inputs, z[1]);
+	activations_[1]->activate(z[1], alpha[1]);
+	for (size_t l = 2; l <= L; ++l)
+	{
+		weighInputs(layers_[l], alpha[l - 1], z[l]);
+		activations_[l]->activate(z[l], alpha[l]);
+	}
+
+	T loss = 0;
+	for (size_t i = 0; i != Yvalue.size(); ++i)
+		loss += std::abs(alpha[L][i] - Yvalue[i]);
+
+	// output layer delta
+	delta[L] = Yvalue * (T(1) - alpha[L]) - alpha[L] * (T(1) - Yvalue);
+
+	// propagate backward adding each layer's adjustments
+	for (size_t l = L; l > 0; --l)
+	{
+		grad.biases_[l] += delta[l];
+
+		// input layer doesn't need an activation
+		if (l == 1)
+		{
+			addWeightGradient(grad.weights_[1], delta[1], inputs);
+			break;
+		}
+		addWeightGradient(grad.weights_[l], delta[l], alpha[l - 1]);
+
+		// delta of the previous layer
+		activations_[l - 1]->prime(z[l - 1], alpha[l - 1], work.prime_[l - 1]);
+		delta[l - 1] = T(0);
+		for (size_t k = 0; k != layers_[l].size_; ++k)
+			delta[l - 1] += layers_[l].weights_[k] * delta[l][k];
+
+		delta[l - 1] *= work.prime_[l - 1];
+	}
+
+	return loss;
+}
+
+////////////////////////////////////////
+// applies regularization then lets the optimizer adjust weights and biases
+template <class T>
+void Network<T>::applyGradient(const Gradient<T> &grad)
+{
+	double regularization = lambda_ / trainingSetSize_;
+	if (regularization != 0.0)
+		for (size_t l = 1; l != layers_.size(); ++l)
+			for (size_t j = 0; j != layers_[l].size_; ++j)
+				layers_[l].weights_[j] += T(regularization) * layers_[l].weights_[j];
+
+	if (optimizer_)
+		optimizer_->update(layers_, grad, stepConstant_);
+	else
+		SGD<T>().update(layers_, grad, stepConstant_);
+}
+
+////////////////////////////////////////
+// sizes a workspace for each of threads and their gradients if training,
+// they are only reallocated once the layers change shape
+template <class T>
+void Network<T>::prepare(size_t threads, bool gradients)
+{
+	if (!workspaces_.empty() && !workspaces_[0].matches(layers_))
+	{
+		workspaces_.clear();
+		grads_.clear();
+	}
+
+	while (workspaces_.size() < threads)
+		workspaces_.push_back(TrainingWorkspace<T>(layers_));
+	while (gradients && grads_.size() < threads)
+		grads_.push_back(Gradient<T>(layers_));
+
+	// helpers are started the first time they're needed and kept, they start
+	// from the current batch so they wait for the next one
+	if (!gradients)
+		return;
+	if (helpers_.losses_.size() < threads)
+		helpers_.losses_.resize(threads, 0.0);
+	for (size_t t = helpers_.threads_.size() + 1; t < threads; ++t)
+		helpers_.threads_.push_back(std::thread(&Network::runHelper, this, t, helpers_.generation_));
 }
 
 ////////////////////////////////////////
 // randomly chooses toDrop amount of neurons to dropout in layer
-void Network::dropout(size_t layer, size_t toDrop)
+template <class T>
+void Network<T>::dropout(size_t layer, size_t toDrop)
 {
 	if (layer == 0 || layer >= layers_.size() - 1) // can't dropout in the input layer or output layer
 		return;
@@ -162,8 +596,8 @@ void Network::dropout(size_t layer, size_t toDrop)
 	}
 
 	// changing layer
-	valarray<ValD> newWeights(ValD(layers_[layer - 1].size_), layers_[layer].size_ - toDrop);
-	ValD newBiases(layers_[layer].size_ - toDrop);
+	valarray<valarray<T>> newWeights(valarray<T>(layers_[layer - 1].size_), layers_[layer].size_ - toDrop);
+	valarray<T> newBiases(layers_[layer].size_ - toDrop);
 	for (size_t j = 0, k = 0; j < layers_[layer].size_; ++j)
 		if (std::find(neuronsToDrop.begin(), neuronsToDrop.end(), j) == neuronsToDrop.end()) // if index j isnt to be dropped
 		{
@@ -177,7 +611,7 @@ void Network::dropout(size_t layer, size_t toDrop)
 	layers_[layer].size_ = layers_[layer].size_ - toDrop;
 
 	// changing next layer
-	newWeights = valarray<ValD>(ValD(layers_[layer].size_), layers_[layer + 1].size_);
+	newWeights = valarray<valarray<T>>(valarray<T>(layers_[layer].size_), layers_[layer + 1].size_);
 	for (size_t j = 0; j < newWeights.size(); ++j)
 		for (size_t k = 0, p = 0; k < newWeights[j].size() + toDrop; ++k)
 			if (std::find(neuronsToDrop.begin(), neuronsToDrop.end(), k) == neuronsToDrop.end()) // if index k isnt to be dropped
@@ -191,7 +625,8 @@ void Network::dropout(size_t layer, size_t toDrop)
 
 ////////////////////////////////////////
 // stores layer sizes, weights, and biases in a text file
-void Network::save(string name) const
+template <class T>
+void Network<T>::save(string name) const
 {
 	ofstream store(name);
 
@@ -220,7 +655,8 @@ void Network::save(string name) const
 
 ////////////////////////////////////////
 // loads layer sizes, weights, and biases from a text file
-void Network::load(string name)
+template <class T>
+void Network<T>::load(string name)
 {
 	ifstream input(name);
 
@@ -241,10 +677,10 @@ void Network::load(string name)
 		layerSizes.push_back(stoi(word));
 
 	// now set layers
-	layers_ = vector<Layer>(layerSizes.size());
+	layers_ = vector<Layer<T>>(layerSizes.size());
 	layers_[0].size_ = layerSizes[0];
 	for (size_t i = 1; i != layers_.size(); ++i)
-		layers_[i] = Layer(layerSizes[i - 1], layerSizes[i]);
+		layers_[i] = Layer<T>(layerSizes[i - 1], layerSizes[i]);
 
 	// get weights
 	string weight;
@@ -253,7 +689,7 @@ void Network::load(string name)
 			for (size_t k = 0; k < layers_[i].weights_[j].size(); ++k)
 			{
 				input >> weight;
-				layers_[i].weights_[j][k] = stod(weight);
+				layers_[i].weights_[j][k] = T(stod(weight));
 			}
 
 	// get biases
@@ -262,10 +698,186 @@ void Network::load(string name)
 		for (size_t j = 0; j < layers_[i].size_; ++j)
 		{
 			input >> bias;
-			layers_[i].biases_[j] = stod(bias);
+			layers_[i].biases_[j] = T(stod(bias));
 		}
 
 	cout << "Network loaded" << endl;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// STORED WEIGHTS functions
+////////////////////////////////////////
+// copies layers into S, biases are kept in the accumulator type since there
+// are few of them
+template <class S>
+template <class T>
+StoredWeights<S>::StoredWeights(const vector<Activation *> &activations, const vector<Layer<T>> &layers) :
+	activations_(activations),
+	layers_(layers.size())
+{
+	for (size_t l = 0; l != layers.size(); ++l)
+	{
+		layers_[l].size_ = layers[l].size_;
+		layers_[l].biases_ = convertValues<A>(layers[l].biases_);
+
+		// the input layer has no weights, the first layer's are stored by input below
+		if (l <= 1)
+			continue;
+
+		layers_[l].weights_ = valarray<valarray<S>>(layers[l].weights_.size());
+		for (size_t j = 0; j != layers[l].weights_.size(); ++j)
+			layers_[l].weights_[j] = convertValues<S>(layers[l].weights_[j]);
+	}
+
+	// first layer by input
+	if (layers.size() > 1)
+	{
+		inputColumns_.assign(layers[0].size_, valarray<S>(layers[1].size_));
+		for (size_t j = 0; j != layers[1].size_; ++j)
+			for (size_t i = 0; i != layers[0].size_; ++i)
+				inputColumns_[i][j] = S(layers[1].weights_[j][i]);
+	}
+}
+
+////////////////////////////////////////
+// precision the weights are stored in
+template <class S>
+Precision StoredWeights<S>::getPrecision() const
+{
+	if (std::is_same<S, float>::value)
+		return Precision::Float;
+	if (std::is_same<S, BFloat16>::value)
+		return Precision::BFloat16;
+
+	return Precision::Double;
+}
+
+////////////////////////////////////////
+// forward propagation without changing the weights, workspace holds the
+// weighted inputs so it can't be shared between threads
+template <class S>
+void StoredWeights<S>::forwardPropagation(const ValD &inputs, NetworkWorkspace &workspace, ValD &outputs) const
+{
+	valarray<A> *input = workspace.rows<A>(0, layers_[0].size_, 1);
+	copyValues(inputs, *input);
+
+	valarray<A> *alpha = workspace.rows<A>(1, layers_[1].size_, 1);
+	weighDense(*input, *alpha);
+	activations_[1]->activate(*alpha, *alpha);
+
+	copyValues(*propagateFrom(2, alpha, 1, workspace), outputs);
+}
+
+////////////////////////////////////////
+// forward propagation of an input that is mostly zeros
+template <class S>
+void StoredWeights<S>::forwardPropagation(const SparseInput &inputs, NetworkWorkspace &workspace, ValD &outputs) const
+{
+	valarray<A> *alpha = workspace.rows<A>(1, layers_[1].size_, 1);
+	weighSparse(inputs, *alpha);
+	activations_[1]->activate(*alpha, *alpha);
+
+	copyValues(*propagateFrom(2, alpha, 1, workspace), outputs);
+}
+
+////////////////////////////////////////
+// forward propagation of a batch, each neuron's weights are applied to every
+// input while they are in cache instead of being reloaded per input
+template <class S>
+void StoredWeights<S>::forwardPropagation(const vector<ValD> &inputs, NetworkWorkspace &workspace, vector<ValD> &outputs) const
+{
+	valarray<A> *values = workspace.rows<A>(0, layers_[0].size_, inputs.size());
+	valarray<A> *alphas = workspace.rows<A>(1, layers_[1].size_, inputs.size());
+	for (size_t i = 0; i != inputs.size(); ++i)
+	{
+		copyValues(inputs[i], values[i]);
+		weighDense(values[i], alphas[i]);
+		activations_[1]->activate(alphas[i], alphas[i]);
+	}
+
+	const valarray<A> *results = propagateFrom(2, alphas, inputs.size(), workspace);
+	outputs.resize(inputs.size());
+	for (size_t i = 0; i != inputs.size(); ++i)
+		copyValues(results[i], outputs[i]);
+}
+
+////////////////////////////////////////
+// forward propagation of a batch of inputs that are mostly zeros
+template <class S>
+void StoredWeights<S>::forwardPropagation(const vector<SparseInput> &inputs, NetworkWorkspace &workspace, vector<ValD> &outputs) const
+{
+	valarray<A> *alphas = workspace.rows<A>(1, layers_[1].size_, inputs.size());
+	for (size_t i = 0; i != inputs.size(); ++i)
+	{
+		weighSparse(inputs[i], alphas[i]);
+		activations_[1]->activate(alphas[i], alphas[i]);
+	}
+
+	const valarray<A> *results = propagateFrom(2, alphas, inputs.size(), workspace);
+	outputs.resize(inputs.size());
+	for (size_t i = 0; i != inputs.size(); ++i)
+		copyValues(results[i], outputs[i]);
+}
+
+////////////////////////////////////////
+// runs layers first on for count inputs, each neuron's weights are applied
+// to every input while they are in cache. returns the output activations,
+// they stay in the workspace until its next use
+template <class S>
+const valarray<typename Accumulator<S>::type> *StoredWeights<S>::propagateFrom(size_t first, const valarray<A> *alphas, size_t count,
+																			   NetworkWorkspace &workspace) const
+{
+	for (size_t l = first; l < layers_.size(); ++l)
+	{
+		valarray<A> *z = workspace.rows<A>(l, layers_[l].size_, count);
+		for (size_t j = 0; j != layers_[l].size_; ++j)
+		{
+			const valarray<S> &weights = layers_[l].weights_[j];
+			for (size_t i = 0; i != count; ++i)
+				z[i][j] = dotProduct(weights, alphas[i]) + layers_[l].biases_[j];
+		}
+
+		for (size_t i = 0; i != count; ++i)
+			activations_[l]->activate(z[i], z[i]);
+		alphas = z;
+	}
+
+	return alphas;
+}
+
+////////////////////////////////////////
+// first layer weighted inputs, summed like sparse inputs so a dense input
+// gives the same result as the sparse one it was made from
+template <class S>
+void StoredWeights<S>::weighDense(const valarray<A> &inputs, valarray<A> &z) const
+{
+	z = layers_[1].biases_; // z is already sized, assigning doesn't allocate
+	for (size_t i = 0; i != inputs.size(); ++i)
+		if (inputs[i] != A(0))
+			addScaled(z, inputs[i], inputColumns_[i]);
+}
+
+////////////////////////////////////////
+// first layer weighted inputs of an input that is mostly zeros, each nonzero
+// input adds its column of weights
+template <class S>
+void StoredWeights<S>::weighSparse(const SparseInput &inputs, valarray<A> &z) const
+{
+	z = layers_[1].biases_; // z is already sized, assigning doesn't allocate
+	for (const pair<size_t, double> &input : inputs.active_)
+		addScaled(z, A(input.second), inputColumns_[input.first]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// workspace of the calling thread, reused by every evaluation it makes
+inline NetworkWorkspace &thread_workspace()
+{
+	thread_local NetworkWorkspace workspace;
+	return workspace;
+}
+
 #endif // NETWORK_H
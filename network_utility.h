@@ -15,20 +15,77 @@
 #include <random>
 #include <chrono>
 #include <utility>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 using std::valarray;
 using std::vector;
 using std::pair; using std::make_pair;
 
 typedef valarray<double> ValD;
+typedef valarray<float> ValF;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// PRECISION
+// note: scalar type weights are stored in for inference, bfloat16 weights
+//       are multiplied in float
+enum class Precision { Double, Float, BFloat16 };
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// BFLOAT16
+// note: upper half of a float, same range with an 8 bit mantissa. only used
+//       to store weights, values are turned back into floats to be used
+struct BFloat16 {
+	// constructors
+	BFloat16() : bits_(0) {}
+	BFloat16(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		if (std::isnan(value))
+			bits_ = uint16_t((bits >> 16) | 0x40); // stays a nan after truncating
+		else
+			bits_ = uint16_t((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16); // round to nearest even
+	}
+
+	// conversion
+	operator float() const
+	{
+		uint32_t bits = uint32_t(bits_) << 16;
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	uint16_t bits_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ACCUMULATOR
+// note: type the weights of storage type S are multiplied and summed in
+template <class S> struct Accumulator { typedef S type; };
+template <> struct Accumulator<BFloat16> { typedef float type; };
 
 ////////////////////////////////////////////////////////////////////////////////
 //
 // ACTIVATION base
+// note: the in place versions write into an alpha or prime already sized
+//       like z, prime reuses alpha = activate(z) instead of recomputing it
 class Activation {
 public:
-	virtual ValD activate (const ValD &z) = 0;
-	virtual ValD prime    (const ValD &z) = 0;
+	virtual ValD activate (const ValD &z) const = 0;
+	virtual ValD prime    (const ValD &z) const = 0;
+	virtual ValF activate (const ValF &z) const = 0;
+	virtual ValF prime    (const ValF &z) const = 0;
+	virtual void activate (const ValD &z, ValD &alpha) const = 0;
+	virtual void prime    (const ValD &z, const ValD &alpha, ValD &prime) const = 0;
+	virtual void activate (const ValF &z, ValF &alpha) const = 0;
+	virtual void prime    (const ValF &z, const ValF &alpha, ValF &prime) const = 0;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -36,8 +93,14 @@ public:
 // LINEAR derived
 class Linear: public Activation {
 public:
-	ValD activate (const ValD &z) { return z; }
-	ValD prime    (const ValD &z) { return ValD(1.0, z.size()); }
+	ValD activate (const ValD &z) const { return z; }
+	ValD prime    (const ValD &z) const { return ValD(1.0, z.size()); }
+	ValF activate (const ValF &z) const { return z; }
+	ValF prime    (const ValF &z) const { return ValF(1.0f, z.size()); }
+	void activate (const ValD &z, ValD &alpha) const { alpha = z; }
+	void prime    (const ValD &, const ValD &, ValD &prime) const { prime = 1.0; }
+	void activate (const ValF &z, ValF &alpha) const { alpha = z; }
+	void prime    (const ValF &, const ValF &, ValF &prime) const { prime = 1.0f; }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -45,8 +108,22 @@ public:
 // Sigmoid derived
 class Sigmoid: public Activation {
 public:
-	ValD activate (const ValD &z) { return 1.0 / (1.0 + exp(-z)); }
-	ValD prime    (const ValD &z) { return activate(z) * (1.0 - activate(z)); }
+	ValD activate (const ValD &z) const { return 1.0 / (1.0 + exp(-z)); }
+	ValD prime    (const ValD &z) const { ValD alpha = activate(z); return alpha * (1.0 - alpha); }
+	ValF activate (const ValF &z) const { return 1.0f / (1.0f + exp(-z)); }
+	ValF prime    (const ValF &z) const { ValF alpha = activate(z); return alpha * (1.0f - alpha); }
+	void activate (const ValD &z, ValD &alpha) const { sigmoid(z, alpha); }
+	void prime    (const ValD &, const ValD &alpha, ValD &prime) const { prime = alpha * (1.0 - alpha); }
+	void activate (const ValF &z, ValF &alpha) const { sigmoid(z, alpha); }
+	void prime    (const ValF &, const ValF &alpha, ValF &prime) const { prime = alpha * (1.0f - alpha); }
+
+private:
+	template <class A>
+	static void sigmoid(const valarray<A> &z, valarray<A> &alpha)
+	{
+		for (size_t i = 0; i != z.size(); ++i)
+			alpha[i] = A(1) / (A(1) + std::exp(-z[i]));
+	}
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -57,13 +134,16 @@ public:
 //        neuron -------------------------- neuron
 //               |          W[1][0]
 //               -------------------------- neuron
-// and the weights pictured above belong under L2
+// and the weights pictured above belong under L2. T is the scalar type
+template <class T = double>
 struct Layer {
+	typedef valarray<T> Values;
+
 	// constructors
 	Layer() : size_(0) {}
 	Layer(size_t prevLayerNeurons, size_t neurons) :
-		weights_(valarray<ValD>(ValD(prevLayerNeurons), neurons)),
-		biases_(ValD(neurons)),
+		weights_(valarray<Values>(Values(prevLayerNeurons), neurons)),
+		biases_(Values(neurons)),
 		size_(neurons)
 	{
 		// init seed and create distibution
@@ -91,9 +171,377 @@ struct Layer {
 		return *this;
 	}
 	
-	valarray<ValD> weights_;
-	ValD           biases_;
-	size_t         size_;
+	valarray<Values> weights_;
+	Values           biases_;
+	size_t           size_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SPARSE INPUT
+// notes: network input that is mostly zeros stored as the index and value of
+//        each nonzero input, the first layer only reads the weights of those
+struct SparseInput {
+	// constructors
+	SparseInput(size_t size = 0) : size_(size) {}
+	SparseInput(const ValD &dense) : size_(dense.size())
+	{
+		for (size_t i = 0; i != dense.size(); ++i)
+			if (dense[i] != 0.0)
+				active_.push_back(make_pair(i, dense[i]));
+	}
+
+	// methods
+	void add   (size_t index, double value) { active_.push_back(make_pair(index, value)); }
+	void clear (size_t size) { active_.clear(); size_ = size; } // keeps the storage so refilling doesn't allocate
+	ValD dense () const
+	{
+		ValD inputs(0.0, size_);
+		for (const pair<size_t, double> &input : active_)
+			inputs[input.first] = input.second;
+
+		return inputs;
+	}
+
+	vector<pair<size_t, double>> active_;
+	size_t                       size_; // number of inputs including the zeros
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// weighted inputs of layer, z = weights * inputs + biases
+template <class T>
+void weighInputs(const Layer<T> &layer, const valarray<T> &inputs, valarray<T> &z)
+{
+	if (z.size() != layer.size_)
+		z.resize(layer.size_);
+	for (size_t j = 0; j != layer.size_; ++j)
+		z[j] = (layer.weights_[j] * inputs).sum() + layer.biases_[j];
+}
+
+////////////////////////////////////////
+// weighted inputs of layer reading only the weights of nonzero inputs
+template <class T>
+void weighInputs(const Layer<T> &layer, const SparseInput &inputs, valarray<T> &z)
+{
+	if (z.size() != layer.size_)
+		z.resize(layer.size_);
+	for (size_t j = 0; j != layer.size_; ++j)
+	{
+		const valarray<T> &weights = layer.weights_[j];
+		T sum = layer.biases_[j];
+		for (const pair<size_t, double> &input : inputs.active_)
+			sum += weights[input.first] * T(input.second);
+		z[j] = sum;
+	}
+}
+
+////////////////////////////////////////
+// adds delta[j] * inputs to row j of a layer's weight adjustments
+template <class T>
+void addWeightGradient(valarray<valarray<T>> &weights, const valarray<T> &delta, const valarray<T> &inputs)
+{
+	for (size_t j = 0; j != weights.size(); ++j)
+		weights[j] += delta[j] * inputs;
+}
+
+////////////////////////////////////////
+// only the weights of nonzero inputs have an adjustment
+template <class T>
+void addWeightGradient(valarray<valarray<T>> &weights, const valarray<T> &delta, const SparseInput &inputs)
+{
+	for (size_t j = 0; j != weights.size(); ++j)
+		for (const pair<size_t, double> &input : inputs.active_)
+			weights[j][input.first] += delta[j] * T(input.second);
+}
+
+////////////////////////////////////////
+// copy of values in another scalar type
+template <class To, class From>
+valarray<To> convertValues(const valarray<From> &values)
+{
+	if constexpr (std::is_same<To, From>::value)
+		return values;
+	else
+	{
+		valarray<To> converted(values.size());
+		for (size_t i = 0; i != values.size(); ++i)
+			converted[i] = To(values[i]);
+
+		return converted;
+	}
+}
+
+////////////////////////////////////////
+// values converted into to, which is only reallocated if its size differs
+template <class From, class To>
+void copyValues(const valarray<From> &from, valarray<To> &to)
+{
+	if (to.size() != from.size())
+		to.resize(from.size());
+	for (size_t i = 0; i != from.size(); ++i)
+		to[i] = To(from[i]);
+}
+
+////////////////////////////////////////
+// weights dotted with inputs in the accumulator type
+template <class S, class A>
+A dotProduct(const valarray<S> &weights, const valarray<A> &inputs)
+{
+	A sum = 0;
+	for (size_t i = 0; i != inputs.size(); ++i)
+		sum += A(weights[i]) * inputs[i];
+
+	return sum;
+}
+
+////////////////////////////////////////
+// weights already in the accumulator type use valarray arithmetic
+template <class A>
+A dotProduct(const valarray<A> &weights, const valarray<A> &inputs)
+{
+	return (weights * inputs).sum();
+}
+
+////////////////////////////////////////
+// adds scale * weights to z in the accumulator type
+template <class S, class A>
+void addScaled(valarray<A> &z, const A &scale, const valarray<S> &weights)
+{
+	for (size_t i = 0; i != z.size(); ++i)
+		z[i] += scale * A(weights[i]);
+}
+
+////////////////////////////////////////
+// weights already in the accumulator type use valarray arithmetic
+template <class A>
+void addScaled(valarray<A> &z, const A &scale, const valarray<A> &weights)
+{
+	z += scale * weights;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// GRADIENT
+// notes: same shape as the layers of a network, holds the weight and bias
+//        adjustments accumulated over a mini-batch. adjustments point in the
+//        direction that improves the network so they are added to the weights
+template <class T = double>
+struct Gradient {
+	typedef valarray<T> Values;
+
+	// constructors
+	Gradient() {}
+	Gradient(const vector<Layer<T>> &layers) :
+		weights_(vector<valarray<Values>>(layers.size())),
+		biases_(vector<Values>(layers.size()))
+	{
+		// layer 0 is the input layer which doesn't have weights or biases
+		for (size_t l = 1; l < layers.size(); ++l)
+		{
+			weights_[l] = valarray<Values>(Values(T(0), layers[l - 1].size_), layers[l].size_);
+			biases_[l] = Values(T(0), layers[l].size_);
+		}
+	}
+
+	// checks if gradient has the same shape as layers, layers change size with dropout and load
+	bool matches(const vector<Layer<T>> &layers) const
+	{
+		if (layers.size() != biases_.size())
+			return false;
+
+		for (size_t l = 1; l < layers.size(); ++l)
+			if (biases_[l].size() != layers[l].size_ || weights_[l][0].size() != layers[l - 1].size_)
+				return false;
+
+		return true;
+	}
+
+	// zeros every adjustment so the gradient can be reused by the next mini-batch
+	void clear()
+	{
+		for (size_t l = 1; l < biases_.size(); ++l)
+		{
+			for (size_t j = 0; j < weights_[l].size(); ++j)
+				weights_[l][j] = T(0);
+			biases_[l] = T(0);
+		}
+	}
+
+	// sums another gradient into this one, used to reduce per thread gradients
+	Gradient& operator+=(const Gradient &rhs)
+	{
+		for (size_t l = 1; l < biases_.size(); ++l)
+		{
+			for (size_t j = 0; j < weights_[l].size(); ++j)
+				weights_[l][j] += rhs.weights_[l][j];
+			biases_[l] += rhs.biases_[l];
+		}
+
+		return *this;
+	}
+
+	// scales every adjustment, used to average over a mini-batch
+	Gradient& operator*=(double scale)
+	{
+		for (size_t l = 1; l < biases_.size(); ++l)
+		{
+			for (size_t j = 0; j < weights_[l].size(); ++j)
+				weights_[l][j] *= T(scale);
+			biases_[l] *= T(scale);
+		}
+
+		return *this;
+	}
+
+	vector<valarray<Values>> weights_;
+	vector<Values>           biases_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TRAINING WORKSPACE
+// notes: one thread's values for forward and back propagation, sized from the
+//        layers once so training steps reuse them. layer 0's activations are
+//        the dense inputs
+template <class T = double>
+struct TrainingWorkspace {
+	typedef valarray<T> Values;
+
+	// constructors
+	TrainingWorkspace() {}
+	TrainingWorkspace(const vector<Layer<T>> &layers) :
+		z_(vector<Values>(layers.size())),
+		alpha_(vector<Values>(layers.size())),
+		delta_(vector<Values>(layers.size())),
+		prime_(vector<Values>(layers.size()))
+	{
+		for (size_t l = 0; l < layers.size(); ++l)
+		{
+			z_[l] = Values(T(0), layers[l].size_);
+			alpha_[l] = Values(T(0), layers[l].size_);
+			delta_[l] = Values(T(0), layers[l].size_);
+			prime_[l] = Values(T(0), layers[l].size_);
+		}
+	}
+
+	// checks if workspace has the same shape as layers
+	bool matches(const vector<Layer<T>> &layers) const
+	{
+		if (layers.size() != z_.size())
+			return false;
+
+		for (size_t l = 0; l < layers.size(); ++l)
+			if (z_[l].size() != layers[l].size_)
+				return false;
+
+		return true;
+	}
+
+	vector<Values> z_;     // weighted inputs of each layer
+	vector<Values> alpha_; // activations of each layer
+	vector<Values> delta_; // error in each layer's weighted inputs
+	vector<Values> prime_; // activation derivatives of each layer
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// OPTIMIZER base
+template <class T = double>
+class Optimizer {
+public:
+	virtual ~Optimizer() = default;
+	virtual void update (vector<Layer<T>> &layers, const Gradient<T> &grad, double step) = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SGD derived
+// note: a momentum of 0 is plain stochastic gradient descent
+template <class T = double>
+class SGD: public Optimizer<T> {
+public:
+	SGD(double momentum = 0.0) : momentum_(momentum) {}
+
+	void update(vector<Layer<T>> &layers, const Gradient<T> &grad, double step)
+	{
+		// velocity is created on first update or if the layers changed shape
+		if (momentum_ != 0.0 && !velocity_.matches(layers))
+			velocity_ = Gradient<T>(layers);
+
+		T momentum = T(momentum_), rate = T(step);
+		for (size_t l = 1; l < layers.size(); ++l)
+		{
+			if (momentum_ == 0.0)
+			{
+				for (size_t j = 0; j < layers[l].size_; ++j)
+					layers[l].weights_[j] += rate * grad.weights_[l][j];
+				layers[l].biases_ += rate * grad.biases_[l];
+				continue;
+			}
+
+			for (size_t j = 0; j < layers[l].size_; ++j)
+			{
+				velocity_.weights_[l][j] = momentum * velocity_.weights_[l][j] + rate * grad.weights_[l][j];
+				layers[l].weights_[j] += velocity_.weights_[l][j];
+			}
+			velocity_.biases_[l] = momentum * velocity_.biases_[l] + rate * grad.biases_[l];
+			layers[l].biases_ += velocity_.biases_[l];
+		}
+	}
+
+private:
+	double      momentum_;
+	Gradient<T> velocity_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ADAM derived
+template <class T = double>
+class Adam: public Optimizer<T> {
+public:
+	Adam(double beta1 = 0.9, double beta2 = 0.999, double epsilon = 1e-8) :
+		beta1_(beta1), beta2_(beta2), epsilon_(epsilon), t_(0) {}
+
+	void update(vector<Layer<T>> &layers, const Gradient<T> &grad, double step)
+	{
+		// moments are created on first update or if the layers changed shape
+		if (!m_.matches(layers))
+		{
+			m_ = Gradient<T>(layers);
+			v_ = Gradient<T>(layers);
+			t_ = 0;
+		}
+		++t_;
+
+		// bias corrections for the moment estimates
+		T correction1 = T(1.0 - pow(beta1_, t_)),
+			correction2 = T(1.0 - pow(beta2_, t_));
+		T beta1 = T(beta1_), beta2 = T(beta2_), epsilon = T(epsilon_), rate = T(step);
+
+		// adjusts values in place, valarray expressions don't need temporaries
+		auto adjust = [&](valarray<T> &values, valarray<T> &m, valarray<T> &v, const valarray<T> &g) {
+			m = beta1 * m + (T(1) - beta1) * g;
+			v = beta2 * v + (T(1) - beta2) * g * g;
+			values += rate * (m / correction1) / (sqrt(v / correction2) + epsilon);
+		};
+
+		for (size_t l = 1; l < layers.size(); ++l)
+		{
+			for (size_t j = 0; j < layers[l].size_; ++j)
+				adjust(layers[l].weights_[j], m_.weights_[l][j], v_.weights_[l][j], grad.weights_[l][j]);
+			adjust(layers[l].biases_, m_.biases_[l], v_.biases_[l], grad.biases_[l]);
+		}
+	}
+
+private:
+	double      beta1_, beta2_, epsilon_;
+	size_t      t_; // number of updates made
+	Gradient<T> m_; // first moment estimate
+	Gradient<T> v_; // second moment estimate
 };
 
 #endif // NETWORK_UTILITY_H
@@ -0,0 +1,289 @@
+#ifndef PGN_PIPELINE_H
+#define PGN_PIPELINE_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        pgn_pipeline.h
+// DESCRIPTION: contains pgn reader and the multithreaded pipeline that turns
+//              pgn files into training samples for an agent or shard files
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "agent.h"
+#include "book.h"
+#include "bounded_queue.h"
+#include <filesystem>
+#include <atomic>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const size_t PGN_BUFFER_SIZE = 1 << 20; // bytes read from a pgn file at a time
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// PGN READER
+// note: reads a pgn file in large blocks and returns the move text of each
+//       game, tag lines are skipped
+class PgnReader {
+public:
+	// constructor
+	PgnReader(const string &fileName, const size_t &bufferSize = PGN_BUFFER_SIZE) :
+		in_(fileName, ifstream::binary), buffer_(bufferSize > 0 ? bufferSize : 1), pos_(0), end_(0) {}
+
+	// methods
+	bool is_open   () const { return in_.is_open(); }
+	bool next_game (string &moveText); // returns false when there are no more games
+
+private:
+	// helpers
+	bool next_line (string &line); // returns false at end of file
+
+	ifstream     in_;
+	vector<char> buffer_;
+	size_t       pos_; // next unread char in buffer
+	size_t       end_; // end of valid chars in buffer
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// PGN READER functions
+////////////////////////////////////////
+// gets the next line from the buffer, refilling it from the file when empty
+bool PgnReader::next_line(string &line)
+{
+	line.clear();
+	while (true)
+	{
+		// refill buffer
+		if (pos_ == end_)
+		{
+			in_.read(buffer_.data(), buffer_.size());
+			pos_ = 0;
+			end_ = in_.gcount();
+
+			if (end_ == 0)
+				return !line.empty();
+		}
+
+		// look for end of line in what is left of the buffer
+		const char *begin = buffer_.data() + pos_;
+		const char *newLine = static_cast<const char *>(memchr(begin, '\n', end_ - pos_));
+		if (newLine)
+		{
+			line.append(begin, newLine);
+			pos_ += newLine - begin + 1;
+
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			return true;
+		}
+
+		// line continues past the buffer
+		line.append(begin, end_ - pos_);
+		pos_ = end_;
+	}
+}
+
+////////////////////////////////////////
+// finds the next game and joins its move text lines with spaces
+bool PgnReader::next_game(string &moveText)
+{
+	moveText.clear();
+
+	string line;
+	while (next_line(line))
+	{
+		// tag line, if move text has been read then the next game has started
+		if (!line.empty() && line[0] == '[')
+		{
+			if (!moveText.empty())
+				return true;
+		}
+		else if (!line.empty())
+			moveText += line + ' ';
+	}
+
+	return !moveText.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// PIPELINE functions
+////////////////////////////////////////
+// replays every game of every pgn file in directory. a reader thread feeds
+// games through a bounded queue to worker threads that replay them into
+// samples, consume is called with each game's samples on the calling thread
+// so it overlaps with replaying. returns number of games consumed
+template <class Consumer>
+size_t replay_directory(const Agent &agent, const string &directory, Consumer consume,
+						size_t workers = 0, const size_t &capacity = 64)
+{
+	if (!fs::is_directory(directory))
+	{
+		cout << "Couldn't find directory " << directory << endl;
+		return 0;
+	}
+
+	if (workers == 0)
+		workers = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1;
+
+	BoundedQueue<string> games(capacity);
+	BoundedQueue<GameSamples> samples(capacity);
+
+	// reader stage
+	std::thread reader([&] {
+		for (const auto &file : fs::directory_iterator(directory))
+		{
+			PgnReader pgn(file.path().string());
+			if (!pgn.is_open())
+			{
+				cout << "Couldn't open " << file.path() << endl;
+				continue;
+			}
+
+			string moveText;
+			while (pgn.next_game(moveText))
+				if (!games.push(moveText))
+					return;
+		}
+
+		games.close();
+	});
+
+	// replay stage
+	vector<std::thread> replayers;
+	std::atomic<size_t> running(workers);
+	for (size_t i = 0; i < workers; ++i)
+		replayers.push_back(std::thread([&] {
+			string moveText;
+			while (games.pop(moveText))
+				samples.push(agent.replay_game(moveText));
+
+			// last worker done closes the sample queue
+			if (--running == 0)
+				samples.close();
+		}));
+
+	// consume stage
+	size_t consumed = 0;
+	GameSamples steps;
+	while (samples.pop(steps))
+	{
+		consume(steps);
+		++consumed;
+	}
+
+	reader.join();
+	for (std::thread &replayer : replayers)
+		replayer.join();
+
+	return consumed;
+}
+
+////////////////////////////////////////
+// trains agent on every pgn file in directory, training overlaps with
+// replaying games. networks are saved and published to searches every
+// saveEvery games, copying the weights after each game would cost more
+// than training on it
+void train_from_directory(Agent &agent, const string &directory, const size_t &workers = 0,
+						  const size_t &capacity = 64, const size_t &saveEvery = 100)
+{
+	size_t trained = 0;
+	replay_directory(agent, directory, [&](const GameSamples &steps) {
+		agent.train_on_samples(steps);
+
+		if (++trained % saveEvery == 0)
+		{
+			agent.save();
+			agent.publish();
+		}
+	}, workers, capacity);
+	agent.save();
+	agent.publish();
+
+	cout << "Trained on " << trained << " games" << endl;
+}
+
+////////////////////////////////////////
+// replays every pgn file in directory once and writes the samples to binary
+// shards in outDirectory so training doesn't need to replay games again
+void preprocess_directory(const Agent &agent, const string &directory, const string &outDirectory,
+						  const size_t &samplesPerShard = SAMPLES_PER_SHARD, const size_t &workers = 0)
+{
+	ShardWriter writer(outDirectory, samplesPerShard);
+	size_t games = replay_directory(agent, directory, [&](const GameSamples &steps) {
+		for (const TrainingSample &sample : steps)
+			writer.write(sample);
+	}, workers);
+	writer.close();
+
+	cout << "Wrote " << writer.total() << " samples from " << games << " games to "
+		<< writer.shards() << " shards" << endl;
+}
+
+////////////////////////////////////////
+// adds the first maxPlies moves of every game in every pgn file in directory
+// to an opening book. moves by the side that went on to win count twice,
+// moves by the loser don't count. games without a result are skipped.
+// returns number of games added
+size_t build_book(const string &directory, const string &bookFile, const int &maxPlies = BOOK_MAX_PLIES,
+				  const uint32_t &minWeight = 2)
+{
+	if (!fs::is_directory(directory))
+	{
+		cout << "Couldn't find directory " << directory << endl;
+		return 0;
+	}
+
+	BookBuilder builder;
+	size_t games = 0;
+	for (const auto &file : fs::directory_iterator(directory))
+	{
+		PgnReader pgn(file.path().string());
+		string moveText;
+		while (pgn.next_game(moveText))
+		{
+			// weights depend on the result at the end of the move text
+			string_view text(moveText), token;
+			int result = 2; // not found
+			while (next_san_token(text, token))
+				if (is_game_result(token))
+				{
+					result = token == "1-0" ? 1 : token == "0-1" ? -1 : token == "*" ? 2 : 0;
+					break;
+				}
+			if (result == 2)
+				continue;
+
+			// only the opening is replayed
+			Board board;
+			text = moveText;
+			for (int ply = 0; ply < maxPlies && next_san_token(text, token) && !is_game_result(token); ++ply)
+			{
+				SanMove move;
+				Position current, desired;
+				char promotion;
+				if (!parse_san(token, move) || !resolve_move(board, board.to_move(), move, current, desired, promotion))
+					break;
+
+				int mover = board.to_move() == Color::White ? 1 : -1;
+				builder.add(board, current, desired, result == 0 ? 1 : result == mover ? 2 : 0);
+
+				board.make_move(current, desired, promotion);
+				board.update_move_set();
+			}
+			++games;
+		}
+	}
+
+	size_t written = builder.write(bookFile, minWeight);
+	cout << "Wrote " << written << " book moves from " << games << " games to " << bookFile << endl;
+
+	return games;
+}
+
+#endif // PGN_PIPELINE_H
@@ -15,7 +15,7 @@
 // prints out all moves
 void Piece::print_moves() const
 {
-	for (int i = 0; i < moves_.size(); ++i)
+	for (size_t i = 0; i < moves_.size(); ++i)
 	{
 		cout << i << ": ";
 		if (moves_[i].first == -1) // king side castle
@@ -71,6 +71,29 @@ void Piece::get_moves(Board &board, const vector<Position> &possibleMoves)
 		remove_check_moves(board, position_, possibleMoves, moves_);
 }
 
+////////////////////////////////////////
+// creates a piece from its letter representation
+Piece Piece::create(const char &rep, const Color &c, const Position &p, const bool &hasMoved)
+{
+	switch (rep)
+	{
+	case KING_REP:
+		return king(c, p, hasMoved);
+	case QUEEN_REP:
+		return queen(c, p, hasMoved);
+	case KNIGHT_REP:
+		return knight(c, p, hasMoved);
+	case BISHOP_REP:
+		return bishop(c, p, hasMoved);
+	case ROOK_REP:
+		return rook(c, p, hasMoved);
+	case PAWN_REP:
+		return pawn(c, p, hasMoved);
+	default:
+		return empty(c, p, hasMoved);
+	}
+}
+
 ////////////////////////////////////////
 // overloaded assignment
 Piece &Piece::operator=(const Piece &rhs)
@@ -420,23 +443,52 @@ vector<Position> Piece::pawn_get_possible_moves(const PieceList &pieces) const
 //
 // HELPER functions
 ////////////////////////////////////////
-// find function overload for PieceList to avoid creating many pointers
+// find function overload for PieceList, pieces are matched by position only
+// note: no shared search object so boards can be used from multiple threads
 PieceList::iterator find(PieceList &pieces, const Position &pos)
 {
-	// create one object to be used for searching
-	static Piece search(Color::Empty, EMPTY_REP, EMPTY_POINTS, Position(), false);
-	search.set_position(pos);
-	return find(pieces.begin(), pieces.end(), search);
+	return std::find_if(pieces.begin(), pieces.end(),
+						[&](const Piece &p) { return p.get_position() == pos; });
 }
 
 ////////////////////////////////////////
-// find function overload for PieceList to avoid creating many pointers
+// find function overload for PieceList, pieces are matched by position only
 PieceList::const_iterator cfind(const PieceList &pieces, const Position &pos)
 {
-	// create one object to be used for searching
-	static Piece search2(Color::Empty, EMPTY_REP, EMPTY_POINTS, Position(), false);
-	search2.set_position(pos);
-	return find(pieces.cbegin(), pieces.cend(), search2);
+	return std::find_if(pieces.cbegin(), pieces.cend(),
+						[&](const Piece &p) { return p.get_position() == pos; });
+}
+
+////////////////////////////////////////
+// code for packed boards, the code's low three bits index CODE_REPS
+uint8_t piece_code(const Piece &p)
+{
+	uint8_t code = 0;
+	switch (p.get_rep())
+	{
+	case PAWN_REP:
+		code = 1;
+		break;
+	case KING_REP:
+		code = 2;
+		break;
+	case QUEEN_REP:
+		code = 3;
+		break;
+	case KNIGHT_REP:
+		code = 4;
+		break;
+	case BISHOP_REP:
+		code = 5;
+		break;
+	case ROOK_REP:
+		code = 6;
+		break;
+	default:
+		return 0; // en passant markers aren't pieces
+	}
+
+	return p.get_color() == Color::Black ? code | 8 : code;
 }
 
 ////////////////////////////////////////
@@ -482,32 +534,11 @@ bool in_bounds(const int &i, const int &j)
 void remove_check_moves(Board &board, const Position &pos,
 						const vector<Position> &possibleMoves, vector<Position> &moves)
 {
-	// find piece color
-	Color color = cfind(board.get_pieces(), pos)->get_color();
-
 	// clear current move set
 	moves.clear();
 
+	// moves are tested on the boards attack maps, no board copies are made
 	for (const Position &p : possibleMoves)
-	{
-		// create a copy of current board
-		Board updated(board);
-
-		if ((p.first == -1 || p.first == -2) &&
-			updated.player_in_check(color)) // remove castling if in check
-			continue;
-
-		updated.make_move(pos, p);
-
-		// if move doesn't put player in check then add it to the final move list
-		if (!updated.player_in_check(color))
+		if (!board.leaves_king_attacked(pos, p))
 			moves.push_back(p);
-	}
-}
-
-////////////////////////////////////////
-// get distance between two positions, used in player_in_check func
-double distance(const Position &a, const Position &b)
-{
-	return sqrt(pow(a.first - b.first, 2.0) + pow(a.second - b.second, 2.0));
 }
\ No newline at end of file
@@ -16,6 +16,8 @@
 #include <limits>
 #include <algorithm>
 #include <new>
+#include <cmath>
+#include <cstdint>
 
 using std::cout; using std::endl; using std::cin;
 using std::vector;
@@ -35,6 +37,10 @@ const char KING_REP = 'K', QUEEN_REP = 'Q', KNIGHT_REP = 'N', BISHOP_REP = 'B',
 const double KING_POINTS = 0.0, QUEEN_POINTS = 8.0, KNIGHT_POINTS = 3.0, BISHOP_POINTS = 3.0,
 	ROOK_POINTS = 5.0, PAWN_POINTS = 1.0, EMPTY_POINTS = 0.0;
 
+// letter of each piece code, see piece_code
+const char CODE_REPS[8] = { EMPTY_REP, PAWN_REP, KING_REP, QUEEN_REP, KNIGHT_REP, BISHOP_REP, ROOK_REP, EMPTY_REP };
+const int PAWN_CODE = 1, KING_CODE = 2, QUEEN_CODE = 3, KNIGHT_CODE = 4, BISHOP_CODE = 5, ROOK_CODE = 6;
+
 // piece color enum, black and white MUST be listed first for use indexing arrays
 enum class Color { Black, White, Empty };
 
@@ -67,7 +73,7 @@ public:
 	Piece(const Color &color = Color::Empty, const char &rep = EMPTY_REP, 
 		  const double &points = 0, const Position &p = make_pair(0, 0), 
 		  const bool &hasMoved = false) :
-		color_(color), rep_(rep), points_(points), position_(p), hasMoved_(hasMoved) {}
+		position_(p), color_(color), rep_(rep), points_(points), hasMoved_(hasMoved) {}
 	Piece(const Piece &p) = default;
 
 	// methods
@@ -82,7 +88,7 @@ public:
 	void print_moves                    () const;
 	vector<Position> get_possible_moves (const PieceList &pieces) const; // creates list of possible moves
 	void get_moves                      (Board &board, const vector<Position> &possibleMoves = vector<Position>()); // create list of moves that wont put king in check
-	vector<Position> move_list          () const { return moves_; }
+	const vector<Position> &move_list   () const { return moves_; }
 
 	// operators
 	Piece &operator=(const Piece &rhs);
@@ -96,6 +102,7 @@ public:
 	static Piece rook   (const Color &c, const Position &p, const bool &hasMoved = false) { return Piece(c, ROOK_REP, ROOK_POINTS, p, hasMoved); }
 	static Piece pawn   (const Color &c, const Position &p, const bool &hasMoved = false) { return Piece(c, PAWN_REP, PAWN_POINTS, p, hasMoved); }
 	static Piece empty  (const Color &c, const Position &p, const bool &hasMoved = false) { return Piece(c, EMPTY_REP, EMPTY_POINTS, p, hasMoved); }
+	static Piece create (const char &rep, const Color &c, const Position &p, const bool &hasMoved = false); // creates piece from its letter
 
 protected:
 	// helpers
@@ -120,13 +127,18 @@ protected:
 //
 // HELPER functions
 ////////////////////////////////////////
-// find function overload for PieceList to avoid creating many pointers
+// find function overload for PieceList, pieces are matched by position only
 PieceList::iterator find(PieceList &pieces, const Position &pos);
 
 ////////////////////////////////////////
-// find function overload for PieceList to avoid creating many pointers
+// find function overload for PieceList, pieces are matched by position only
 PieceList::const_iterator cfind(const PieceList &pieces, const Position &pos);
 
+////////////////////////////////////////
+// code for packed boards, 0 for empty, 1-6 for white pawn, king, queen,
+// knight, bishop, rook and 9-14 for black
+uint8_t piece_code(const Piece &p);
+
 ////////////////////////////////////////
 // get weighted point value of tile
 double get_tile_value(const Position &pos);
@@ -144,8 +156,4 @@ bool in_bounds(const int &i, const int &j);
 void remove_check_moves(Board &board, const Position &pos,
 						const vector<Position> &possibleMoves, vector<Position> &moves);
 
-////////////////////////////////////////
-// get distance between two positions, used in player_in_check func
-double distance(const Position &a, const Position &b);
-
 #endif // PIECE_H
\ No newline at end of file
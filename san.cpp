@@ -0,0 +1,306 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        san.cpp
+// DESCRIPTION: contains standard and long algebraic notation move parsing
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "san.h"
+#include <cctype>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// parses san or lan into a move without looking at a board
+bool parse_san(string_view str, SanMove &move)
+{
+	move = SanMove{ PAWN_REP, -1, -1, Position(-1, -1), EMPTY_REP, 0 };
+
+	// remove check, mate and move quality annotations
+	while (!str.empty() && (str.back() == '+' || str.back() == '#' || str.back() == '!' || str.back() == '?'))
+		str.remove_suffix(1);
+
+	// en passant suffix
+	if (str.size() > 4 && str.substr(str.size() - 4) == "e.p.")
+		str.remove_suffix(4);
+
+	// castling, some records use zeros
+	if (str == "O-O" || str == "0-0")
+	{
+		move.castle_ = 1;
+		return true;
+	}
+	if (str == "O-O-O" || str == "0-0-0")
+	{
+		move.castle_ = 2;
+		return true;
+	}
+
+	// promotion piece at the end, lan uses lower case
+	if (str.size() > 2)
+	{
+		char last = toupper((unsigned char)str.back());
+		if (last == QUEEN_REP || last == ROOK_REP || last == BISHOP_REP || last == KNIGHT_REP)
+		{
+			move.promotion_ = last;
+			str.remove_suffix(1);
+
+			if (str.back() == '=')
+				str.remove_suffix(1);
+		}
+	}
+
+	// destination square is always last
+	if (str.size() < 2)
+		return false;
+	char file = str[str.size() - 2], rank = str[str.size() - 1];
+	if (file < 'a' || file > 'h' || rank < '1' || rank > '8')
+		return false;
+	move.to_ = Position(rank - '1', file - 'a');
+	str.remove_suffix(2);
+
+	// capture or lan seperator
+	if (!str.empty() && (str.back() == 'x' || str.back() == ':' || str.back() == '-'))
+		str.remove_suffix(1);
+
+	// piece letter, pawns don't have one
+	if (!str.empty() && (str[0] == KING_REP || str[0] == QUEEN_REP || str[0] == ROOK_REP ||
+						 str[0] == BISHOP_REP || str[0] == KNIGHT_REP))
+	{
+		move.rep_ = str[0];
+		str.remove_prefix(1);
+	}
+
+	// anything left is the starting file and/or row
+	if (str.size() > 2)
+		return false;
+	for (const char &c : str)
+	{
+		if (c >= 'a' && c <= 'h' && move.fromCol_ == -1 && move.fromRow_ == -1)
+			move.fromCol_ = c - 'a';
+		else if (c >= '1' && c <= '8' && move.fromRow_ == -1)
+			move.fromRow_ = c - '1';
+		else
+			return false;
+	}
+
+	// only pawns promote
+	return move.promotion_ == EMPTY_REP || move.rep_ == PAWN_REP;
+}
+
+////////////////////////////////////////
+// finds the board move for a parsed move
+bool resolve_move(const Board &board, const Color &color, const SanMove &move,
+				  Position &current, Position &desired, char &promotion)
+{
+	const PieceList &pieces = board.get_pieces();
+	promotion = move.promotion_ != EMPTY_REP ? move.promotion_ : QUEEN_REP;
+
+	// checks that piece at current can make desired
+	auto legal = [&]() {
+		auto it = cfind(pieces, current);
+		if (it == pieces.end() || it->get_color() != color || it->get_rep() == EMPTY_REP)
+			return false;
+
+		const vector<Position> &moves = it->move_list();
+		return std::find(moves.begin(), moves.end(), desired) != moves.end();
+	};
+
+	char rep = move.rep_;
+	int castle = move.castle_;
+
+	// lan gives the full starting square, the piece there is what moves
+	if (move.fromRow_ != -1 && move.fromCol_ != -1 && castle == 0)
+	{
+		auto it = cfind(pieces, Position(move.fromRow_, move.fromCol_));
+		if (it == pieces.end() || it->get_color() != color || it->get_rep() == EMPTY_REP)
+			return false;
+		rep = it->get_rep();
+
+		// lan castling is written as the king moving two columns
+		if (rep == KING_REP && move.to_.first == move.fromRow_ && abs(move.to_.second - move.fromCol_) == 2)
+			castle = move.to_.second > move.fromCol_ ? 1 : 2;
+	}
+
+	// castling
+	if (castle != 0)
+	{
+		current = board.get_king_pos(color);
+		desired = castle == 1 ? Position(-1, -1) : Position(-2, -2);
+		return legal();
+	}
+
+	// pawns, a move along the file is a push otherwise it is a capture
+	if (rep == PAWN_REP)
+	{
+		int dir = color == Color::White ? 1 : -1;
+		int fromCol = move.fromCol_ != -1 ? move.fromCol_ : move.to_.second;
+
+		if (fromCol == move.to_.second)
+		{
+			current = Position(move.to_.first - dir, fromCol);
+			desired = move.to_;
+
+			// jump if no pawn is right behind the destination
+			auto it = cfind(pieces, current);
+			if (it == pieces.end() || it->get_rep() == EMPTY_REP)
+			{
+				current = Position(move.to_.first - 2 * dir, fromCol);
+				desired = Position(-3, fromCol);
+			}
+		}
+		else
+		{
+			current = Position(move.to_.first - dir, fromCol);
+			desired = move.to_;
+
+			// capturing onto the opponents jump marker is en passant
+			auto it = cfind(pieces, move.to_);
+			if (it != pieces.end() && it->get_rep() == EMPTY_REP && it->get_color() != color)
+				desired = Position(-4, move.to_.second);
+		}
+
+		if (move.fromRow_ != -1 && move.fromRow_ != current.first)
+			return false;
+
+		return legal();
+	}
+
+	// other pieces must attack the destination, attacks are symmetric so
+	// look from the destination for pieces of the right type
+	Bitboard attackers = piece_attacks(rep, color, square_of(move.to_), board.occupancy());
+	int found = 0;
+	desired = move.to_;
+	for (const Piece &p : pieces)
+	{
+		Position pos = p.get_position();
+		if (p.get_rep() != rep || p.get_color() != color ||
+			!(attackers & square_bit(square_of(pos))) ||
+			(move.fromRow_ != -1 && move.fromRow_ != pos.first) ||
+			(move.fromCol_ != -1 && move.fromCol_ != pos.second))
+			continue;
+
+		const vector<Position> &moves = p.move_list();
+		if (std::find(moves.begin(), moves.end(), desired) != moves.end())
+		{
+			current = pos;
+			++found;
+		}
+	}
+
+	return found == 1;
+}
+
+////////////////////////////////////////
+// checks if str is a game result
+bool is_game_result(string_view str)
+{
+	return str == "1-0" || str == "0-1" || str == "1/2-1/2" || str == "*";
+}
+
+////////////////////////////////////////
+// pulls the next move or result out of pgn move text
+bool next_san_token(string_view &text, string_view &token)
+{
+	while (!text.empty())
+	{
+		char c = text[0];
+
+		// whitespace
+		if (isspace((unsigned char)c))
+		{
+			text.remove_prefix(1);
+			continue;
+		}
+
+		// comments
+		if (c == '{' || c == ';')
+		{
+			size_t end = text.find(c == '{' ? '}' : '\n');
+			text.remove_prefix(end == string_view::npos ? text.size() : end + 1);
+			continue;
+		}
+
+		// variations, can be nested
+		if (c == '(')
+		{
+			size_t i = 0;
+			for (int depth = 0; i < text.size(); ++i)
+			{
+				if (text[i] == '(')
+					++depth;
+				else if (text[i] == ')' && --depth == 0)
+					break;
+			}
+			text.remove_prefix(i < text.size() ? i + 1 : text.size());
+			continue;
+		}
+
+		// token runs until whitespace or the start of a comment or variation
+		size_t end = 0;
+		while (end < text.size() && !isspace((unsigned char)text[end]) &&
+			   text[end] != '{' && text[end] != '(' && text[end] != ';')
+			++end;
+		token = text.substr(0, end);
+		text.remove_prefix(end);
+
+		// numeric annotation or en passant written apart from its move
+		if (token[0] == '$' || token == "e.p.")
+			continue;
+
+		// move number, may be attached to the move ex: 12.e4 or 12...Nf6
+		size_t digits = 0;
+		while (digits < token.size() && isdigit((unsigned char)token[digits]))
+			++digits;
+		if (digits < token.size() && token[digits] == '.')
+		{
+			while (digits < token.size() && token[digits] == '.')
+				++digits;
+			token.remove_prefix(digits);
+		}
+
+		if (!token.empty())
+			return true;
+	}
+
+	return false;
+}
+
+////////////////////////////////////////
+// square a move ends on, special moves store their destination in the encoding
+Position move_destination(const Position &current, const Position &desired, const Color &color)
+{
+	int dir = color == Color::White ? 1 : -1;
+
+	if (desired == Position(-1, -1))
+		return Position(current.first, current.second + 2);
+	else if (desired == Position(-2, -2))
+		return Position(current.first, current.second - 2);
+	else if (desired.first == -3)
+		return Position(current.first + 2 * dir, desired.second);
+	else if (desired.first == -4)
+		return Position(current.first + dir, desired.second);
+
+	return desired;
+}
+
+////////////////////////////////////////
+// writes a board move as lan
+string move_to_lan(const Board &board, const Position &current, const Position &desired,
+				   const char &promotion)
+{
+	auto it = cfind(board.get_pieces(), current);
+	if (it == board.get_pieces().end())
+		return "0000";
+	Position to = move_destination(current, desired, it->get_color());
+
+	string lan = { char('a' + current.second), char('1' + current.first),
+				   char('a' + to.second), char('1' + to.first) };
+
+	// pawns reaching the last row promote
+	if (it->get_rep() == PAWN_REP && (to.first == 0 || to.first == SIZE - 1))
+		lan += char(tolower((unsigned char)promotion));
+
+	return lan;
+}
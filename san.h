@@ -0,0 +1,62 @@
+#ifndef SAN_H
+#define SAN_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        san.h
+// DESCRIPTION: contains standard and long algebraic notation move parsing
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "board.h"
+#include <string_view>
+
+using std::string_view;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SAN MOVE
+// note: a move as written in a game record, parsed without looking at a board.
+//       fromRow_ and fromCol_ are -1 when not given
+struct SanMove {
+	char rep_;       // piece moved, pawns are PAWN_REP
+	int fromRow_;
+	int fromCol_;
+	Position to_;
+	char promotion_; // EMPTY_REP if not given
+	int castle_;     // 0 = not castling, 1 = king side, 2 = queen side
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// parses san (Nbd7, exd8=Q+, O-O) or lan (e2e4, e7e8q, Ng1-f3), annotations
+// like + # ! ? are ignored. returns false if str isn't a move
+bool parse_san(string_view str, SanMove &move);
+
+////////////////////////////////////////
+// finds the board move for a parsed move using attack tables, only legal moves
+// are accepted. returns false if no move or more than one move matches
+bool resolve_move(const Board &board, const Color &color, const SanMove &move,
+				  Position &current, Position &desired, char &promotion);
+
+////////////////////////////////////////
+// checks if str is a game result, 1-0, 0-1, 1/2-1/2 or *
+bool is_game_result(string_view str);
+
+////////////////////////////////////////
+// pulls the next move or result out of pgn move text, skipping move numbers,
+// comments, variations and numeric annotations. returns false at end of text
+bool next_san_token(string_view &text, string_view &token);
+
+////////////////////////////////////////
+// square a move ends on, decodes castling, pawn jump and en passant moves
+Position move_destination(const Position &current, const Position &desired, const Color &color);
+
+////////////////////////////////////////
+// writes a board move as lan (e2e4, e1g1, e7e8q), the way uci expects moves
+string move_to_lan(const Board &board, const Position &current, const Position &desired,
+				   const char &promotion = QUEEN_REP);
+
+#endif // SAN_H
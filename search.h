@@ -0,0 +1,333 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        search.h
+// DESCRIPTION: contains min max result type and the search info shared between
+//              a running search and the thread controlling it
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "piece.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <iomanip>
+#include <memory>
+
+// forward declarations
+class TranspositionTable;
+class Tablebases;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// NODE
+// note: return type for min_max function
+struct Node {
+	Node(const double &value = 0, const Position &cur = Position(), const Position &des = Position(),
+		 const char &promotion = QUEEN_REP) :
+		value_(value), current_(cur), desired_(des), promotion_(promotion) {}
+
+	// for algorithms
+	bool operator<(const Node &rhs) const { return value_ < rhs.value_; }
+	bool same_move(const Node &rhs) const {
+		return current_ == rhs.current_ && desired_ == rhs.desired_ && promotion_ == rhs.promotion_;
+	}
+
+	double value_;
+	Position current_;
+	Position desired_;
+	char promotion_; // piece a pawn reaching the last row becomes
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const int MAX_PLY = 64; // deepest line a principal variation is kept for
+const size_t POLICY_CACHE_ENTRIES = 1 << 12; // positions a search keeps the policy's move order for
+const char PROMOTIONS[] = { QUEEN_REP, KNIGHT_REP, ROOK_REP, BISHOP_REP }; // queen first, it's almost always best
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// number of PROMOTIONS a move is searched with, pawns reaching the last row
+// can become any of them, other moves only use the first
+inline int promotion_choices(const Piece &piece, const Position &desired)
+{
+	return piece.get_rep() == PAWN_REP && (desired.first == 0 || desired.first == SIZE - 1) ? int(sizeof(PROMOTIONS)) : 1;
+}
+
+////////////////////////////////////////
+// milliseconds on a steady clock, for search timing
+inline int64_t now_ms()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// DEPTH STATS
+// note: totals of every root search made to one depth
+struct DepthStats {
+	int      searches_ = 0;
+	uint64_t nodes_ = 0;
+	int64_t  ms_ = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SEARCH STATS
+// note: counted by one search thread without locking, searches on other
+//       threads keep their own and are added together once they finish
+struct SearchStats {
+	uint64_t nodes_ = 0; // every node entered, there is no quiescence stage so
+	                     // depth 0 leaves are counted here and there are no qnodes
+	uint64_t evals_ = 0; // leaf evaluations by the favor function or favor net
+	uint64_t networkCalls_ = 0; // forward passes of the favor and policy nets
+	uint64_t tableProbes_ = 0;
+	uint64_t tableHits_ = 0; // probes that found the position
+	uint64_t tableCutoffs_ = 0; // hits whose value was used without searching
+	uint64_t tablebaseHits_ = 0;
+	uint64_t cutoffs_ = 0; // nodes where a move was good enough to stop searching
+	uint64_t firstMoveCutoffs_ = 0; // cutoffs made by the first move searched
+	uint64_t policyCacheHits_ = 0; // positions whose moves were ordered without the policy net
+	vector<DepthStats> depths_; // index is depth - 1
+
+	// methods
+	void clear () { *this = SearchStats(); }
+	void record_depth (const int &depth, const uint64_t &nodes, const int64_t &ms) {
+		if (depth < 1)
+			return;
+		if (int(depths_.size()) < depth)
+			depths_.resize(depth);
+
+		++depths_[depth - 1].searches_;
+		depths_[depth - 1].nodes_ += nodes;
+		depths_[depth - 1].ms_ += ms;
+	}
+	double table_hit_rate () const { return tableProbes_ ? double(tableHits_) / tableProbes_ : 0.0; }
+	double first_move_cutoff_rate () const { return cutoffs_ ? double(firstMoveCutoffs_) / cutoffs_ : 0.0; }
+	std::string to_json () const;
+
+	// operators
+	SearchStats &operator+=(const SearchStats &rhs);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// POLICY CACHE
+// note: legal moves of a position in policy order with their probabilities,
+//       found by zobrist hash so transpositions and later iterations don't
+//       run the policy net again. one slot per index, newer positions
+//       replace older ones. not thread safe, each search keeps its own
+class PolicyCache {
+public:
+	// constructor, slots are allocated by the first store
+	PolicyCache(const size_t &entries = POLICY_CACHE_ENTRIES) : entries_(entries > 0 ? entries : 1) {}
+
+	// methods
+	bool probe (const uint64_t &key, vector<Node> &moves) const {
+		if (slots_.empty())
+			return false;
+
+		const Slot &slot = slots_[key % entries_];
+		if (slot.key_ != key || slot.moves_.empty())
+			return false;
+
+		moves = slot.moves_;
+		return true;
+	}
+	void store (const uint64_t &key, const vector<Node> &moves) {
+		if (slots_.empty())
+			slots_.resize(entries_);
+
+		Slot &slot = slots_[key % entries_];
+		slot.key_ = key;
+		slot.moves_ = moves;
+	}
+	void clear () { slots_.clear(); } // needed once the policy net's weights change
+
+private:
+	struct Slot {
+		uint64_t     key_ = 0;
+		vector<Node> moves_; // empty if the slot was never used
+	};
+
+	size_t       entries_;
+	vector<Slot> slots_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SEARCH INFO
+// note: passed to min_max to count nodes, collect the principal variation and
+//       let another thread stop the search. once stopped, min_max unwinds
+//       right away and the value it returns should not be used. table_,
+//       tablebases_ and policies_ are kept by reset so results carry over
+//       between searches
+struct SearchInfo {
+	SearchInfo(TranspositionTable *table = nullptr, Tablebases *tablebases = nullptr) :
+		stop_(false), deadline_(0), table_(table), tablebases_(tablebases), rootDepth_(0) { pvLength_[0] = 0; }
+
+	// methods
+	void reset() {
+		stop_ = false;
+		stats_.clear();
+		deadline_ = 0;
+		rootDepth_ = 0;
+		pvLength_[0] = 0;
+	}
+
+	// checks stop flag and deadline, 0 deadline = no time limit
+	bool should_stop() {
+		if (stop_.load(std::memory_order_relaxed))
+			return true;
+
+		int64_t deadline = deadline_.load(std::memory_order_relaxed);
+		if (deadline != 0 && now_ms() >= deadline)
+			stop_ = true;
+
+		return stop_.load(std::memory_order_relaxed);
+	}
+
+	// called at the start of a node, ply is how far the node is from the root
+	void enter(const int &ply) {
+		++stats_.nodes_;
+		if (ply < MAX_PLY)
+			pvLength_[ply] = ply;
+	}
+
+	// best move at ply changed, its line is the move followed by the line below it
+	void update_pv(const int &ply, const Node &move) {
+		if (ply >= MAX_PLY)
+			return;
+
+		pv_[ply][ply] = move;
+		int length = ply + 1;
+		if (ply + 1 < MAX_PLY)
+			for (; length < pvLength_[ply + 1]; ++length)
+				pv_[ply][length] = pv_[ply + 1][length];
+		pvLength_[ply] = length;
+	}
+
+	std::atomic<bool>     stop_;
+	SearchStats           stats_; // only the searching thread may touch these while it runs
+	std::atomic<int64_t>  deadline_; // now_ms time the search must stop by, 0 if none
+	TranspositionTable   *table_; // nullptr to search without one
+	Tablebases           *tablebases_; // nullptr to search endgames without tables
+	PolicyCache           policies_; // move order of positions the agent searched
+	int  rootDepth_; // depth of the current iteration, ply = rootDepth_ - depth
+	Node pv_[MAX_PLY][MAX_PLY]; // triangular table, pv_[0] holds the line from the root
+	int  pvLength_[MAX_PLY];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ROOT INFO
+// note: search info of one root search, its own when the search was given
+//       none so plies are still counted from the root and repetitions below
+//       it are scored as draws
+class RootInfo {
+public:
+	// constructors
+	RootInfo(SearchInfo *info) : info_(info ? info : (local_ = std::make_unique<SearchInfo>()).get()) {}
+	RootInfo(const RootInfo &) = delete;
+
+	SearchInfo *get() const { return info_; }
+
+private:
+	std::unique_ptr<SearchInfo> local_;
+	SearchInfo                 *info_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// DEPTH TIMER
+// note: adds the nodes and time of one root search to infos stats when it
+//       goes out of scope, so every way out of the search is counted
+class DepthTimer {
+public:
+	// constructors
+	DepthTimer(SearchInfo *info, const int &depth) :
+		info_(info), depth_(depth), nodes_(info ? info->stats_.nodes_ : 0), start_(now_ms()) {}
+	DepthTimer(const DepthTimer &) = delete;
+	~DepthTimer() {
+		if (info_)
+			info_->stats_.record_depth(depth_, info_->stats_.nodes_ - nodes_, now_ms() - start_);
+	}
+
+private:
+	SearchInfo *info_;
+	int         depth_;
+	uint64_t    nodes_;
+	int64_t     start_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SEARCH STATS functions
+////////////////////////////////////////
+// adds counts of a search made on another thread, depths are matched up
+inline SearchStats &SearchStats::operator+=(const SearchStats &rhs)
+{
+	nodes_ += rhs.nodes_;
+	evals_ += rhs.evals_;
+	networkCalls_ += rhs.networkCalls_;
+	tableProbes_ += rhs.tableProbes_;
+	tableHits_ += rhs.tableHits_;
+	tableCutoffs_ += rhs.tableCutoffs_;
+	tablebaseHits_ += rhs.tablebaseHits_;
+	cutoffs_ += rhs.cutoffs_;
+	firstMoveCutoffs_ += rhs.firstMoveCutoffs_;
+	policyCacheHits_ += rhs.policyCacheHits_;
+
+	if (depths_.size() < rhs.depths_.size())
+		depths_.resize(rhs.depths_.size());
+	for (size_t i = 0; i < rhs.depths_.size(); ++i)
+	{
+		depths_[i].searches_ += rhs.depths_[i].searches_;
+		depths_[i].nodes_ += rhs.depths_[i].nodes_;
+		depths_[i].ms_ += rhs.depths_[i].ms_;
+	}
+
+	return *this;
+}
+
+////////////////////////////////////////
+// one line json object of every count, depths only lists depths searched
+inline std::string SearchStats::to_json() const
+{
+	std::ostringstream json;
+	json << std::fixed << std::setprecision(4)
+		<< "{\"nodes\":" << nodes_
+		<< ",\"evals\":" << evals_
+		<< ",\"network_calls\":" << networkCalls_
+		<< ",\"tt_probes\":" << tableProbes_
+		<< ",\"tt_hits\":" << tableHits_
+		<< ",\"tt_cutoffs\":" << tableCutoffs_
+		<< ",\"tt_hit_rate\":" << table_hit_rate()
+		<< ",\"tablebase_hits\":" << tablebaseHits_
+		<< ",\"cutoffs\":" << cutoffs_
+		<< ",\"first_move_cutoffs\":" << firstMoveCutoffs_
+		<< ",\"first_move_cutoff_rate\":" << first_move_cutoff_rate()
+		<< ",\"policy_cache_hits\":" << policyCacheHits_
+		<< ",\"depths\":[";
+
+	bool first = true;
+	for (size_t i = 0; i < depths_.size(); ++i)
+		if (depths_[i].searches_ > 0)
+		{
+			json << (first ? "" : ",") << "{\"depth\":" << i + 1 << ",\"searches\":" << depths_[i].searches_
+				<< ",\"nodes\":" << depths_[i].nodes_ << ",\"ms\":" << depths_[i].ms_ << "}";
+			first = false;
+		}
+	json << "]}";
+
+	return json.str();
+}
+
+#endif // SEARCH_H
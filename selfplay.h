@@ -0,0 +1,177 @@
+#ifndef SELFPLAY_H
+#define SELFPLAY_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        selfplay.h
+// DESCRIPTION: contains self play generator that plays the agent against itself
+//              on many threads and writes the positions to training shards
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "agent.h"
+#include "bounded_queue.h"
+#include <atomic>
+#include <random>
+#include <thread>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const int SELF_PLAY_MAX_PLIES = 400; // games this long end as draws
+const size_t SELF_PLAY_TABLE_MB = 4; // table size of each thread
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SELF PLAY OPTIONS
+// note: temperature is in favor buckets, moves are sampled with weight
+//       exp((score - best) / temperature) for the first temperaturePlies_
+//       plies and the best move is played after that
+struct SelfPlayOptions {
+	int      games_ = 100;
+	int      depth_ = 2;
+	int      moves_ = 8; // root moves the policy net picks
+	double   temperature_ = 1.0;
+	int      temperaturePlies_ = 30;
+	size_t   threads_ = 0; // 0 uses every core
+	size_t   samplesPerShard_ = SAMPLES_PER_SHARD;
+	unsigned seed_ = 0; // game i is seeded with seed_ + i so it can be replayed
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// plays one game of agent against itself, samples hold the search score of
+// each position and the final position gets the winning bonus like replayed games
+GameSamples play_self_play_game(const Agent &agent, TranspositionTable &table, const SelfPlayOptions &options,
+								std::mt19937 &generator)
+{
+	Board board;
+	GameSamples samples;
+	table.clear();
+
+	int8_t result = 0;
+	double winningBonus = 0;
+	for (int ply = 0; ply < SELF_PLAY_MAX_PLIES; ++ply)
+	{
+		Color color = board.to_move();
+		int outcome = board.end_game(color);
+		if (outcome == 1)
+		{
+			result = color == Color::White ? -1 : 1;
+			winningBonus = result * 10.0;
+			break;
+		}
+		else if (outcome == 2)
+			break;
+
+		SearchInfo info(&table);
+		vector<Node> scores = agent.score_moves(board, color, options.depth_, options.moves_, &info);
+
+		// scores from the side to moves view, mates are worth one bucket past the ends
+		vector<double> view(scores.size());
+		size_t best = 0;
+		for (size_t i = 0; i < scores.size(); ++i)
+		{
+			double value = std::min(std::max(scores[i].value_, -1.0), double(BUCKETS));
+			view[i] = color == Color::White ? value : -value;
+			if (view[i] > view[best])
+				best = i;
+		}
+
+		// sample early moves so games differ
+		size_t chosen = best;
+		if (ply < options.temperaturePlies_ && options.temperature_ > 0)
+		{
+			vector<double> weights(view.size());
+			for (size_t i = 0; i < view.size(); ++i)
+				weights[i] = exp((view[i] - view[best]) / options.temperature_);
+
+			std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+			chosen = pick(generator);
+		}
+
+		// position is stored with the value and move of the best move, the
+		// sampled move is only played
+		TrainingSample sample = TrainingSample();
+		pack_board(board, sample.board_);
+		double bucket = std::min(std::max(scores[best].value_, 0.0), double(BUCKETS - 1));
+		sample.favor_ = float(index_to_favor(size_t(bucket)));
+		const Node &target = scores[best];
+		sample.policy_ = uint16_t(get_move_index(*cfind(board.get_pieces(), target.current_), target.desired_, target.promotion_));
+		samples.push_back(sample);
+
+		const Node &move = scores[chosen];
+		board.make_move(move.current_, move.desired_, move.promotion_);
+		board.update_move_set();
+	}
+
+	TrainingSample last = TrainingSample();
+	pack_board(board, last.board_);
+	last.favor_ = float(board.favor() + winningBonus);
+	last.policy_ = NO_POLICY;
+	samples.push_back(last);
+
+	for (TrainingSample &sample : samples)
+		sample.result_ = result;
+
+	return samples;
+}
+
+////////////////////////////////////////
+// plays games on worker threads that share the agent, each with its own
+// table. finished games are passed through a bounded queue and written to
+// shards in outDirectory on the calling thread. returns number of games written
+size_t self_play(const Agent &agent, const string &outDirectory, const SelfPlayOptions &options = SelfPlayOptions())
+{
+	size_t workers = options.threads_;
+	if (workers == 0)
+		workers = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+
+	BoundedQueue<GameSamples> games(workers * 2);
+
+	// play stage
+	vector<std::thread> players;
+	std::atomic<int> next(0);
+	std::atomic<size_t> running(workers);
+	for (size_t i = 0; i < workers; ++i)
+		players.push_back(std::thread([&] {
+			TranspositionTable table(SELF_PLAY_TABLE_MB);
+			for (int game = next++; game < options.games_; game = next++)
+			{
+				std::mt19937 generator(options.seed_ + game);
+				if (!games.push(play_self_play_game(agent, table, options, generator)))
+					break;
+			}
+
+			// last worker done closes the queue
+			if (--running == 0)
+				games.close();
+		}));
+
+	// write stage
+	ShardWriter writer(outDirectory, options.samplesPerShard_);
+	size_t written = 0;
+	GameSamples samples;
+	while (games.pop(samples))
+	{
+		for (const TrainingSample &sample : samples)
+			writer.write(sample);
+
+		++written;
+		cout << "Game " << written << "/" << options.games_ << ": " << samples.size() << " positions, "
+			<< (samples.back().result_ == 1 ? "1-0" : samples.back().result_ == -1 ? "0-1" : "1/2-1/2") << endl;
+	}
+	writer.close();
+
+	for (std::thread &player : players)
+		player.join();
+
+	cout << "Wrote " << writer.total() << " samples from " << written << " games to "
+		<< writer.shards() << " shards" << endl;
+
+	return written;
+}
+
+#endif // SELFPLAY_H
@@ -0,0 +1,257 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        shard.h
+// DESCRIPTION: contains packed training samples and the binary shard files
+//              they are stored in once pgn files have been preprocessed
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "board.h"
+#include "network_utility.h"
+#include "mapped_file.h"
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <filesystem>
+#include <random>
+#include <iomanip>
+#include <sstream>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const char SHARD_MAGIC[4] = { 'C', 'E', 'S', 'H' };
+const uint32_t SHARD_VERSION = 2; // 2 stores policy targets as move indexes, see get_move_index
+const size_t SAMPLES_PER_SHARD = 1 << 20; // default shard size, about 40MB
+const uint16_t NO_POLICY = 0xFFFF; // sample has no move played, ex: final position
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TRAINING SAMPLE
+// note: board_ holds the piece code of each square, two squares per byte with
+//       the lower board index in the low nibble
+struct TrainingSample {
+	uint8_t  board_[SIZE * SIZE / 2];
+	float    favor_;   // discounted favor target
+	uint16_t policy_;  // policy target index, NO_POLICY if none
+	int8_t   result_;  // 1 = white won, -1 = black won, 0 = draw or unknown
+	uint8_t  padding_;
+};
+
+static_assert(sizeof(TrainingSample) == 40, "training samples are stored packed in shard files");
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SHARD HEADER
+// note: shard files are this header followed by count_ training samples
+struct ShardHeader {
+	char     magic_[4];
+	uint32_t version_;
+	uint64_t count_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SHARD WRITER
+// note: appends samples to numbered shard files in a directory, a new shard is
+//       started every samplesPerShard samples
+class ShardWriter {
+public:
+	// constructor
+	ShardWriter(const string &directory, const size_t &samplesPerShard = SAMPLES_PER_SHARD) :
+		directory_(directory), samplesPerShard_(samplesPerShard > 0 ? samplesPerShard : 1),
+		count_(0), shards_(0), total_(0) {}
+	~ShardWriter() { close(); }
+
+	// methods
+	void write    (const TrainingSample &sample);
+	void close    (); // finishes current shard
+	size_t shards () const { return shards_; }
+	size_t total  () const { return total_; }
+
+private:
+	ofstream out_;
+	string   directory_;
+	size_t   samplesPerShard_;
+	size_t   count_;  // samples in current shard
+	size_t   shards_; // shards started
+	size_t   total_;  // samples written
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SHARD READER
+// note: streams every sample in a directory of shards once per epoch in a
+//       random order, shards are visited in shuffled order and each memory
+//       mapped shard is read through a shuffled index
+class ShardReader {
+public:
+	// constructor
+	ShardReader(const string &directory, const unsigned &seed = std::random_device()());
+
+	// methods
+	bool next     (TrainingSample &sample); // returns false at the end of an epoch
+	void reset    (); // starts a new epoch with a new shuffle
+	size_t shards () const { return files_.size(); }
+
+private:
+	// helpers
+	bool open_shard (const string &fileName); // returns false if file isn't a valid shard
+
+	vector<string>   files_;
+	size_t           file_; // next shard to open
+	MappedFile       current_;
+	vector<uint32_t> order_; // shuffled sample indices of current shard
+	size_t           pos_;
+	std::mt19937     generator_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// packs the pieces on a board, two squares per byte
+void pack_board(const Board &board, uint8_t packed[SIZE * SIZE / 2])
+{
+	memset(packed, 0, SIZE * SIZE / 2);
+	for (const Piece &p : board.get_pieces())
+	{
+		int square = square_of(p.get_position());
+		packed[square / 2] |= piece_code(p) << (square % 2 * 4);
+	}
+}
+
+////////////////////////////////////////
+// creates the network input for a packed board, same layout as create_board_state
+SparseInput unpack_board_state(const uint8_t packed[SIZE * SIZE / 2], const size_t &inputSize)
+{
+	SparseInput state(inputSize);
+	for (int square = 0; square < SIZE * SIZE; ++square)
+	{
+		uint8_t code = (packed[square / 2] >> (square % 2 * 4)) & 0xF;
+		if (code != 0)
+			state.add(square * 6 + (code & 7) - 1, code & 8 ? -1.0 : 1.0);
+	}
+
+	return state;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SHARD WRITER functions
+////////////////////////////////////////
+// appends sample, starting a new shard if needed
+void ShardWriter::write(const TrainingSample &sample)
+{
+	if (!out_.is_open() || count_ == samplesPerShard_)
+	{
+		close();
+
+		// shard files are numbered in the order they are written
+		std::filesystem::create_directories(directory_);
+		std::ostringstream name;
+		name << "shard_" << std::setw(5) << std::setfill('0') << shards_ << ".bin";
+		out_.open((std::filesystem::path(directory_) / name.str()).string(), ofstream::binary);
+
+		// count is filled in when the shard is closed
+		ShardHeader header = { { SHARD_MAGIC[0], SHARD_MAGIC[1], SHARD_MAGIC[2], SHARD_MAGIC[3] }, SHARD_VERSION, 0 };
+		out_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+		count_ = 0;
+		++shards_;
+	}
+
+	out_.write(reinterpret_cast<const char *>(&sample), sizeof(sample));
+	++count_;
+	++total_;
+}
+
+////////////////////////////////////////
+// writes sample count into the header and closes the shard
+void ShardWriter::close()
+{
+	if (!out_.is_open())
+		return;
+
+	uint64_t count = count_;
+	out_.seekp(offsetof(ShardHeader, count_));
+	out_.write(reinterpret_cast<const char *>(&count), sizeof(count));
+	out_.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SHARD READER functions
+////////////////////////////////////////
+// finds all shard files in directory
+ShardReader::ShardReader(const string &directory, const unsigned &seed) :
+	file_(0), pos_(0), generator_(seed)
+{
+	if (std::filesystem::is_directory(directory))
+		for (const auto &file : std::filesystem::directory_iterator(directory))
+			if (file.path().extension() == ".bin")
+				files_.push_back(file.path().string());
+
+	reset();
+}
+
+////////////////////////////////////////
+// starts a new epoch with shards in a new random order
+void ShardReader::reset()
+{
+	std::shuffle(files_.begin(), files_.end(), generator_);
+	file_ = 0;
+	pos_ = 0;
+	order_.clear();
+	current_.close();
+}
+
+////////////////////////////////////////
+// maps shard and shuffles the order its samples are read in
+bool ShardReader::open_shard(const string &fileName)
+{
+	order_.clear();
+	pos_ = 0;
+
+	current_ = MappedFile(fileName);
+	if (!current_.is_open() || current_.size() < sizeof(ShardHeader))
+		return false;
+
+	ShardHeader header;
+	memcpy(&header, current_.data(), sizeof(header));
+	if (memcmp(header.magic_, SHARD_MAGIC, sizeof(SHARD_MAGIC)) != 0 ||
+		header.version_ != SHARD_VERSION ||
+		current_.size() < sizeof(ShardHeader) + header.count_ * sizeof(TrainingSample))
+	{
+		cout << "Skipping invalid shard " << fileName << endl;
+		return false;
+	}
+
+	order_.resize(header.count_);
+	for (uint32_t i = 0; i < order_.size(); ++i)
+		order_[i] = i;
+	std::shuffle(order_.begin(), order_.end(), generator_);
+
+	return true;
+}
+
+////////////////////////////////////////
+// gets next sample, opening the next shard when the current one is used up
+bool ShardReader::next(TrainingSample &sample)
+{
+	while (pos_ == order_.size())
+	{
+		if (file_ == files_.size())
+			return false;
+
+		open_shard(files_[file_++]);
+	}
+
+	memcpy(&sample, current_.data() + sizeof(ShardHeader) + size_t(order_[pos_++]) * sizeof(TrainingSample), sizeof(sample));
+	return true;
+}
+
+#endif // SHARD_H
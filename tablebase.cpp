@@ -0,0 +1,1097 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        tablebase.cpp
+// DESCRIPTION: contains syzygy table reading, position numbering and probing
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "tablebase.h"
+#include <filesystem>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+// numbers of three unique leading pieces, by which of them is the first off
+// the a1 h8 diagonal, then with all three on it
+const uint64_t FIRST_OFF_DIAGONAL = 6 * 63 * 62, SECOND_OFF_DIAGONAL = 4 * 28 * 62,
+			   THIRD_OFF_DIAGONAL = 4 * 7 * 28, ALL_ON_DIAGONAL = 4 * 7 * 6;
+const uint64_t UNIQUE_PLACEMENTS = FIRST_OFF_DIAGONAL + SECOND_OFF_DIAGONAL + THIRD_OFF_DIAGONAL + ALL_ON_DIAGONAL;
+const uint64_t KING_PLACEMENTS = 462;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SYZYGY SQUARES
+// note: numberings of squares and piece placements the tables are made
+//       with. squares are board indices, a1 = 0 and h8 = 63
+struct SyzygySquares {
+	SyzygySquares();
+
+	int      triangle_[SIZE * SIZE]; // a1 d1 d4 triangle as 0 to 9 with the diagonal last, -1 elsewhere
+	int      belowDiagonal_[SIZE * SIZE]; // squares below the a1 h8 diagonal as 0 to 27, -1 elsewhere
+	int      kings_[10][SIZE * SIZE]; // king pairs by the first kings triangle number, -1 if they can't be
+	int      pawnOrder_[SIZE * SIZE]; // a2 to h7 as 47 down to 0, edge files and lower rows first
+	uint64_t choose_[TABLEBASE_MAX_PIECES][SIZE * SIZE + 1]; // ways to pick k of n squares
+	uint64_t leadStart_[TABLEBASE_MAX_PIECES][SIZE * SIZE]; // first number of k leading pawns, the highest on a square
+	uint64_t leadPlacements_[TABLEBASE_MAX_PIECES][4]; // numbers of k leading pawns with the highest on a file
+};
+
+// square helpers
+inline int file_of(const int &square) { return square & 7; }
+inline int rank_of(const int &square) { return square >> 3; }
+inline int diagonal_side(const int &square) { return rank_of(square) - file_of(square); } // above a1 h8 when positive
+inline int transpose(const int &square) { return file_of(square) * SIZE + rank_of(square); } // mirrored in a1 h8
+
+////////////////////////////////////////
+// builds every numbering
+SyzygySquares::SyzygySquares()
+{
+	std::fill(&triangle_[0], &triangle_[0] + SIZE * SIZE, -1);
+	std::fill(&belowDiagonal_[0], &belowDiagonal_[0] + SIZE * SIZE, -1);
+	std::fill(&kings_[0][0], &kings_[0][0] + 10 * SIZE * SIZE, -1);
+	std::fill(&pawnOrder_[0], &pawnOrder_[0] + SIZE * SIZE, -1);
+
+	int number = 0;
+	for (int s = 0; s < SIZE * SIZE; ++s)
+		if (diagonal_side(s) < 0)
+			belowDiagonal_[s] = number++;
+
+	// b1, c1, d1, c2, d2 and d3, then a1, b2, c3 and d4
+	int corner[10];
+	number = 0;
+	for (int onDiagonal = 0; onDiagonal < 2; ++onDiagonal)
+		for (int s = 0; s < SIZE * SIZE; ++s)
+			if (file_of(s) <= 3 && rank_of(s) <= file_of(s) && (diagonal_side(s) == 0) == bool(onDiagonal))
+			{
+				corner[number] = s;
+				triangle_[s] = number++;
+			}
+
+	// kings can't touch, and when the first is on the diagonal the second
+	// isn't above it. pairs with both on the diagonal are numbered last
+	number = 0;
+	for (int bothOnDiagonal = 0; bothOnDiagonal < 2; ++bothOnDiagonal)
+		for (int t = 0; t < 10; ++t)
+			for (int s = 0; s < SIZE * SIZE; ++s)
+			{
+				int first = corner[t];
+				if (std::abs(rank_of(first) - rank_of(s)) <= 1 && std::abs(file_of(first) - file_of(s)) <= 1)
+					continue;
+				if (diagonal_side(first) == 0 && diagonal_side(s) > 0)
+					continue;
+				if ((diagonal_side(first) == 0 && diagonal_side(s) == 0) == bool(bothOnDiagonal))
+					kings_[t][s] = number++;
+			}
+
+	for (int n = 0; n <= SIZE * SIZE; ++n)
+		for (int k = 0; k < TABLEBASE_MAX_PIECES; ++k)
+			choose_[k][n] = k == 0 ? 1 : n == 0 ? 0 : choose_[k - 1][n - 1] + choose_[k][n - 1];
+
+	number = 47;
+	for (int f = 0; f < 4; ++f)
+		for (int r = 1; r < SIZE - 1; ++r)
+		{
+			pawnOrder_[r * SIZE + f] = number--;
+			pawnOrder_[r * SIZE + SIZE - 1 - f] = number--;
+		}
+
+	// other leading pawns are numbered below the highest one
+	for (int k = 1; k < TABLEBASE_MAX_PIECES; ++k)
+		for (int f = 0; f < 4; ++f)
+		{
+			uint64_t total = 0;
+			for (int r = 1; r < SIZE - 1; ++r)
+			{
+				leadStart_[k][r * SIZE + f] = total;
+				total += choose_[k - 1][pawnOrder_[r * SIZE + f]];
+			}
+			leadPlacements_[k][f] = total;
+		}
+}
+
+const SyzygySquares SQUARES;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// little and big endian numbers in a table file
+inline uint32_t read_le(const uint8_t *data, const int &bytes)
+{
+	uint32_t n = 0;
+	for (int i = bytes - 1; i >= 0; --i)
+		n = n << 8 | data[i];
+	return n;
+}
+
+inline uint64_t read_be(const uint8_t *data, const int &bytes)
+{
+	uint64_t n = 0;
+	for (int i = 0; i < bytes; ++i)
+		n = n << 8 | data[i];
+	return n;
+}
+
+////////////////////////////////////////
+// halves of a symbol, a right half of 0xFFF makes the left half a value
+inline int symbol_left(const SyzygySubTable &d, const int &symbol)
+{
+	const uint8_t *s = d.symbols_ + 3 * symbol;
+	return (s[1] & 0xF) << 8 | s[0];
+}
+
+inline int symbol_right(const SyzygySubTable &d, const int &symbol)
+{
+	const uint8_t *s = d.symbols_ + 3 * symbol;
+	return s[2] << 4 | s[1] >> 4;
+}
+
+////////////////////////////////////////
+// syzygy code of a piece, pawn 1 to king 6 and black adds 8
+int syzygy_code(const Piece &p)
+{
+	int code = 0;
+	switch (p.get_rep())
+	{
+	case PAWN_REP:   code = 1; break;
+	case KNIGHT_REP: code = 2; break;
+	case BISHOP_REP: code = 3; break;
+	case ROOK_REP:   code = 4; break;
+	case QUEEN_REP:  code = 5; break;
+	case KING_REP:   code = 6; break;
+	}
+
+	return p.get_color() == Color::Black ? code + 8 : code;
+}
+
+////////////////////////////////////////
+// material of color as a syzygy name part, KQR for king queen and rook
+string syzygy_material(const Board &board, const Color &color)
+{
+	string material = "K";
+	for (char rep : { QUEEN_REP, ROOK_REP, BISHOP_REP, KNIGHT_REP, PAWN_REP })
+		material.append(board.material(color, rep), rep);
+
+	return material;
+}
+
+////////////////////////////////////////
+// plies to zeroing of a position with result wdl whose best move is a
+// capture or pawn move
+int zeroing_dtz(const int &wdl)
+{
+	return wdl == 2 ? 1 : wdl == 1 ? 101 : wdl == -1 ? -101 : wdl == -2 ? -1 : 0;
+}
+
+inline int sign_of(const int &n) { return (n > 0) - (n < 0); }
+
+////////////////////////////////////////
+// insertion sort of a few squares, tables have at most TABLEBASE_MAX_PIECES
+template<typename Order = std::less<int>>
+void sort_squares(int *first, int *last, Order order = Order())
+{
+	for (int *i = first + 1; i < last; ++i)
+		for (int *j = i; j > first && order(*j, *(j - 1)); --j)
+			std::swap(*j, *(j - 1));
+}
+
+////////////////////////////////////////
+// calls visit with every legal move of the side to move until it returns
+// false, pawns reaching the last row once for each promotion
+template<typename Visit>
+void for_each_move(const Board &board, Visit visit)
+{
+	Color color = board.to_move();
+	for (const Piece &p : board.get_pieces())
+		if (p.get_color() == color)
+			for (const Position &move : p.move_list())
+				for (int i = 0; i < promotion_choices(p, move); ++i)
+					if (!visit(p, move, PROMOTIONS[i]))
+						return;
+}
+
+////////////////////////////////////////
+// move takes a piece, en passant included
+bool is_capture(const Board &board, const Piece &p, const Position &move)
+{
+	if (move.first == -4)
+		return true;
+
+	Color other = p.get_color() == Color::White ? Color::Black : Color::White;
+	return move.first >= 0 && (board.occupancy(other) & square_bit(square_of(move)));
+}
+
+////////////////////////////////////////
+// splits a sub tables pieces into groups and finds what each groups number
+// is multiplied by. three unique pieces or the kings lead pawnless tables
+// and the leading pawns lead pawn tables, the other pieces are grouped with
+// alike pieces next to them. leadAt and pawnsAt are where the leading group
+// and the other sides pawns come in the order of multiplying, the other
+// groups fill the remaining places in turn. false if they don't fit
+bool set_groups(const SyzygyTable &e, SyzygySubTable &d, const int &leadAt, const int &pawnsAt, const int &file)
+{
+	int leading = e.hasPawns_ ? 1 : e.uniquePieces_ ? 3 : 2;
+	d.groups_ = 0;
+	for (int i = 0; i < e.pieceCount_; ++i)
+		if (i > 0 && (i < leading || d.pieces_[i] == d.pieces_[i - 1]))
+			++d.groupSize_[d.groups_ - 1];
+		else
+			d.groupSize_[d.groups_++] = 1;
+
+	int grouped = 0;
+	for (int g = 0; g < d.groups_; ++g)
+		grouped += d.groupSize_[g];
+	if (grouped != e.pieceCount_ || grouped > TABLEBASE_MAX_PIECES || d.groupSize_[0] >= TABLEBASE_MAX_PIECES ||
+		(e.bothPawns_ && d.groups_ < 2))
+		return false;
+
+	// placements of each group, later groups skip the squares of earlier ones
+	uint64_t placements[TABLEBASE_MAX_PIECES];
+	int free = SIZE * SIZE - d.groupSize_[0] - (e.bothPawns_ ? d.groupSize_[1] : 0);
+	for (int g = 0; g < d.groups_; ++g)
+		if (g == 0)
+			placements[g] = e.hasPawns_ ? SQUARES.leadPlacements_[d.groupSize_[0]][file] :
+				e.uniquePieces_ ? UNIQUE_PLACEMENTS : KING_PLACEMENTS;
+		else if (g == 1 && e.bothPawns_)
+			placements[g] = SQUARES.choose_[d.groupSize_[1]][48 - d.groupSize_[0]];
+		else
+		{
+			placements[g] = SQUARES.choose_[d.groupSize_[g]][free];
+			free -= d.groupSize_[g];
+		}
+
+	int order[TABLEBASE_MAX_PIECES];
+	std::fill(order, order + d.groups_, -1);
+	if (leadAt >= d.groups_ || (e.bothPawns_ && (pawnsAt >= d.groups_ || pawnsAt == leadAt)))
+		return false;
+	order[leadAt] = 0;
+	if (e.bothPawns_)
+		order[pawnsAt] = 1;
+	for (int k = 0, next = e.bothPawns_ ? 2 : 1; k < d.groups_; ++k)
+		if (order[k] < 0)
+			order[k] = next++;
+
+	uint64_t factor = 1;
+	for (int k = 0; k < d.groups_; ++k)
+	{
+		d.groupFactor_[order[k]] = factor;
+		factor *= placements[order[k]];
+	}
+	d.positions_ = factor;
+	return true;
+}
+
+////////////////////////////////////////
+// values symbol stands for, a pair adds up its halves. false if the
+// symbols don't form a tree
+bool set_runs(SyzygySubTable &d, const int &symbol, vector<uint8_t> &state)
+{
+	if (state[symbol] == 2)
+		return true;
+	if (state[symbol] == 1) // reached itself
+		return false;
+	state[symbol] = 1;
+
+	int left = symbol_left(d, symbol), right = symbol_right(d, symbol);
+	if (right == 0xFFF)
+		d.runs_[symbol] = 1;
+	else
+	{
+		if (left >= int(d.runs_.size()) || right >= int(d.runs_.size()) ||
+			!set_runs(d, left, state) || !set_runs(d, right, state))
+			return false;
+
+		uint64_t run = uint64_t(d.runs_[left]) + d.runs_[right];
+		if (run > UINT32_MAX)
+			return false;
+		d.runs_[symbol] = uint32_t(run);
+	}
+
+	state[symbol] = 2;
+	return true;
+}
+
+////////////////////////////////////////
+// reads how a sub tables values are coded, returns where the next sub
+// table's coding starts or nullptr if it runs past end
+const uint8_t *read_coding(SyzygySubTable &d, const uint8_t *data, const uint8_t *end)
+{
+	if (end - data < 2)
+		return nullptr;
+	d.flags_ = *data++;
+	if (d.flags_ & SingleValue)
+	{
+		d.constant_ = *data++;
+		return data;
+	}
+
+	// block size, span between index entries, index padding, blocks, and
+	// the longest and shortest code
+	if (end - data < 9 || data[0] >= 32 || data[1] >= 32)
+		return nullptr;
+	d.blockBytes_ = uint64_t(1) << data[0];
+	d.span_ = uint64_t(1) << data[1];
+	d.spans_ = size_t((d.positions_ + d.span_ - 1) / d.span_);
+	d.blocks_ = read_le(data + 3, 4);
+	d.blockEntries_ = size_t(d.blocks_) + data[2];
+	int longest = data[7];
+	d.shortest_ = data[8];
+	data += 9;
+	if (d.shortest_ == 0 || longest < d.shortest_ || longest > 32)
+		return nullptr;
+
+	// the longest codes count up from 0 and the codes of each shorter
+	// length follow on from the codes one bit longer
+	int lengths = longest - d.shortest_ + 1;
+	if (end - data < 2 * lengths + 2)
+		return nullptr;
+	d.firstSymbol_ = data;
+	d.firstCode_.assign(lengths, 0);
+	for (int i = lengths - 2; i >= 0; --i)
+	{
+		uint32_t symbol = read_le(data + 2 * i, 2), longer = read_le(data + 2 * (i + 1), 2);
+		if (symbol < longer)
+			return nullptr;
+		d.firstCode_[i] = (d.firstCode_[i + 1] + symbol - longer) / 2;
+	}
+	for (int i = 0; i < lengths; ++i)
+		d.firstCode_[i] <<= 64 - d.shortest_ - i;
+	data += 2 * lengths;
+
+	int symbols = int(read_le(data, 2));
+	data += 2;
+	if (end - data < 3 * symbols + (symbols & 1))
+		return nullptr;
+	d.symbols_ = data;
+	d.runs_.assign(symbols, 0);
+
+	vector<uint8_t> state(symbols, 0);
+	for (int s = 0; s < symbols; ++s)
+		if (!set_runs(d, s, state))
+			return nullptr;
+
+	return data + 3 * symbols + (symbols & 1);
+}
+
+////////////////////////////////////////
+// number of three unique leading pieces, after they're moved so the first
+// is on the a1 d1 d4 triangle and the first off the diagonal is below it
+uint64_t unique_number(const int squares[3])
+{
+	int skip1 = squares[1] > squares[0];
+	int skip2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+
+	// squares taken by earlier pieces are skipped, pieces on the diagonal are
+	// numbered by their row
+	if (diagonal_side(squares[0]))
+		return (uint64_t(SQUARES.triangle_[squares[0]]) * 63 + squares[1] - skip1) * 62 + squares[2] - skip2;
+	if (diagonal_side(squares[1]))
+		return FIRST_OFF_DIAGONAL +
+			(uint64_t(rank_of(squares[0])) * 28 + SQUARES.belowDiagonal_[squares[1]]) * 62 + squares[2] - skip2;
+	if (diagonal_side(squares[2]))
+		return FIRST_OFF_DIAGONAL + SECOND_OFF_DIAGONAL +
+			(uint64_t(rank_of(squares[0])) * 7 + rank_of(squares[1]) - skip1) * 28 + SQUARES.belowDiagonal_[squares[2]];
+
+	return FIRST_OFF_DIAGONAL + SECOND_OFF_DIAGONAL + THIRD_OFF_DIAGONAL +
+		(uint64_t(rank_of(squares[0])) * 7 + rank_of(squares[1]) - skip1) * 6 + rank_of(squares[2]) - skip2;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SYZYGY SUB TABLE functions
+////////////////////////////////////////
+// value of position idx
+int SyzygySubTable::value(const uint64_t &idx) const
+{
+	if (flags_ & SingleValue)
+		return constant_;
+
+	// each index entry gives the block holding the middle value of its span
+	// and where in the block that value is, blocks are stepped over from there
+	const uint8_t *entry = spanIndex_ + 6 * (idx / span_);
+	uint32_t block = read_le(entry, 4);
+	int64_t at = int64_t(read_le(entry + 4, 2)) + int64_t(idx % span_) - int64_t(span_ / 2);
+	auto values = [this](const uint32_t &b) { return int64_t(read_le(blockValues_ + 2 * b, 2)) + 1; };
+
+	while (at < 0)
+		at += values(--block);
+	while (at >= values(block))
+		at -= values(block++);
+
+	// codes are read from the start of the block, bits holds the next of
+	// them left aligned and is topped up while it has half or less
+	const uint8_t *next = blockData_ + block * blockBytes_;
+	uint64_t bits = read_be(next, 8);
+	next += 8;
+	int held = 64, symbol = 0;
+	while (true)
+	{
+		int length = 0;
+		while (bits < firstCode_[length])
+			++length;
+
+		int codeBits = shortest_ + length;
+		symbol = int((bits - firstCode_[length]) >> (64 - codeBits)) + int(read_le(firstSymbol_ + 2 * length, 2));
+		if (at < runs_[symbol])
+			break;
+
+		at -= runs_[symbol];
+		bits <<= codeBits;
+		held -= codeBits;
+		if (held <= 32)
+		{
+			bits |= read_be(next, 4) << (32 - held);
+			next += 4;
+			held += 32;
+		}
+	}
+
+	// then the halves holding at are followed down to a value
+	while (symbol_right(*this, symbol) != 0xFFF)
+	{
+		int left = symbol_left(*this, symbol);
+		if (at < runs_[left])
+			symbol = left;
+		else
+		{
+			at -= runs_[left];
+			symbol = symbol_right(*this, symbol);
+		}
+	}
+
+	return symbol_left(*this, symbol);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SYZYGY TABLE functions
+////////////////////////////////////////
+// constructor, material is the file name without its extension
+SyzygyTable::SyzygyTable(const string &fileName, const string &material, const bool &dtz) :
+	fileName_(fileName), dtz_(dtz), lastUsed_(0), invalid_(false)
+{
+	size_t v = material.find('v');
+	string sides[2] = { material.substr(0, v), material.substr(v + 1) };
+
+	pieceCount_ = int(material.size()) - 1;
+	int pawns[2] = { int(std::count(sides[0].begin(), sides[0].end(), PAWN_REP)),
+					 int(std::count(sides[1].begin(), sides[1].end(), PAWN_REP)) };
+	hasPawns_ = pawns[0] + pawns[1] > 0;
+	bothPawns_ = pawns[0] > 0 && pawns[1] > 0;
+	symmetric_ = sides[0] == sides[1];
+
+	uniquePieces_ = false;
+	for (const string &side : sides)
+		for (char rep : { QUEEN_REP, ROOK_REP, BISHOP_REP, KNIGHT_REP, PAWN_REP })
+			if (std::count(side.begin(), side.end(), rep) == 1)
+				uniquePieces_ = true;
+}
+
+////////////////////////////////////////
+// maps the file and finds every sub table in it, nullptr if the file isn't
+// the table its name says
+std::shared_ptr<const SyzygyMapping> SyzygyTable::read() const
+{
+	std::shared_ptr<SyzygyMapping> m = std::make_shared<SyzygyMapping>();
+	m->file_ = MappedFile(fileName_);
+	if (!m->file_.is_open() || m->file_.size() < 5 || memcmp(m->file_.data(), SYZYGY_MAGIC[dtz_], 4) != 0)
+		return nullptr;
+
+	const uint8_t *base = reinterpret_cast<const uint8_t *>(m->file_.data()), *end = base + m->file_.size();
+	auto align = [base](const uint8_t *data, const size_t &to) { return data + (to - size_t(data - base) % to) % to; };
+
+	const uint8_t *data = read_layout(base + 4, end, *m);
+	if (!data)
+		return nullptr;
+	data = align(data, 2);
+
+	// every part is stored for all sub tables before the next part, files
+	// first and then sides to move
+	for (int f = 0; f < files(); ++f)
+		for (int side = 0; side < sides(); ++side)
+			if (!(data = read_coding(sub(*m, side, f), data, end)))
+				return nullptr;
+
+	// dtz tables can map stored values to plies for each result
+	if (dtz_)
+	{
+		m->dtzMap_ = data;
+		for (int f = 0; f < files(); ++f)
+		{
+			SyzygySubTable &d = sub(*m, 0, f);
+			if (!(d.flags_ & Mapped))
+				continue;
+
+			int width = d.flags_ & WideMap ? 2 : 1;
+			if (width == 2)
+				data = align(data, 2);
+			for (int result = 0; result < 4; ++result)
+			{
+				if (end - data < width)
+					return nullptr;
+				size_t count = read_le(data, width);
+				d.dtzMap_[result] = size_t(data - m->dtzMap_) + width;
+				data += width * (count + 1);
+			}
+		}
+		data = align(data, 2);
+	}
+
+	// offsets from here on can be past the end of a broken file, so they're
+	// checked before returning
+	uint64_t at = uint64_t(data - base);
+	for (int f = 0; f < files(); ++f)
+		for (int side = 0; side < sides(); ++side)
+		{
+			SyzygySubTable &d = sub(*m, side, f);
+			d.spanIndex_ = base + min(at, uint64_t(end - base));
+			at += 6 * uint64_t(d.spans_);
+		}
+
+	for (int f = 0; f < files(); ++f)
+		for (int side = 0; side < sides(); ++side)
+		{
+			SyzygySubTable &d = sub(*m, side, f);
+			d.blockValues_ = base + min(at, uint64_t(end - base));
+			at += 2 * uint64_t(d.blockEntries_);
+		}
+
+	for (int f = 0; f < files(); ++f)
+		for (int side = 0; side < sides(); ++side)
+		{
+			SyzygySubTable &d = sub(*m, side, f);
+			at += (64 - at % 64) % 64;
+			d.blockData_ = base + min(at, uint64_t(end - base));
+			at += uint64_t(d.blocks_) * d.blockBytes_;
+		}
+
+	return at <= uint64_t(end - base) ? m : nullptr;
+}
+
+////////////////////////////////////////
+// reads the file flags and the order each sub table numbers pieces in,
+// returns where the value codings start or nullptr if the file doesn't
+// match the table's material
+const uint8_t *SyzygyTable::read_layout(const uint8_t *data, const uint8_t *end, SyzygyMapping &m) const
+{
+	if (pieceCount_ < 3 || pieceCount_ > TABLEBASE_MAX_PIECES || end - data < 1 || bool(*data & HasPawns) != hasPawns_ ||
+		(!dtz_ && bool(*data & SplitSides) != (sides() == 2)))
+		return nullptr;
+	++data;
+
+	// for each file a byte with where the leading group is multiplied, a
+	// second one for the other sides pawns when both sides have pawns, then
+	// the pieces. the first side to move is in the low bits
+	int placeBytes = bothPawns_ ? 2 : 1;
+	for (int f = 0; f < files(); ++f)
+	{
+		if (end - data < placeBytes + pieceCount_)
+			return nullptr;
+
+		for (int side = 0; side < sides(); ++side)
+		{
+			SyzygySubTable &d = sub(m, side, f);
+			int shift = side ? 4 : 0;
+			for (int i = 0; i < pieceCount_; ++i)
+				d.pieces_[i] = data[placeBytes + i] >> shift & 0xF;
+
+			if (!set_groups(*this, d, data[0] >> shift & 0xF, bothPawns_ ? data[1] >> shift & 0xF : -1, f))
+				return nullptr;
+		}
+		data += placeBytes + pieceCount_;
+	}
+
+	return data;
+}
+
+////////////////////////////////////////
+// number of the position with syzygy piece codes on each square, side and
+// file are set to the sub table holding it. returns UINT64_MAX if the
+// pieces aren't the tables
+uint64_t SyzygyTable::index(const SyzygyMapping &m, const int codes[SIZE * SIZE], const bool &blackToMove,
+							const bool &blackStronger, int &side, int &file) const
+{
+	// tables are made with the side named first as white and symmetric ones
+	// only with white to move, other positions swap colors and turn the
+	// board over
+	bool swap = blackStronger || (symmetric_ && blackToMove);
+	side = swap != blackToMove;
+	file = 0;
+
+	int squares[TABLEBASE_MAX_PIECES], pieces[TABLEBASE_MAX_PIECES], count = 0;
+	for (int s = 0; s < SIZE * SIZE; ++s)
+		if (codes[s])
+		{
+			if (count == pieceCount_)
+				return UINT64_MAX;
+			squares[count] = swap ? s ^ 56 : s;
+			pieces[count++] = swap ? codes[s] ^ 8 : codes[s];
+		}
+	if (count != pieceCount_)
+		return UINT64_MAX;
+
+	// the leading pawns are the first pieces of every sub table, the one
+	// numbered highest picks the file
+	auto pawn_order = [](const int &lhs, const int &rhs) { return SQUARES.pawnOrder_[lhs] < SQUARES.pawnOrder_[rhs]; };
+	int leading = 0;
+	if (hasPawns_)
+	{
+		int lead = sub(m, 0, 0).pieces_[0];
+		for (int i = 0; i < count; ++i)
+			if (pieces[i] == lead)
+			{
+				std::swap(squares[i], squares[leading]);
+				std::swap(pieces[i], pieces[leading++]);
+			}
+		if (!leading)
+			return UINT64_MAX;
+
+		std::swap(squares[0], *std::max_element(squares, squares + leading, pawn_order));
+		file = min(file_of(squares[0]), SIZE - 1 - file_of(squares[0]));
+	}
+
+	// the other pieces in the order the sub table numbers them
+	const SyzygySubTable &d = sub(m, side, file);
+	for (int i = leading; i < count; ++i)
+	{
+		int j = i;
+		while (j < count && pieces[j] != d.pieces_[i])
+			++j;
+		if (j == count)
+			return UINT64_MAX;
+
+		std::swap(squares[i], squares[j]);
+		std::swap(pieces[i], pieces[j]);
+	}
+
+	// the first piece is moved onto files a to d, and in pawnless tables
+	// onto rows 1 to 4 with the first leading piece off the diagonal below it
+	if (file_of(squares[0]) > 3)
+		for (int i = 0; i < count; ++i)
+			squares[i] ^= 7;
+
+	uint64_t idx = 0;
+	if (hasPawns_)
+	{
+		sort_squares(squares + 1, squares + leading, pawn_order);
+		idx = SQUARES.leadStart_[leading][squares[0]];
+		for (int i = 1; i < leading; ++i)
+			idx += SQUARES.choose_[i][SQUARES.pawnOrder_[squares[i]]];
+	}
+	else
+	{
+		if (rank_of(squares[0]) > 3)
+			for (int i = 0; i < count; ++i)
+				squares[i] ^= 56;
+
+		for (int i = 0; i < d.groupSize_[0]; ++i)
+			if (diagonal_side(squares[i]))
+			{
+				if (diagonal_side(squares[i]) > 0)
+					for (int j = i; j < count; ++j)
+						squares[j] = transpose(squares[j]);
+				break;
+			}
+
+		if (uniquePieces_)
+			idx = unique_number(squares);
+		else if (SQUARES.kings_[SQUARES.triangle_[squares[0]]][squares[1]] >= 0)
+			idx = SQUARES.kings_[SQUARES.triangle_[squares[0]]][squares[1]];
+		else
+			return UINT64_MAX;
+	}
+	idx *= d.groupFactor_[0];
+
+	// every other group picks its squares from the ones earlier groups left,
+	// the other sides pawns only from rows 2 to 7
+	int first = d.groupSize_[0];
+	for (int g = 1; g < d.groups_; ++g)
+	{
+		int size = d.groupSize_[g], below = g == 1 && bothPawns_ ? SIZE : 0;
+		sort_squares(squares + first, squares + first + size);
+
+		uint64_t number = 0;
+		for (int i = 0; i < size; ++i)
+		{
+			int s = squares[first + i];
+			int taken = int(std::count_if(squares, squares + first, [s](const int &t) { return t < s; }));
+			number += SQUARES.choose_[i + 1][s - taken - below];
+		}
+
+		idx += number * d.groupFactor_[g];
+		first += size;
+	}
+
+	return idx;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TABLEBASES functions
+////////////////////////////////////////
+// finds the tables in directory, files are named like KQvKR.rtbw and
+// KQvKR.rtbz. the tables of the last directory are closed
+void Tablebases::set_directory(const string &directory)
+{
+	open_.clear();
+	wdl_.clear();
+	dtz_.clear();
+	largest_ = 0;
+
+	std::error_code error;
+	if (directory.empty() || !std::filesystem::is_directory(directory, error))
+		return;
+
+	for (const auto &entry : std::filesystem::directory_iterator(directory, error))
+	{
+		string extension = entry.path().extension().string(), material = entry.path().stem().string();
+		if (extension != ".rtbw" && extension != ".rtbz")
+			continue;
+
+		// both sides have one king first, then queens, rooks, bishops, knights and pawns
+		size_t v = material.find('v');
+		if (v == string::npos || material.size() > size_t(TABLEBASE_MAX_PIECES) + 1)
+			continue;
+
+		bool valid = true;
+		for (const string &side : { material.substr(0, v), material.substr(v + 1) })
+			valid = valid && !side.empty() && side[0] == KING_REP && side.find_first_not_of("QRBNP", 1) == string::npos;
+		if (!valid)
+			continue;
+
+		bool dtz = extension == ".rtbz";
+		(dtz ? dtz_ : wdl_)[material].reset(new SyzygyTable(entry.path().string(), material, dtz));
+		if (!dtz)
+			largest_ = max(largest_, int(material.size()) - 1);
+	}
+}
+
+////////////////////////////////////////
+// looks up position if it has few enough pieces and no castling rights.
+// the board ends games by the fifty move rule so wins and losses it
+// would draw are draws
+bool Tablebases::probe(const Board &board, TablebaseResult &result)
+{
+	int wdl = 0;
+	bool zeroingBest = false;
+	if (!probable(board) || !search_wdl(board, false, wdl, zeroingBest))
+		return false;
+
+	result = TablebaseResult();
+	result.wdl_ = wdl == 2 ? 1 : wdl == -2 ? -1 : 0;
+	return true;
+}
+
+////////////////////////////////////////
+// plies to the next capture or pawn move of the winning side, negative when
+// the side to move loses and 0 for draws. wins and losses the fifty move
+// rule would draw are 100 plies further
+bool Tablebases::probe_dtz(const Board &board, int &plies)
+{
+	return probable(board) && search_dtz(board, plies);
+}
+
+////////////////////////////////////////
+// finds the move that wins with the fewest plies to the next capture or pawn
+// move, draws, or loses with the most. wins and losses the fifty move rule
+// would draw by the time they're reached are draws. returns false if a
+// position after a move isn't in a table
+bool Tablebases::probe_root(const Board &board, Node &move, TablebaseResult &result)
+{
+	if (!probable(board))
+		return false;
+
+	// higher rank is better for the side to move
+	auto rank = [](const TablebaseResult &r) { return r.wdl_ > 0 ? 1024 - r.plies_ : r.wdl_ < 0 ? r.plies_ - 1024 : 0; };
+
+	int clock = board.halfmove_clock();
+	bool found = false, missing = false;
+	for_each_move(board, [&](const Piece &p, const Position &des, const char &promotion) {
+		Board update(board);
+		update.make_move(p.get_position(), des, promotion);
+		update.update_move_set();
+
+		// dtz counted from the root, zeroing moves start the count again
+		int plies = 0, wdl = 0, outcome = update.end_game(update.to_move());
+		bool zeroingBest = false;
+		if (outcome == 1)
+			plies = 1;
+		else if (outcome == 2)
+			plies = 0;
+		else if (update.halfmove_clock() == 0)
+		{
+			missing = !search_wdl(update, false, wdl, zeroingBest);
+			plies = zeroing_dtz(-wdl);
+		}
+		else
+		{
+			missing = !search_dtz(update, plies);
+			plies = -plies;
+			plies += sign_of(plies);
+		}
+		if (missing)
+			return false;
+
+		TablebaseResult after;
+		after.wdl_ = std::abs(plies) + clock <= 100 ? sign_of(plies) : 0;
+		after.plies_ = after.wdl_ != 0 ? std::abs(plies) : 0;
+		if (!found || rank(after) > rank(result))
+		{
+			result = after;
+			move = Node(0.0, p.get_position(), des, promotion);
+			found = true;
+		}
+
+		return true;
+	});
+
+	return found && !missing;
+}
+
+////////////////////////////////////////
+// few enough pieces for the tables found and no castling rights
+bool Tablebases::probable(const Board &board) const
+{
+	int count = board.piece_count();
+	return count >= 2 && count <= pieces() && board.castling_rights() == 0;
+}
+
+////////////////////////////////////////
+// result of the side to move, -2 = loss, -1 = loss the fifty move rule
+// draws, 0 = draw, 1 = win the fifty move rule draws, 2 = win. tables
+// leave out what happens after captures, so captures are searched first
+// and pawn moves too when pawnMoves. zeroingBest is set when one of those
+// wins or is at least as good as a win the table gives
+bool Tablebases::search_wdl(const Board &board, const bool &pawnMoves, int &wdl, bool &zeroingBest)
+{
+	int best = -2, moves = 0, searched = 0;
+	bool missing = false;
+	for_each_move(board, [&](const Piece &p, const Position &des, const char &promotion) {
+		++moves;
+		if (!is_capture(board, p, des) && (!pawnMoves || p.get_rep() != PAWN_REP))
+			return true;
+		++searched;
+
+		Board update(board);
+		update.make_move(p.get_position(), des, promotion);
+		update.update_move_set();
+
+		int reply = 0;
+		bool replyZeroing = false;
+		missing = !search_wdl(update, false, reply, replyZeroing);
+		best = max(best, -reply);
+		return !missing && best < 2;
+	});
+	if (missing)
+		return false;
+
+	// a win needs nothing else, and when every move was searched the table
+	// isn't needed. it would be wrong when the only moves are en passant
+	if (best == 2 || (searched && searched == moves))
+	{
+		wdl = best;
+		zeroingBest = true;
+		return true;
+	}
+
+	int value = 0;
+	bool otherSide = false;
+	if (!stored(board, false, 0, value, otherSide))
+		return false;
+
+	wdl = max(best, value);
+	zeroingBest = best > 0 && best >= value;
+	return true;
+}
+
+////////////////////////////////////////
+// plies to zeroing from the side to moves view. dtz tables may only hold
+// the other side to move, then each move is looked up instead
+bool Tablebases::search_dtz(const Board &board, int &plies)
+{
+	int wdl = 0;
+	bool zeroingBest = false;
+	plies = 0;
+	if (!search_wdl(board, true, wdl, zeroingBest))
+		return false;
+	if (wdl == 0)
+		return true;
+
+	// the table holds a value that doesn't matter when a zeroing move is best
+	if (zeroingBest)
+	{
+		plies = zeroing_dtz(wdl);
+		return true;
+	}
+
+	int value = 0;
+	bool otherSide = false;
+	if (!stored(board, true, wdl, value, otherSide))
+		return false;
+	if (!otherSide)
+	{
+		plies = (value + (std::abs(wdl) == 1 ? 100 : 0)) * sign_of(wdl);
+		return true;
+	}
+
+	int best = INT_MAX;
+	bool missing = false;
+	for_each_move(board, [&](const Piece &p, const Position &des, const char &promotion) {
+		bool zeroing = is_capture(board, p, des) || p.get_rep() == PAWN_REP;
+
+		Board update(board);
+		update.make_move(p.get_position(), des, promotion);
+		update.update_move_set();
+
+		// zeroing moves count from the result after them, others from the
+		// plies after them plus their own
+		int after = 0;
+		bool afterZeroing = false;
+		if (zeroing)
+		{
+			missing = !search_wdl(update, false, after, afterZeroing);
+			after = zeroing_dtz(-after);
+		}
+		else
+		{
+			missing = !search_dtz(update, after);
+			after = -after;
+		}
+		if (missing)
+			return false;
+
+		// a mate is always the quickest
+		if (after == 1 && update.end_game(update.to_move()) == 1)
+			best = 1;
+		if (!zeroing)
+			after += sign_of(after);
+
+		// only moves keeping the result count, the least plies for wins and
+		// the most for losses
+		if (after < best && sign_of(after) == sign_of(wdl))
+			best = after;
+		return true;
+	});
+	if (missing)
+		return false;
+
+	// no legal moves is mate
+	plies = best == INT_MAX ? -1 : best;
+	return true;
+}
+
+////////////////////////////////////////
+// value the table stores for the position, a result from -2 to 2, or for
+// dtz tables plies to zeroing where wdl is the positions result. otherSide
+// is set instead when the dtz table only holds the other side to move
+bool Tablebases::stored(const Board &board, const bool &dtz, const int &wdl, int &value, bool &otherSide)
+{
+	value = 0;
+	otherSide = false;
+
+	// kings alone are a draw without a table
+	if (board.piece_count() == 2)
+		return true;
+
+	bool blackStronger = false;
+	SyzygyTable *e = find(board, dtz, blackStronger);
+	std::shared_ptr<const SyzygyMapping> m = e ? open(*e) : nullptr;
+	if (!m)
+		return false;
+
+	int codes[SIZE * SIZE] = {};
+	for (const Piece &p : board.get_pieces())
+		if (p.get_rep() != EMPTY_REP)
+			codes[square_of(p.get_position())] = syzygy_code(p);
+
+	int side = 0, file = 0;
+	uint64_t idx = e->index(*m, codes, board.to_move() == Color::Black, blackStronger, side, file);
+	const SyzygySubTable &d = e->sub(*m, side, file);
+	if (idx >= d.positions_)
+		return false;
+
+	// pawnless tables with the same pieces on both sides hold both sides to
+	// move as one
+	if (dtz && (d.flags_ & StoredSide) != side && !(e->symmetric_ && !e->hasPawns_))
+	{
+		otherSide = true;
+		return true;
+	}
+
+	value = d.value(idx);
+	if (!dtz)
+	{
+		value -= 2;
+		return true;
+	}
+
+	// mapped values are indices into the plies of each result, in the order
+	// win, loss, win the fifty move rule draws and loss it draws
+	const int RESULT_MAP[5] = { 1, 3, 0, 2, 0 }; // by wdl + 2
+	if (d.flags_ & Mapped)
+	{
+		const uint8_t *map = m->dtzMap_ + d.dtzMap_[RESULT_MAP[wdl + 2]];
+		value = d.flags_ & WideMap ? int(read_le(map + 2 * value, 2)) : map[value];
+	}
+
+	// values are moves unless the table says plies, and always moves for
+	// results the fifty move rule draws
+	if ((wdl == 2 && !(d.flags_ & WinPlies)) || (wdl == -2 && !(d.flags_ & LossPlies)) || wdl == 1 || wdl == -1)
+		value *= 2;
+
+	value += 1;
+	return true;
+}
+
+////////////////////////////////////////
+// table with board's material, blackStronger is set when black has the
+// pieces the table names first
+SyzygyTable *Tablebases::find(const Board &board, const bool &dtz, bool &blackStronger)
+{
+	std::map<string, std::unique_ptr<SyzygyTable>> &tables = dtz ? dtz_ : wdl_;
+	string white = syzygy_material(board, Color::White), black = syzygy_material(board, Color::Black);
+
+	blackStronger = false;
+	auto it = tables.find(white + "v" + black);
+	if (it == tables.end())
+	{
+		blackStronger = true;
+		it = tables.find(black + "v" + white);
+	}
+
+	return it == tables.end() ? nullptr : it->second.get();
+}
+
+////////////////////////////////////////
+// mapping of e, opening it when it is closed. once TABLEBASE_OPEN_TABLES are
+// open the least recently probed one is closed, threads still probing it
+// keep its file mapped until they're done
+std::shared_ptr<const SyzygyMapping> Tablebases::open(SyzygyTable &e)
+{
+	e.lastUsed_ = ++probes_;
+	std::shared_ptr<const SyzygyMapping> m = std::atomic_load(&e.mapping_);
+	if (m)
+		return m;
+
+	std::lock_guard<std::mutex> lock(openMutex_);
+	if ((m = std::atomic_load(&e.mapping_)) || e.invalid_)
+		return m;
+
+	if (!(m = e.read()))
+	{
+		e.invalid_ = true;
+		return m;
+	}
+
+	if (open_.size() >= TABLEBASE_OPEN_TABLES)
+	{
+		auto oldest = std::min_element(open_.begin(), open_.end(),
+			[](const SyzygyTable *lhs, const SyzygyTable *rhs) { return lhs->lastUsed_ < rhs->lastUsed_; });
+		std::atomic_store(&(*oldest)->mapping_, std::shared_ptr<const SyzygyMapping>());
+		*oldest = &e;
+	}
+	else
+		open_.push_back(&e);
+
+	std::atomic_store(&e.mapping_, m);
+	return m;
+}
@@ -0,0 +1,191 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        tablebase.h
+// DESCRIPTION: contains syzygy endgame tablebase probing, win draw loss
+//              tables are probed during searches and distance to zero
+//              tables pick the move at the root
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "board.h"
+#include "mapped_file.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const int TABLEBASE_MAX_PIECES = 7; // largest syzygy tables, kings included
+const double TABLEBASE_WIN = 1000.0; // least a board search values a win at, past any favor
+const size_t TABLEBASE_OPEN_TABLES = 32; // files kept mapped at once, the least recently probed is closed first
+
+// first bytes of wdl and dtz files
+const uint8_t SYZYGY_MAGIC[2][4] = { { 0x71, 0xE8, 0x23, 0x5D }, { 0xD7, 0x66, 0x0C, 0xA5 } };
+
+// file header and sub table flags
+enum SyzygyFileFlag { SplitSides = 1, HasPawns = 2 };
+enum SyzygyFlag { StoredSide = 1, Mapped = 2, WinPlies = 4, LossPlies = 8, WideMap = 16, SingleValue = 128 };
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TABLEBASE RESULT
+// note: from the side to moves view, plies_ is the distance to the next
+//       capture or pawn move for wins and losses found by probe_root and 0
+//       otherwise. wins and losses the fifty move rule turns into draws are
+//       draws
+struct TablebaseResult {
+	int wdl_ = 0; // 1 = win, 0 = draw, -1 = loss
+	int plies_ = 0;
+
+	// search value, draw is the value of an even position and wins are worth
+	// between win and twice win more than it for white and less than it for
+	// black, so a win past every other value stays past it. quicker progress
+	// is worth more to the winning side
+	double value(const Color &toMove, const double &draw, const double &win) const {
+		if (wdl_ == 0)
+			return draw;
+
+		double magnitude = win * (2.0 - min(plies_, 1024) / 1024.0);
+		return (wdl_ > 0) == (toMove == Color::White) ? draw + magnitude : draw - magnitude;
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SYZYGY SUB TABLE
+// note: the positions of one side to move, and in pawn tables of one file
+//       of the leading pawn. pieces are numbered in groups of alike pieces,
+//       each groups number multiplied by its factor. values are stored as
+//       huffman coded symbols, a symbol is one value or a pair of symbols,
+//       packed into fixed size blocks. pointers are into the mapped file
+struct SyzygySubTable {
+	// methods
+	int value (const uint64_t &idx) const; // stored value of position idx
+
+	// position numbering
+	int      pieces_[TABLEBASE_MAX_PIECES] = {}; // syzygy piece codes in the order they're numbered
+	int      groups_ = 0;
+	int      groupSize_[TABLEBASE_MAX_PIECES] = {}; // pieces in each group, leading group first
+	uint64_t groupFactor_[TABLEBASE_MAX_PIECES] = {};
+	uint64_t positions_ = 0; // numbers in use
+
+	// value coding
+	int              flags_ = 0; // SyzygyFlag bits
+	int              constant_ = 0; // value of every position with SingleValue
+	int              shortest_ = 0; // bits in the shortest code
+	vector<uint64_t> firstCode_; // lowest code of each length from shortest_ up, left aligned
+	const uint8_t   *firstSymbol_ = nullptr; // symbol with each first code, 16 bits each
+	const uint8_t   *symbols_ = nullptr; // 12 bit left and right half of each, a right half of 0xFFF makes the left a value
+	vector<uint32_t> runs_; // values each symbol stands for
+	uint64_t         span_ = 0; // values between index entries
+	size_t           spans_ = 0;
+	const uint8_t   *spanIndex_ = nullptr; // block and offset of the middle value of each span, 6 bytes each
+	size_t           blockEntries_ = 0; // blockValues_ entries, padding past blocks_ included
+	const uint8_t   *blockValues_ = nullptr; // values in each block less one, 16 bits each
+	uint64_t         blockBytes_ = 0;
+	uint32_t         blocks_ = 0;
+	const uint8_t   *blockData_ = nullptr;
+	size_t           dtzMap_[4] = {}; // where the dtz values of each result start in the map
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SYZYGY MAPPING
+// note: an open table file and its sub tables, which point into the file so
+//       it stays mapped as long as the mapping is held
+struct SyzygyMapping {
+	MappedFile     file_;
+	SyzygySubTable sub_[2][4]; // by side to move and leading pawn file
+	const uint8_t *dtzMap_ = nullptr; // stored dtz values to plies of mapped sub tables
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SYZYGY TABLE
+// note: one .rtbw or .rtbz file, named by its material like KQvKR with the
+//       white pieces of the table first. pawn tables have a sub table for
+//       each file the leading pawn can be on, wdl tables one for each side
+//       to move and dtz tables only hold one side. the file is mapped when
+//       it is probed and closed again when other tables have been probed
+//       more recently
+struct SyzygyTable {
+	SyzygyTable(const string &fileName, const string &material, const bool &dtz);
+
+	// methods
+	std::shared_ptr<const SyzygyMapping> read () const; // maps the file, nullptr if it isn't a valid table
+	const uint8_t *read_layout (const uint8_t *data, const uint8_t *end, SyzygyMapping &m) const; // flags and piece order of each sub table, nullptr if invalid
+	uint64_t index             (const SyzygyMapping &m, const int codes[SIZE * SIZE], const bool &blackToMove,
+								const bool &blackStronger, int &side, int &file) const; // position number of the syzygy piece codes on each square
+	int sides                  () const { return !dtz_ && !symmetric_ ? 2 : 1; }
+	int files                  () const { return hasPawns_ ? 4 : 1; }
+	SyzygySubTable &sub        (SyzygyMapping &m, const int &side, const int &file) const { return m.sub_[dtz_ ? 0 : side][hasPawns_ ? file : 0]; }
+	const SyzygySubTable &sub  (const SyzygyMapping &m, const int &side, const int &file) const { return m.sub_[dtz_ ? 0 : side][hasPawns_ ? file : 0]; }
+
+	string fileName_;
+	bool   dtz_;
+	int    pieceCount_;
+	bool   hasPawns_;
+	bool   uniquePieces_; // some color has exactly one of a piece that isn't a king
+	bool   symmetric_; // both sides have the same pieces
+	bool   bothPawns_; // both sides have pawns
+
+	// open state, mapping_ is swapped atomically so probes keep the mapping
+	// they got while it is closed, the rest is only changed by Tablebases::open
+	std::shared_ptr<const SyzygyMapping> mapping_; // nullptr while closed
+	std::atomic<uint64_t>                lastUsed_; // probe count when last probed
+	bool                                 invalid_; // failed to read, isn't tried again
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TABLEBASES
+// note: syzygy tables found in a directory. positions with castling rights
+//       are never probed, en passant captures are searched before the
+//       tables are looked at. at most TABLEBASE_OPEN_TABLES files are mapped
+//       at once, the least recently probed is closed to open another.
+//       set_directory can't be called while a search probes, probing is
+//       safe to share between threads
+class Tablebases {
+public:
+	// constructor
+	Tablebases(const string &directory = "", const int &pieces = TABLEBASE_MAX_PIECES) :
+		pieces_(pieces), largest_(0), probes_(0) { set_directory(directory); }
+
+	// methods
+	void set_directory  (const string &directory); // finds the tables in directory, empty for none
+	void set_pieces     (const int &pieces) { pieces_ = pieces; } // probe positions with this many pieces or fewer
+	int pieces          () const { return std::min(pieces_, largest_); }
+	size_t tables       () const { return wdl_.size(); } // win draw loss tables found
+	bool probe          (const Board &board, TablebaseResult &result); // returns false if position isn't in a table
+	bool probe_dtz      (const Board &board, int &plies); // plies to zeroing, negative when losing, 0 for draws
+	bool probe_root     (const Board &board, Node &move, TablebaseResult &result); // move making the most progress
+
+private:
+	bool probable        (const Board &board) const;
+	bool search_wdl      (const Board &board, const bool &pawnMoves, int &wdl, bool &zeroingBest); // false if a table is missing
+	bool search_dtz      (const Board &board, int &plies);
+	bool stored          (const Board &board, const bool &dtz, const int &wdl, int &value, bool &otherSide);
+	SyzygyTable *find    (const Board &board, const bool &dtz, bool &blackStronger);
+	std::shared_ptr<const SyzygyMapping> open (SyzygyTable &e); // mapping of e, opened if it is closed
+
+	int pieces_;
+	int largest_; // most pieces in a table found
+	std::map<string, std::unique_ptr<SyzygyTable>> wdl_, dtz_;
+	std::mutex                 openMutex_; // held while opening and closing tables
+	vector<SyzygyTable *>      open_; // tables with a mapping
+	std::atomic<uint64_t>      probes_; // orders probes for closing the least recent
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// material of color as a syzygy name part, KQR for king queen and rook
+string syzygy_material(const Board &board, const Color &color);
+
+#endif // TABLEBASE_H
@@ -0,0 +1,716 @@
+#ifndef TABLEBASE_CHECK_H
+#define TABLEBASE_CHECK_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        tablebase_check.h
+// DESCRIPTION: contains checks of the syzygy reader, endgames of a king and
+//              one piece against a king are solved, then either written as
+//              syzygy tables or read from real ones and probed back through
+//              Tablebases position by position
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "tablebase.h"
+#include <filesystem>
+#include <fstream>
+#include <queue>
+#include <unordered_map>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const int CHECK_POSITIONS = 2 * 64 * 64 * 64; // side to move, white king, black king and piece
+const int CHECK_BLOCK_BITS = 6; // 64 byte blocks
+const int CHECK_SPAN_BITS = 10; // values between sparse index entries
+const uint64_t CHECK_BLOCK_VALUES = 16384; // most values in a block, keeps index offsets in 16 bits
+const uint32_t CHECK_RUN = 4096; // most values one symbol stands for
+const int CHECK_PAIRS = 256; // most pair symbols made for a sub table
+const int CHECK_REPORTED = 10; // wrong positions printed for each table
+const int CHECK_STRIDE = 16; // every position is probed with a stride of 1, which takes minutes
+
+// endgames in the order they're solved, promotions look up earlier ones
+const string CHECK_PIECES = { QUEEN_REP, ROOK_REP, BISHOP_REP, KNIGHT_REP, PAWN_REP };
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SOLVED ENDGAME
+// note: a white king and piece against a black king. dtz_ is plies to the
+//       next capture, pawn move or mate of the winning side from the side to
+//       moves view, negative for losses and 0 for draws. positions are
+//       numbered ((blackToMove * 64 + whiteKing) * 64 + blackKing) * 64 + piece
+struct SolvedEndgame {
+	char         rep_ = EMPTY_REP;
+	vector<bool> legal_;
+	vector<int>  dtz_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CHECK CODING
+// note: one sub tables parts of a written table
+struct CheckCoding {
+	vector<uint8_t> header_; // flags and codes
+	vector<uint8_t> index_; // sparse index entries
+	vector<uint8_t> blockValues_; // values in each block less one
+	vector<uint8_t> data_; // blocks
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER functions
+////////////////////////////////////////
+// position number and its parts
+inline int check_position(const int &blackToMove, const int &whiteKing, const int &blackKing, const int &piece)
+{
+	return ((blackToMove * 64 + whiteKing) * 64 + blackKing) * 64 + piece;
+}
+
+inline void check_squares(const int &position, int &blackToMove, int &whiteKing, int &blackKing, int &piece)
+{
+	blackToMove = position >> 18;
+	whiteKing = position >> 12 & 63;
+	blackKing = position >> 6 & 63;
+	piece = position & 63;
+}
+
+////////////////////////////////////////
+// syzygy code of a white piece
+inline int check_code(const char &rep) { return int(string("PNBRQK").find(rep)) + 1; }
+
+////////////////////////////////////////
+// little endian bytes appended to out
+inline void append_le(vector<uint8_t> &out, const uint64_t &n, const int &bytes)
+{
+	for (int i = 0; i < bytes; ++i)
+		out.push_back(uint8_t(n >> (8 * i)));
+}
+
+////////////////////////////////////////
+// kings apart, nothing sharing a square, pawns off the first and last rows
+// and black not in check with white to move
+bool check_legal(const char &rep, const int &position)
+{
+	int blackToMove, whiteKing, blackKing, piece;
+	check_squares(position, blackToMove, whiteKing, blackKing, piece);
+	if (whiteKing == blackKing || whiteKing == piece || blackKing == piece || (ATTACKS.king_[whiteKing] & square_bit(blackKing)))
+		return false;
+	if (rep == PAWN_REP && (piece < SIZE || piece >= SIZE * (SIZE - 1)))
+		return false;
+
+	Bitboard occupied = square_bit(whiteKing) | square_bit(blackKing) | square_bit(piece);
+	return blackToMove || !(piece_attacks(rep, Color::White, piece, occupied) & square_bit(blackKing));
+}
+
+////////////////////////////////////////
+// calls visit with whether each legal move zeroes and the dtz of the
+// position after it from that side to moves view. promotions look up the
+// other endgames, captures of the piece are draws
+template<typename Visit>
+void for_each_check_move(const std::map<char, SolvedEndgame> &solved, const char &rep, const int &position, Visit visit)
+{
+	int blackToMove, whiteKing, blackKing, piece;
+	check_squares(position, blackToMove, whiteKing, blackKing, piece);
+	const vector<int> &dtz = solved.at(rep).dtz_;
+	Bitboard occupied = square_bit(whiteKing) | square_bit(blackKing) | square_bit(piece);
+
+	if (blackToMove)
+	{
+		// the black king can't stand next to the white one or where the piece
+		// would attack it, taking the piece leaves kings alone
+		Bitboard targets = ATTACKS.king_[blackKing] & ~ATTACKS.king_[whiteKing];
+		for (; targets; targets &= targets - 1)
+		{
+			int s = lsb(targets);
+			if (s == piece)
+				visit(true, 0);
+			else if (!(piece_attacks(rep, Color::White, piece, occupied & ~square_bit(blackKing)) & square_bit(s)))
+				visit(false, dtz[check_position(0, whiteKing, s, piece)]);
+		}
+		return;
+	}
+
+	Bitboard targets = ATTACKS.king_[whiteKing] & ~ATTACKS.king_[blackKing] & ~square_bit(piece);
+	for (; targets; targets &= targets - 1)
+		visit(false, dtz[check_position(1, lsb(targets), blackKing, piece)]);
+
+	if (rep != PAWN_REP)
+	{
+		targets = piece_attacks(rep, Color::White, piece, occupied) & ~occupied;
+		for (; targets; targets &= targets - 1)
+			visit(false, dtz[check_position(1, whiteKing, blackKing, lsb(targets))]);
+		return;
+	}
+
+	int ahead = piece + SIZE;
+	if (occupied & square_bit(ahead))
+		return;
+	if (ahead >= SIZE * (SIZE - 1))
+	{
+		for (char promotion : { QUEEN_REP, ROOK_REP, BISHOP_REP, KNIGHT_REP })
+			visit(true, solved.at(promotion).dtz_[check_position(1, whiteKing, blackKing, ahead)]);
+		return;
+	}
+
+	visit(true, dtz[check_position(1, whiteKing, blackKing, ahead)]);
+	if (piece < 2 * SIZE && !(occupied & square_bit(ahead + SIZE)))
+		visit(true, dtz[check_position(1, whiteKing, blackKing, ahead + SIZE)]);
+}
+
+////////////////////////////////////////
+// dtz of position from the dtz of the positions after each move, counted
+// the way Tablebases counts them: zeroing moves and mates are 1 ply, wins
+// take the fewest plies and losses the most
+int check_dtz(const std::map<char, SolvedEndgame> &solved, const char &rep, const int &position)
+{
+	int win = INT_MAX, loss = 0, moves = 0;
+	bool draw = false;
+	for_each_check_move(solved, rep, position, [&](const bool &zeroing, const int &dtz) {
+		++moves;
+
+		// only mated positions lose in one ply in these endgames
+		int after = zeroing ? (dtz < 0) - (dtz > 0) : dtz == -1 ? 1 : dtz > 0 ? -dtz - 1 : dtz < 0 ? 1 - dtz : 0;
+		if (after > 0)
+			win = min(win, after);
+		else if (after == 0)
+			draw = true;
+		else
+			loss = min(loss, after);
+	});
+
+	if (win != INT_MAX)
+		return win;
+	if (draw || !moves)
+	{
+		// no moves is mate when the black king is attacked
+		int blackToMove, whiteKing, blackKing, piece;
+		check_squares(position, blackToMove, whiteKing, blackKing, piece);
+		Bitboard occupied = square_bit(whiteKing) | square_bit(blackKing) | square_bit(piece);
+		bool check = piece_attacks(rep, Color::White, piece, occupied) & square_bit(blackKing);
+		return !draw && blackToMove && check ? -1 : 0;
+	}
+
+	return loss;
+}
+
+////////////////////////////////////////
+// solves the endgame of rep, the endgames pawns promote to must be solved
+// first. positions are valued again until none change
+void solve_endgame(std::map<char, SolvedEndgame> &solved, const char &rep)
+{
+	SolvedEndgame &endgame = solved[rep];
+	endgame.rep_ = rep;
+	endgame.legal_.assign(CHECK_POSITIONS, false);
+	endgame.dtz_.assign(CHECK_POSITIONS, 0);
+	for (int n = 0; n < CHECK_POSITIONS; ++n)
+		endgame.legal_[n] = check_legal(rep, n);
+
+	for (bool changed = true; changed;)
+	{
+		changed = false;
+		for (int n = 0; n < CHECK_POSITIONS; ++n)
+			if (endgame.legal_[n])
+			{
+				int dtz = check_dtz(solved, rep, n);
+				changed = changed || dtz != endgame.dtz_[n];
+				endgame.dtz_[n] = dtz;
+			}
+	}
+}
+
+////////////////////////////////////////
+// codes values as one sub table. values are replaced by symbols, then the
+// most frequent neighbouring pair of symbols is made a symbol a number of
+// times. symbols are huffman coded, longer codes take lower symbol numbers,
+// and packed into blocks with a sparse index entry for every span of values
+bool code_values(const vector<int> &values, const int &flags, CheckCoding &coding)
+{
+	coding = CheckCoding();
+	if (std::all_of(values.begin(), values.end(), [&values](const int &v) { return v == values[0]; }))
+	{
+		coding.header_ = { uint8_t(flags | SingleValue), uint8_t(values[0]) };
+		return true;
+	}
+
+	// left and right halves, a right half of 0xFFF makes the left a value
+	vector<std::pair<int, int>> symbols;
+	vector<uint32_t> runs;
+	std::map<int, int> valueSymbol;
+	vector<int> sequence;
+	for (const int &v : values)
+	{
+		if (!valueSymbol.count(v))
+		{
+			valueSymbol[v] = int(symbols.size());
+			symbols.push_back({ v, 0xFFF });
+			runs.push_back(1);
+		}
+		sequence.push_back(valueSymbol[v]);
+	}
+
+	for (int pairs = 0; pairs < CHECK_PAIRS; ++pairs)
+	{
+		std::unordered_map<uint64_t, int> counts;
+		for (size_t i = 0; i + 1 < sequence.size(); ++i)
+			if (runs[sequence[i]] + runs[sequence[i + 1]] <= CHECK_RUN)
+				++counts[uint64_t(sequence[i]) << 32 | uint32_t(sequence[i + 1])];
+
+		auto most = std::max_element(counts.begin(), counts.end(),
+			[](const auto &lhs, const auto &rhs) { return lhs.second < rhs.second; });
+		if (most == counts.end() || most->second < 4)
+			break;
+
+		int left = int(most->first >> 32), right = int(most->first & 0xFFFFFFFF), pair = int(symbols.size());
+		symbols.push_back({ left, right });
+		runs.push_back(runs[left] + runs[right]);
+
+		vector<int> shorter;
+		for (size_t i = 0; i < sequence.size(); ++i)
+			if (i + 1 < sequence.size() && sequence[i] == left && sequence[i + 1] == right)
+				shorter.push_back(pair), ++i;
+			else
+				shorter.push_back(sequence[i]);
+		sequence.swap(shorter);
+	}
+
+	// huffman code lengths of the symbols left in the sequence
+	vector<uint64_t> frequency(symbols.size(), 0);
+	for (const int &s : sequence)
+		++frequency[s];
+
+	vector<int> coded, length(symbols.size(), 0);
+	for (int s = 0; s < int(symbols.size()); ++s)
+		if (frequency[s])
+			coded.push_back(s);
+
+	if (coded.size() == 1)
+		length[coded[0]] = 1;
+	else
+	{
+		std::priority_queue<std::pair<uint64_t, int>, vector<std::pair<uint64_t, int>>, std::greater<>> queue;
+		vector<int> parent(2 * coded.size(), -1);
+		for (int i = 0; i < int(coded.size()); ++i)
+			queue.push({ frequency[coded[i]], i });
+
+		for (int next = int(coded.size()); queue.size() > 1; ++next)
+		{
+			auto first = queue.top();
+			queue.pop();
+			auto second = queue.top();
+			queue.pop();
+			parent[first.second] = parent[second.second] = next;
+			queue.push({ first.first + second.first, next });
+		}
+
+		for (int i = 0; i < int(coded.size()); ++i)
+			for (int node = i; parent[node] >= 0; node = parent[node])
+				++length[coded[i]];
+	}
+
+	// coded symbols renumbered longest first, the others after them
+	vector<int> order(coded);
+	std::stable_sort(order.begin(), order.end(), [&length](const int &lhs, const int &rhs) { return length[lhs] > length[rhs]; });
+	for (int s = 0; s < int(symbols.size()); ++s)
+		if (!frequency[s])
+			order.push_back(s);
+
+	vector<int> number(symbols.size());
+	for (int i = 0; i < int(order.size()); ++i)
+		number[order[i]] = i;
+
+	int longest = length[order[0]], shortest = length[coded.size() == 1 ? order[0] : order[coded.size() - 1]];
+	if (longest > 32 || symbols.size() >= 0xFFF)
+		return false;
+
+	// lowest symbol and first code of each length from the shortest
+	vector<uint64_t> lowest(longest + 2, 0), first(longest + 2, 0);
+	for (int l = shortest; l <= longest; ++l)
+		lowest[l] = std::count_if(coded.begin(), coded.end(), [&length, l](const int &s) { return length[s] > l; });
+	for (int l = longest - 1; l >= shortest; --l)
+		first[l] = (first[l + 1] + lowest[l] - lowest[l + 1]) / 2;
+
+	coding.header_ = { uint8_t(flags), uint8_t(CHECK_BLOCK_BITS), uint8_t(CHECK_SPAN_BITS), 0 };
+	size_t blocksAt = coding.header_.size();
+	append_le(coding.header_, 0, 4);
+	coding.header_.push_back(uint8_t(longest));
+	coding.header_.push_back(uint8_t(shortest));
+	for (int l = shortest; l <= longest; ++l)
+		append_le(coding.header_, lowest[l], 2);
+
+	append_le(coding.header_, order.size(), 2);
+	for (const int &s : order)
+	{
+		int left = symbols[s].second == 0xFFF ? symbols[s].first : number[symbols[s].first];
+		int right = symbols[s].second == 0xFFF ? 0xFFF : number[symbols[s].second];
+		coding.header_.push_back(uint8_t(left));
+		coding.header_.push_back(uint8_t(left >> 8 | (right & 0xF) << 4));
+		coding.header_.push_back(uint8_t(right >> 4));
+	}
+	if (order.size() & 1)
+		coding.header_.push_back(0);
+
+	// blocks end before a code that doesn't fit
+	const int blockBits = 8 << CHECK_BLOCK_BITS;
+	vector<uint64_t> starts;
+	uint64_t done = 0, inBlock = 0;
+	int bits = 0;
+	for (const int &s : sequence)
+	{
+		if (inBlock && (bits + length[s] > blockBits || inBlock + runs[s] > CHECK_BLOCK_VALUES))
+		{
+			append_le(coding.blockValues_, inBlock - 1, 2);
+			bits = 0;
+			inBlock = 0;
+		}
+		if (!inBlock)
+		{
+			starts.push_back(done);
+			coding.data_.resize(coding.data_.size() + (size_t(1) << CHECK_BLOCK_BITS), 0);
+		}
+
+		uint8_t *block = &coding.data_[coding.data_.size() - (size_t(1) << CHECK_BLOCK_BITS)];
+		uint64_t code = first[length[s]] + number[s] - lowest[length[s]];
+		for (int b = length[s] - 1; b >= 0; --b, ++bits)
+			if (code >> b & 1)
+				block[bits / 8] |= 0x80 >> (bits % 8);
+
+		inBlock += runs[s];
+		done += runs[s];
+	}
+	append_le(coding.blockValues_, inBlock - 1, 2);
+
+	uint32_t blocks = uint32_t(starts.size());
+	for (int i = 0; i < 4; ++i)
+		coding.header_[blocksAt + i] = uint8_t(blocks >> (8 * i));
+
+	// the block and offset in it of the middle value of each span, spans past
+	// the last value count on from the last block
+	const uint64_t span = uint64_t(1) << CHECK_SPAN_BITS;
+	for (uint64_t k = 0; k * span < values.size(); ++k)
+	{
+		uint64_t middle = k * span + span / 2;
+		size_t block = std::upper_bound(starts.begin(), starts.end(), middle) - starts.begin() - 1;
+		if (middle - starts[block] > UINT16_MAX)
+			return false;
+		append_le(coding.index_, block, 4);
+		append_le(coding.index_, middle - starts[block], 2);
+	}
+
+	return true;
+}
+
+////////////////////////////////////////
+// file flags, then for each leading pawn file where the leading group is
+// multiplied and the pieces of both sides to move. the sides order pieces
+// differently so numbering has to put them in order
+vector<uint8_t> check_layout(const char &rep, const bool &dtz)
+{
+	bool pawns = rep == PAWN_REP;
+	int piece = check_code(rep), white = check_code(KING_REP), black = white + 8;
+	int orders[2][3] = { { white, piece, black }, { black, white, piece } };
+	if (pawns || dtz)
+	{
+		int first[3] = { piece, white, black }, second[3] = { piece, black, white };
+		std::copy(first, first + 3, orders[0]);
+		std::copy(pawns ? second : first, (pawns ? second : first) + 3, orders[1]);
+	}
+
+	vector<uint8_t> layout = { uint8_t((pawns ? HasPawns : 0) | (dtz ? 0 : SplitSides)) };
+	for (int f = 0; f < (pawns ? 4 : 1); ++f)
+	{
+		layout.push_back(0);
+		for (int i = 0; i < 3; ++i)
+			layout.push_back(uint8_t(orders[0][i] | orders[1][i] << 4));
+	}
+
+	return layout;
+}
+
+////////////////////////////////////////
+// writes endgame as a syzygy table in directory. dtz tables map stored
+// values to plies and hold white to move, so only wins are stored, except
+// pawn tables hold black to move and map by words. returns
+// false with why in error if positions the table tells apart share a number
+bool write_check_table(const string &directory, const SolvedEndgame &endgame, const bool &dtz, string &error)
+{
+	string material = string("K") + endgame.rep_ + "vK";
+	string fileName = (std::filesystem::path(directory) / (material + (dtz ? ".rtbz" : ".rtbw"))).string();
+	SyzygyTable table(fileName, material, dtz);
+
+	SyzygyMapping m;
+	vector<uint8_t> layout = check_layout(endgame.rep_, dtz);
+	if (!table.read_layout(layout.data(), layout.data() + layout.size(), m))
+	{
+		error = material + " layout isn't readable";
+		return false;
+	}
+
+	// values by position number, -1 where no position needs one. dtz values
+	// are kept as plies less one, doubled and one more for losses until the
+	// maps are made
+	bool pawns = endgame.rep_ == PAWN_REP;
+	vector<int> values[2][4];
+	for (int f = 0; f < table.files(); ++f)
+		for (int side = 0; side < table.sides(); ++side)
+			values[side][f].assign(table.sub(m, side, f).positions_, -1);
+
+	for (int n = 0; n < CHECK_POSITIONS; ++n)
+	{
+		int blackToMove, whiteKing, blackKing, piece, side, file, dtzValue = endgame.dtz_[n];
+		check_squares(n, blackToMove, whiteKing, blackKing, piece);
+		if (!endgame.legal_[n] || (dtz && (blackToMove != pawns || dtzValue == 0)))
+			continue;
+
+		int codes[SIZE * SIZE] = {};
+		codes[whiteKing] = check_code(KING_REP);
+		codes[blackKing] = check_code(KING_REP) + 8;
+		codes[piece] = check_code(endgame.rep_);
+		uint64_t idx = table.index(m, codes, blackToMove, false, side, file);
+
+		vector<int> &sub = values[dtz ? 0 : side][file];
+		int value = dtz ? (std::abs(dtzValue) - 1) * 2 + (dtzValue < 0) : dtzValue > 0 ? 4 : dtzValue < 0 ? 0 : 2;
+		if (idx >= sub.size() || (sub[idx] >= 0 && sub[idx] != value))
+		{
+			error = material + " numbers position " + std::to_string(n) + (idx >= sub.size() ? " past the end" : " like another");
+			return false;
+		}
+		sub[idx] = value;
+	}
+
+	// dtz maps list the plies of wins and losses, values become places in them
+	vector<uint8_t> maps;
+	int wide = pawns ? 2 : 1;
+	int flags = dtz ? Mapped | WinPlies | LossPlies | (pawns ? WideMap | StoredSide : 0) : 0;
+	for (int f = 0; f < table.files() && dtz; ++f)
+	{
+		vector<int> plies[4];
+		for (const int &v : values[0][f])
+			if (v >= 0 && std::find(plies[v & 1].begin(), plies[v & 1].end(), v >> 1) == plies[v & 1].end())
+				plies[v & 1].push_back(v >> 1);
+
+		for (int &v : values[0][f])
+			if (v >= 0)
+				v = int(std::find(plies[v & 1].begin(), plies[v & 1].end(), v >> 1) - plies[v & 1].begin());
+
+		if (wide == 2 && (maps.size() & 1))
+			maps.push_back(0);
+		for (const vector<int> &result : plies)
+		{
+			append_le(maps, result.size(), wide);
+			for (const int &p : result)
+				append_le(maps, p, wide);
+		}
+	}
+
+	// positions no one probes copy the value before them
+	CheckCoding coding[2][4];
+	for (int f = 0; f < table.files(); ++f)
+		for (int side = 0; side < table.sides(); ++side)
+		{
+			int last = 0;
+			for (int &v : values[side][f])
+				last = v = v >= 0 ? v : last;
+			if (!code_values(values[side][f], flags, coding[side][f]))
+			{
+				error = material + " values can't be coded";
+				return false;
+			}
+		}
+
+	vector<uint8_t> bytes(SYZYGY_MAGIC[dtz], SYZYGY_MAGIC[dtz] + 4);
+	auto align = [&bytes](const size_t &to) { bytes.resize((bytes.size() + to - 1) / to * to, 0); };
+	auto each = [&table, &coding](auto part) {
+		for (int f = 0; f < table.files(); ++f)
+			for (int side = 0; side < table.sides(); ++side)
+				part(coding[side][f]);
+	};
+
+	bytes.insert(bytes.end(), layout.begin(), layout.end());
+	align(2);
+	each([&bytes](const CheckCoding &c) { bytes.insert(bytes.end(), c.header_.begin(), c.header_.end()); });
+
+	// maps are aligned from the start of the file
+	if (dtz)
+	{
+		if (wide == 2)
+			align(2);
+		bytes.insert(bytes.end(), maps.begin(), maps.end());
+		align(2);
+	}
+
+	each([&bytes](const CheckCoding &c) { bytes.insert(bytes.end(), c.index_.begin(), c.index_.end()); });
+	each([&bytes](const CheckCoding &c) { bytes.insert(bytes.end(), c.blockValues_.begin(), c.blockValues_.end()); });
+	each([&bytes, &align](const CheckCoding &c) {
+		align(size_t(1) << CHECK_BLOCK_BITS);
+		bytes.insert(bytes.end(), c.data_.begin(), c.data_.end());
+	});
+
+	// codes are read past the end of the last block
+	bytes.resize(bytes.size() + (size_t(1) << CHECK_BLOCK_BITS), 0);
+
+	std::ofstream out(fileName, std::ios::binary);
+	out.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+	if (!out)
+	{
+		error = "couldn't write " + fileName;
+		return false;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////
+// fen of a position, mirror swaps the colors and turns the board over
+string check_fen(const char &rep, const int &position, const bool &mirror)
+{
+	int blackToMove, whiteKing, blackKing, piece;
+	check_squares(position, blackToMove, whiteKing, blackKing, piece);
+
+	char squares[SIZE * SIZE] = {};
+	int flip = mirror ? 56 : 0;
+	squares[whiteKing ^ flip] = mirror ? char(tolower(KING_REP)) : KING_REP;
+	squares[blackKing ^ flip] = mirror ? KING_REP : char(tolower(KING_REP));
+	squares[piece ^ flip] = mirror ? char(tolower(rep)) : rep;
+
+	string fen;
+	for (int row = SIZE - 1; row >= 0; --row)
+	{
+		int empty = 0;
+		for (int col = 0; col < SIZE; ++col)
+			if (!squares[row * SIZE + col])
+				++empty;
+			else
+			{
+				if (empty)
+					fen += char('0' + empty);
+				fen += squares[row * SIZE + col];
+				empty = 0;
+			}
+
+		if (empty)
+			fen += char('0' + empty);
+		if (row)
+			fen += '/';
+	}
+
+	return fen + (bool(blackToMove) != mirror ? " b - - 0 1" : " w - - 0 1");
+}
+
+////////////////////////////////////////
+// probed plies match the solved dtz. tables that store moves instead of
+// plies give odd dtz one ply further from zero, rounded allows that
+inline bool check_plies(const int &probed, const int &dtz, const bool &rounded)
+{
+	return probed == dtz || (rounded && dtz % 2 && probed == dtz + (dtz > 0) - (dtz < 0));
+}
+
+////////////////////////////////////////
+// probes every stride'th legal position of endgame and its color mirror,
+// results, dtz and the root move's result have to match the solved dtz.
+// returns the number of wrong answers
+int check_endgame(Tablebases &tablebases, const SolvedEndgame &endgame, const int &stride, const bool &rounded = false)
+{
+	int checked = 0, wrong = 0, longest = 0, roundedUp = 0;
+	for (int n = 0; n < CHECK_POSITIONS; n += stride)
+		if (endgame.legal_[n])
+			for (bool mirror : { false, true })
+			{
+				Board board;
+				string fen = check_fen(endgame.rep_, n, mirror);
+				if (!board.load_fen(fen))
+					continue;
+				board.update_move_set();
+
+				int dtz = endgame.dtz_[n], plies = 0, wdl = (dtz > 0) - (dtz < 0);
+				longest = max(longest, dtz);
+				++checked;
+
+				TablebaseResult result, root;
+				Node move;
+				bool right = tablebases.probe(board, result) && result.wdl_ == wdl &&
+					tablebases.probe_dtz(board, plies) && check_plies(plies, dtz, rounded);
+				if (right && board.end_game(board.to_move()) == 0)
+					right = tablebases.probe_root(board, move, root) && root.wdl_ == wdl &&
+						check_plies(root.plies_, std::abs(dtz), rounded);
+				roundedUp += right && plies != dtz;
+
+				if (!right && ++wrong <= CHECK_REPORTED)
+					cout << "  " << fen << " has dtz " << dtz << ", probed wdl " << result.wdl_ << " dtz " << plies
+						 << " root " << root.wdl_ << " " << root.plies_ << endl;
+			}
+
+	cout << "K" << endgame.rep_ << "vK: " << checked << " positions, longest win " << longest
+		 << " plies, " << wrong << " wrong";
+	if (rounded)
+		cout << ", " << roundedUp << " dtz rounded to moves";
+	cout << endl;
+	return wrong;
+}
+
+////////////////////////////////////////
+// solves the endgames, writes their tables to directory and probes them
+// back. returns true if every probed position was right
+bool run_tablebase_check(const string &directory, const int &stride)
+{
+	std::error_code ignored;
+	std::filesystem::create_directories(directory, ignored);
+
+	std::map<char, SolvedEndgame> solved;
+	string error;
+	for (char rep : CHECK_PIECES)
+	{
+		solve_endgame(solved, rep);
+		if (!write_check_table(directory, solved[rep], false, error) || !write_check_table(directory, solved[rep], true, error))
+		{
+			cout << error << endl;
+			return false;
+		}
+	}
+
+	Tablebases tablebases(directory);
+	if (tablebases.tables() != CHECK_PIECES.size())
+	{
+		cout << "Found " << tablebases.tables() << " of " << CHECK_PIECES.size() << " tables in " << directory << endl;
+		return false;
+	}
+
+	int wrong = 0;
+	for (char rep : CHECK_PIECES)
+		wrong += check_endgame(tablebases, solved[rep], max(stride, 1));
+
+	return wrong == 0;
+}
+
+////////////////////////////////////////
+// solves the endgames and probes the real syzygy tables of them found in
+// directory, such as the 3 piece tables from the syzygy download. results
+// and dtz have to match the solved ones up to the rounding of tables that
+// store moves. returns true if tables were found and every probed position
+// was right
+bool run_syzygy_verify(const string &directory, const int &stride)
+{
+	Tablebases tablebases(directory);
+	std::map<char, SolvedEndgame> solved;
+	int found = 0, wrong = 0;
+	for (char rep : CHECK_PIECES)
+	{
+		// pawn endgames need the ones they promote to solved, found or not
+		solve_endgame(solved, rep);
+
+		std::filesystem::path table = std::filesystem::path(directory) / (string("K") + rep + "vK");
+		if (!std::filesystem::exists(table.string() + ".rtbw") || !std::filesystem::exists(table.string() + ".rtbz"))
+		{
+			cout << "K" << rep << "vK: no .rtbw and .rtbz in " << directory << endl;
+			continue;
+		}
+
+		++found;
+		wrong += check_endgame(tablebases, solved[rep], max(stride, 1), true);
+	}
+
+	if (!found)
+		cout << "Found no tables to check in " << directory << endl;
+	return found && wrong == 0;
+}
+
+#endif // TABLEBASE_CHECK_H
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        transposition.cpp
+// DESCRIPTION: contains transposition table implementation
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "transposition.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TABLE ENTRY functions
+////////////////////////////////////////
+// checks if stored value can replace a search of depth with window alpha, beta
+bool TableEntry::usable(const int &depth, const double &alpha, const double &beta) const
+{
+	if (depth_ < depth)
+		return false;
+
+	return bound_ == Bound::Exact ||
+		(bound_ == Bound::Lower && value_ >= beta) ||
+		(bound_ == Bound::Upper && value_ <= alpha);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TRANSPOSITION TABLE functions
+////////////////////////////////////////
+// sets table to the largest power of two entries that fits in megabytes
+void TranspositionTable::resize(const size_t &megabytes)
+{
+	size_t count = 1;
+	while (count * 2 * sizeof(TableEntry) <= max(megabytes, size_t(1)) << 20)
+		count *= 2;
+
+	entries_ = vector<TableEntry>(count);
+	clear();
+}
+
+////////////////////////////////////////
+// removes every entry
+void TranspositionTable::clear()
+{
+	for (TableEntry &entry : entries_)
+		entry = TableEntry{ 0, 0.0, 0, Bound::None, { 0, 0 }, { 0, 0 }, QUEEN_REP };
+}
+
+////////////////////////////////////////
+// finds entry for key
+bool TranspositionTable::probe(const uint64_t &key, TableEntry &entry) const
+{
+	const TableEntry &slot = entries_[key & (entries_.size() - 1)];
+	if (slot.bound_ == Bound::None || slot.key_ != key)
+		return false;
+
+	entry = slot;
+	return true;
+}
+
+////////////////////////////////////////
+// stores a search result, bound is found from the window it was searched with
+void TranspositionTable::store(const uint64_t &key, const int &depth, const double &value,
+							   const double &alpha, const double &beta, const Node &move)
+{
+	TableEntry &slot = entries_[key & (entries_.size() - 1)];
+
+	// keep deeper results for the same position
+	if (slot.bound_ != Bound::None && slot.key_ == key && slot.depth_ > depth)
+		return;
+
+	slot.key_ = key;
+	slot.value_ = value;
+	slot.depth_ = int8_t(depth);
+	slot.bound_ = value <= alpha ? Bound::Upper : value >= beta ? Bound::Lower : Bound::Exact;
+	slot.current_[0] = int8_t(move.current_.first);
+	slot.current_[1] = int8_t(move.current_.second);
+	slot.desired_[0] = int8_t(move.desired_.first);
+	slot.desired_[1] = int8_t(move.desired_.second);
+	slot.promotion_ = move.promotion_;
+}
@@ -0,0 +1,66 @@
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        transposition.h
+// DESCRIPTION: contains transposition table for storing search results by
+//              position hash so they can be reused across searches
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "search.h"
+#include <cstdint>
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const size_t DEFAULT_TABLE_MB = 16;
+
+// bound of a stored value, min max values can fall outside the search window
+enum class Bound : uint8_t { None, Exact, Lower, Upper };
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TABLE ENTRY
+// note: best move is stored in board encoding, special moves have negative rows
+struct TableEntry {
+	uint64_t key_;
+	double   value_;
+	int8_t   depth_;
+	Bound    bound_;
+	int8_t   current_[2];
+	int8_t   desired_[2];
+	char     promotion_;
+
+	// methods
+	bool usable(const int &depth, const double &alpha, const double &beta) const; // value can replace a search of depth
+	Node move() const {
+		return Node(value_, Position(current_[0], current_[1]), Position(desired_[0], desired_[1]), promotion_);
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TRANSPOSITION TABLE
+// note: fixed size, each hash maps to one slot and newer or deeper results
+//       replace what is there. not thread safe, one search uses it at a time
+class TranspositionTable {
+public:
+	// constructor
+	TranspositionTable(const size_t &megabytes = DEFAULT_TABLE_MB) { resize(megabytes); }
+
+	// methods
+	void resize (const size_t &megabytes); // clears table
+	void clear  ();
+	bool probe  (const uint64_t &key, TableEntry &entry) const; // returns false if position isn't stored
+	void store  (const uint64_t &key, const int &depth, const double &value,
+				 const double &alpha, const double &beta, const Node &move); // alpha and beta are the window searched with
+	size_t size () const { return entries_.size(); }
+
+private:
+	vector<TableEntry> entries_;
+};
+
+#endif // TRANSPOSITION_H
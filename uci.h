@@ -0,0 +1,581 @@
+#ifndef UCI_H
+#define UCI_H
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// FILE:        uci.h
+// DESCRIPTION: contains universal chess interface front end, commands are read
+//              on the calling thread while searches run on a background thread
+// AUTHOR:      Dan Fabian
+// DATE:        10/19/2026
+
+#include "agent.h"
+#include "mcts.h"
+#include "book.h"
+#include "san.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <sstream>
+
+using std::mutex;
+using std::unique_lock;
+using std::lock_guard;
+using std::condition_variable;
+using std::ostringstream;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CONSTANTS
+const string ENGINE_NAME = "Chess-Engine";
+const string ENGINE_AUTHOR = "Dan Fabian";
+const int DEFAULT_AGENT_MOVES = 8; // moves the policy net picks at the root
+const int DEFAULT_MOVES_TO_GO = 30; // moves the clock is split over when movestogo isn't given
+const int64_t MOVE_OVERHEAD = 50; // ms kept back from the clock for gui lag
+const int MAX_MCTS_THREADS = 64;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// SEARCH LIMITS
+// note: limits given by a go command, 0 if not given. time_ and inc_ are
+//       indexed by color
+struct SearchLimits {
+	int     depth_ = 0;
+	int64_t movetime_ = 0;
+	int64_t time_[2] = { 0, 0 };
+	int64_t inc_[2] = { 0, 0 };
+	int     movestogo_ = 0;
+	bool    infinite_ = false;
+	bool    ponder_ = false;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// UCI
+// note: searches iteratively deepen on a background thread until a limit is
+//       reached or stop is sent. infinite and ponder searches hold their
+//       bestmove until stop or ponderhit as the protocol requires. a ponder
+//       search becomes a normal timed search on ponderhit, and the table is
+//       kept between searches so a missed ponder still warms it
+class Uci {
+public:
+	// constructor
+	Uci(Agent *agent = nullptr) :
+		agent_(agent), agentLoaded_(false), useAgent_(false), depth_(MAX_PLY),
+		agentMoves_(DEFAULT_AGENT_MOVES), ownBook_(false), searchStats_(false), useMcts_(false),
+		mctsPlayouts_(MCTS_DEFAULT_PLAYOUTS), mctsThreads_(1), generator_(std::random_device()()),
+		info_(&table_), waiting_(false), ponderBudget_(0) {}
+	~Uci() { stop(); }
+
+	// methods
+	void loop(std::istream &in = cin); // reads commands until quit or end of input
+
+private:
+	// commands
+	void uci        ();
+	void set_option (istringstream &args);
+	void position   (istringstream &args);
+	void go         (istringstream &args);
+	void stop       (); // stops search and waits for its bestmove
+	void ponder_hit ();
+
+	// helpers
+	void search          (Board board, SearchLimits limits); // runs on search thread
+	int64_t time_budget  (const SearchLimits &limits, const Color &color) const; // ms to search, 0 if no limit
+	string score_string  (const double &value, const Color &color, const int &pvLength) const;
+	string pv_string     (const Board &board) const;
+	void send            (const string &line); // output is shared with the search thread
+
+	Board  board_;
+	Agent *agent_;
+	bool   agentLoaded_;
+
+	// options
+	bool useAgent_;
+	int  depth_;
+	int  agentMoves_;
+	bool ownBook_;
+	bool searchStats_; // search counts are sent as json once a search ends
+	bool useMcts_; // agent searches with mcts instead of min max
+	int  mctsPlayouts_; // playouts of a search without a time limit
+	int  mctsThreads_;
+
+	// mcts tree is kept between searches of the same game
+	std::unique_ptr<MctsSearch> mcts_;
+
+	// book moves are played without searching
+	OpeningBook  book_;
+	std::mt19937 generator_;
+
+	// search
+	std::thread        searchThread_;
+	TranspositionTable table_;
+	Tablebases         tablebases_;
+	SearchInfo         info_;
+	mutex              mutex_; // guards waiting_ and ponderBudget_
+	condition_variable condition_;
+	bool               waiting_; // bestmove is held until stop or ponderhit
+	int64_t            ponderBudget_; // time to search once a ponder search is hit
+	mutex              outputMutex_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// UCI functions
+////////////////////////////////////////
+// reads commands until quit or end of input
+void Uci::loop(std::istream &in)
+{
+	string line;
+	while (std::getline(in, line))
+	{
+		istringstream args(line);
+		string command;
+		args >> command;
+
+		if (command == "uci")
+			uci();
+		else if (command == "isready")
+			send("readyok");
+		else if (command == "ucinewgame")
+		{
+			stop();
+			board_ = Board();
+			table_.clear();
+			info_.policies_.clear();
+			if (mcts_)
+				mcts_->clear();
+		}
+		else if (command == "setoption")
+			set_option(args);
+		else if (command == "position")
+			position(args);
+		else if (command == "go")
+			go(args);
+		else if (command == "stop")
+			stop();
+		else if (command == "ponderhit")
+			ponder_hit();
+		else if (command == "quit")
+			break;
+		else if (!command.empty())
+			send("info string unknown command " + command);
+	}
+
+	stop();
+}
+
+////////////////////////////////////////
+// identifies engine and lists options
+void Uci::uci()
+{
+	send("id name " + ENGINE_NAME);
+	send("id author " + ENGINE_AUTHOR);
+	send("option name Depth type spin default " + std::to_string(MAX_PLY) + " min 1 max " + std::to_string(MAX_PLY));
+	send("option name Hash type spin default " + std::to_string(DEFAULT_TABLE_MB) + " min 1 max 4096");
+	send("option name Ponder type check default false");
+	send("option name UseAgent type check default false");
+	send("option name AgentMoves type spin default " + std::to_string(DEFAULT_AGENT_MOVES) + " min 1 max 64");
+	send("option name AgentPrecision type combo default double var double var float var bfloat16");
+	send("option name UseMcts type check default false");
+	send("option name MctsPlayouts type spin default " + std::to_string(MCTS_DEFAULT_PLAYOUTS) + " min 1 max 1000000");
+	send("option name MctsThreads type spin default 1 min 1 max " + std::to_string(MAX_MCTS_THREADS));
+	send("option name SearchStats type check default false");
+	send("option name OwnBook type check default false");
+	send("option name BookFile type string default <empty>");
+	send("option name SyzygyPath type string default <empty>");
+	send("option name SyzygyProbeLimit type spin default " + std::to_string(TABLEBASE_MAX_PIECES) +
+		 " min 0 max " + std::to_string(TABLEBASE_MAX_PIECES));
+	send("uciok");
+}
+
+////////////////////////////////////////
+// setoption name <id> [value <x>], names may contain spaces
+void Uci::set_option(istringstream &args)
+{
+	string word, name, value;
+	args >> word; // name
+	while (args >> word && word != "value")
+		name += (name.empty() ? "" : " ") + word;
+	while (args >> word)
+		value += (value.empty() ? "" : " ") + word;
+
+	int number = 0;
+	bool isNumber = bool(istringstream(value) >> number);
+
+	if (name == "Depth" && isNumber)
+		depth_ = max(1, min(number, MAX_PLY));
+	else if (name == "Hash" && isNumber)
+		table_.resize(size_t(max(1, min(number, 4096))));
+	else if (name == "Ponder")
+		; // gui decides when to ponder, bestmove always names the expected reply
+	else if (name == "AgentMoves" && isNumber)
+		agentMoves_ = max(1, min(number, 64));
+	else if (name == "AgentPrecision" && agent_)
+	{
+		// evaluations from other weights can't be reused
+		agent_->set_precision(value == "float" ? Precision::Float :
+							  value == "bfloat16" ? Precision::BFloat16 : Precision::Double);
+		table_.clear();
+		info_.policies_.clear();
+	}
+	else if (name == "UseMcts")
+		useMcts_ = value == "true";
+	else if (name == "MctsPlayouts" && isNumber)
+		mctsPlayouts_ = max(1, min(number, 1000000));
+	else if (name == "MctsThreads" && isNumber)
+		mctsThreads_ = max(1, min(number, MAX_MCTS_THREADS));
+	else if (name == "SearchStats")
+		searchStats_ = value == "true";
+	else if (name == "OwnBook")
+		ownBook_ = value == "true";
+	else if (name == "BookFile")
+	{
+		if (book_.open(value))
+			send("info string book has " + std::to_string(book_.size()) + " moves");
+		else if (!value.empty() && value != "<empty>")
+			send("info string couldn't open book " + value);
+	}
+	else if (name == "SyzygyPath")
+	{
+		bool enabled = !value.empty() && value != "<empty>";
+		tablebases_.set_directory(enabled ? value : "");
+		if (enabled)
+			send("info string found " + std::to_string(tablebases_.tables()) + " tablebases up to " +
+				 std::to_string(tablebases_.pieces()) + " pieces in " + value);
+		info_.tablebases_ = tablebases_.tables() ? &tablebases_ : nullptr;
+		table_.clear();
+	}
+	else if (name == "SyzygyProbeLimit" && isNumber)
+	{
+		tablebases_.set_pieces(max(0, min(number, TABLEBASE_MAX_PIECES)));
+		table_.clear();
+	}
+	else if (name == "UseAgent")
+	{
+		// agent values are favor buckets, table values can't be mixed
+		if (useAgent_ != (value == "true" && agent_))
+			table_.clear();
+
+		useAgent_ = value == "true" && agent_;
+		if (value == "true" && !agent_)
+			send("info string no agent available");
+
+		// networks are loaded the first time they are needed, load messages
+		// are passed on as info strings so they don't break the protocol
+		if (useAgent_ && !agentLoaded_)
+		{
+			ostringstream log;
+			{
+				lock_guard<mutex> lock(outputMutex_);
+				std::streambuf *old = cout.rdbuf(log.rdbuf());
+				agent_->load();
+				cout.rdbuf(old);
+			}
+			agentLoaded_ = true;
+
+			istringstream lines(log.str());
+			string message;
+			while (std::getline(lines, message))
+				send("info string " + message);
+		}
+	}
+	else
+		send("info string unknown option " + name);
+}
+
+////////////////////////////////////////
+// position [startpos | fen <fen>] [moves <lan>...]
+void Uci::position(istringstream &args)
+{
+	string word;
+	args >> word;
+
+	Board board;
+	if (word == "fen")
+	{
+		string fen;
+		while (args >> word && word != "moves")
+			fen += (fen.empty() ? "" : " ") + word;
+
+		if (!board.load_fen(fen))
+		{
+			send("info string invalid fen " + fen);
+			return;
+		}
+	}
+	else if (word == "startpos")
+		args >> word; // moves
+	else
+	{
+		send("info string invalid position");
+		return;
+	}
+
+	// moves are played from the given position
+	while (args >> word)
+	{
+		SanMove move;
+		Position current, desired;
+		char promotion;
+		if (!parse_san(word, move) || !resolve_move(board, board.to_move(), move, current, desired, promotion))
+		{
+			send("info string illegal move " + word);
+			break;
+		}
+
+		board.make_move(current, desired, promotion);
+		board.update_move_set();
+	}
+
+	board_ = board;
+}
+
+////////////////////////////////////////
+// starts a search on the current position
+void Uci::go(istringstream &args)
+{
+	stop();
+
+	SearchLimits limits;
+	string word;
+	int64_t number;
+	while (args >> word)
+	{
+		if (word == "infinite")
+			limits.infinite_ = true;
+		else if (word == "ponder")
+			limits.ponder_ = true;
+		else if (!(args >> number))
+			break;
+		else if (word == "depth")
+			limits.depth_ = int(number);
+		else if (word == "movetime")
+			limits.movetime_ = number;
+		else if (word == "wtime")
+			limits.time_[int(Color::White)] = number;
+		else if (word == "btime")
+			limits.time_[int(Color::Black)] = number;
+		else if (word == "winc")
+			limits.inc_[int(Color::White)] = number;
+		else if (word == "binc")
+			limits.inc_[int(Color::Black)] = number;
+		else if (word == "movestogo")
+			limits.movestogo_ = int(number);
+	}
+
+	// the clock starts once a ponder search is hit
+	int64_t budget = time_budget(limits, board_.to_move());
+	info_.reset();
+	{
+		lock_guard<mutex> lock(mutex_);
+		waiting_ = limits.infinite_ || limits.ponder_;
+		ponderBudget_ = limits.ponder_ ? budget : 0;
+		if (!limits.infinite_ && !limits.ponder_ && budget > 0)
+			info_.deadline_ = now_ms() + budget;
+	}
+
+	searchThread_ = std::thread(&Uci::search, this, board_, limits);
+}
+
+////////////////////////////////////////
+// stops search and waits for its bestmove
+void Uci::stop()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		info_.stop_ = true;
+	}
+	condition_.notify_all();
+
+	if (searchThread_.joinable())
+		searchThread_.join();
+}
+
+////////////////////////////////////////
+// the predicted move was played, ponder search continues on the normal clock
+void Uci::ponder_hit()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		waiting_ = false;
+		if (ponderBudget_ > 0)
+			info_.deadline_ = now_ms() + ponderBudget_;
+	}
+	condition_.notify_all();
+}
+
+////////////////////////////////////////
+// iterative deepening, runs on search thread
+void Uci::search(Board board, SearchLimits limits)
+{
+	Color color = board.to_move();
+	bool agent = useAgent_ && agent_;
+	int maxDepth = limits.depth_ > 0 ? min(limits.depth_, depth_) : depth_;
+	int64_t start = now_ms();
+
+	Node best;
+	string bestMove = "0000", ponderMove;
+
+	// a book move ends the search before it starts, infinite searches are
+	// left to analyze the position
+	Node bookMove;
+	if (ownBook_ && !limits.infinite_ && book_.pick(board, bookMove, generator_))
+	{
+		bestMove = move_to_lan(board, bookMove.current_, bookMove.desired_, bookMove.promotion_);
+		send("info string book move " + bestMove);
+		maxDepth = 0;
+	}
+
+	// mcts runs once until its playouts are done or time runs out, timed and
+	// infinite searches aren't limited by playouts
+	if (maxDepth > 0 && agent && useMcts_)
+	{
+		if (!mcts_)
+			mcts_.reset(new MctsSearch(*agent_, size_t(mctsPlayouts_) * MCTS_NODES_PER_PLAYOUT));
+		bool timed = info_.deadline_ != 0 || limits.infinite_ || limits.ponder_;
+		best = mcts_->search(board, timed ? std::numeric_limits<int>::max() : mctsPlayouts_, mctsThreads_, &info_);
+		if (info_.pvLength_[0] > 0)
+		{
+			bestMove = move_to_lan(board, best.current_, best.desired_, best.promotion_);
+			if (info_.pvLength_[0] > 1)
+			{
+				Board update(board);
+				update.make_move(best.current_, best.desired_, best.promotion_);
+				ponderMove = move_to_lan(update, info_.pv_[0][1].current_, info_.pv_[0][1].desired_, info_.pv_[0][1].promotion_);
+			}
+
+			int64_t elapsed = now_ms() - start;
+			uint64_t nodes = info_.stats_.nodes_; // includes the leaves, no separate qnodes
+			send("info depth " + std::to_string(info_.pvLength_[0]) +
+				 " score " + score_string(best.value_, color, info_.pvLength_[0]) +
+				 " nodes " + std::to_string(nodes) +
+				 " nps " + std::to_string(nodes * 1000 / max<int64_t>(elapsed, 1)) +
+				 " time " + std::to_string(elapsed) +
+				 " pv " + pv_string(board));
+		}
+		maxDepth = 0;
+	}
+
+	for (int depth = 1; depth <= maxDepth; ++depth)
+	{
+		Node node = agent ? agent_->min_max_call(board, color, depth, agentMoves_, &info_)
+						  : board.min_max_call(board, color, depth, &info_);
+		bool stopped = info_.stop_;
+
+		// an unfinished iteration is only used if none have finished
+		if (stopped && bestMove != "0000")
+			break;
+		if (info_.pvLength_[0] == 0) // no legal moves or nothing searched yet
+			break;
+
+		best = node;
+		bestMove = move_to_lan(board, best.current_, best.desired_, best.promotion_);
+		ponderMove.clear();
+		if (stopped)
+			break;
+
+		// reply expected by the finished iteration
+		if (info_.pvLength_[0] > 1)
+		{
+			Board update(board);
+			update.make_move(best.current_, best.desired_, best.promotion_);
+			ponderMove = move_to_lan(update, info_.pv_[0][1].current_, info_.pv_[0][1].desired_, info_.pv_[0][1].promotion_);
+		}
+
+		// report finished iteration
+		int64_t elapsed = now_ms() - start;
+		uint64_t nodes = info_.stats_.nodes_; // includes the leaves, no separate qnodes
+		send("info depth " + std::to_string(depth) +
+			 " score " + score_string(best.value_, color, info_.pvLength_[0]) +
+			 " nodes " + std::to_string(nodes) +
+			 " nps " + std::to_string(nodes * 1000 / max<int64_t>(elapsed, 1)) +
+			 " time " + std::to_string(elapsed) +
+			 " pv " + pv_string(board));
+
+		// forced mate found, deeper searches won't change it
+		if (std::abs(best.value_) == std::numeric_limits<double>::max())
+			break;
+
+		// next iteration takes longer than all before it, don't start one that can't finish
+		int64_t deadline = info_.deadline_;
+		if (deadline != 0 && now_ms() - start > (deadline - start) / 2)
+			break;
+	}
+
+	// stopped before any move was searched, any legal move will do
+	if (bestMove == "0000")
+		for (const Piece &p : board.get_pieces())
+			if (p.get_color() == color && !p.move_list().empty())
+			{
+				bestMove = move_to_lan(board, p.get_position(), p.move_list()[0]);
+				break;
+			}
+
+	if (searchStats_)
+		send("info string stats " + info_.stats_.to_json());
+
+	// infinite and ponder searches report only once told to
+	{
+		unique_lock<mutex> lock(mutex_);
+		condition_.wait(lock, [&]() { return !waiting_ || info_.stop_; });
+	}
+
+	send("bestmove " + bestMove + (ponderMove.empty() ? "" : " ponder " + ponderMove));
+}
+
+////////////////////////////////////////
+// ms to search from go limits, 0 if no limit
+int64_t Uci::time_budget(const SearchLimits &limits, const Color &color) const
+{
+	if (limits.movetime_ > 0)
+		return limits.movetime_;
+
+	int64_t time = limits.time_[int(color)], inc = limits.inc_[int(color)];
+	if (time <= 0)
+		return 0;
+
+	// spread clock over remaining moves, never using more than is left
+	int movesToGo = limits.movestogo_ > 0 ? limits.movestogo_ : DEFAULT_MOVES_TO_GO;
+	int64_t budget = time / movesToGo + inc / 2;
+	return max<int64_t>(1, min(budget, time - MOVE_OVERHEAD));
+}
+
+////////////////////////////////////////
+// score from the side to move's view, centipawns or mate in moves
+string Uci::score_string(const double &value, const Color &color, const int &pvLength) const
+{
+	double sign = color == Color::White ? 1 : -1;
+	if (std::abs(value) == std::numeric_limits<double>::max())
+		return "mate " + std::to_string(int(sign * (value > 0 ? 1 : -1)) * (pvLength + 1) / 2);
+
+	// agent values are favor buckets
+	double favor = useAgent_ && agent_ ? index_to_favor(size_t(max(0.0, min(value, BUCKETS - 1.0)))) : value;
+	return "cp " + std::to_string(int(std::round(sign * favor * 100)));
+}
+
+////////////////////////////////////////
+// principal variation of the last search as lan moves
+string Uci::pv_string(const Board &board) const
+{
+	Board update(board);
+	string pv;
+	for (int i = 0; i < info_.pvLength_[0]; ++i)
+	{
+		const Node &move = info_.pv_[0][i];
+		pv += (i == 0 ? "" : " ") + move_to_lan(update, move.current_, move.desired_, move.promotion_);
+		update.make_move(move.current_, move.desired_, move.promotion_);
+	}
+
+	return pv;
+}
+
+////////////////////////////////////////
+// writes a line to the gui
+void Uci::send(const string &line)
+{
+	lock_guard<mutex> lock(outputMutex_);
+	cout << line << endl;
+}
+
+#endif // UCI_H